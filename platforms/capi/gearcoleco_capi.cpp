@@ -0,0 +1,474 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <string.h>
+#include <new>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "gearcoleco.h"
+#include "gearcoleco_capi.h"
+
+#define GC_CAPI_INPUT_COUNT 20
+#define GC_CAPI_FRAME_BUFFER_SIZE (GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN * 4)
+
+// The host owns stdout, core logging stays quiet
+bool g_mcp_stdio_mode = true;
+
+static const GC_Keys k_input_keys[GC_CAPI_INPUT_COUNT] = {
+    Key_Up, Key_Down, Key_Left, Key_Right, Key_Left_Button, Key_Right_Button,
+    Keypad_0, Keypad_1, Keypad_2, Keypad_3, Keypad_4, Keypad_5, Keypad_6, Keypad_7, Keypad_8, Keypad_9,
+    Keypad_Asterisk, Keypad_Hash, Key_Blue, Key_Purple
+};
+
+struct gc_core
+{
+    GearcolecoCore* core;
+    u8* frame_buffer;
+    s16* audio_buffer;
+    int audio_capacity;
+    int audio_count;
+    int width;
+    int height;
+    u32 input[2];
+};
+
+struct gc_pool
+{
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    u64 generation;
+    int busy;
+    bool quit;
+    gc_core* const* cores;
+    int count;
+    int frames;
+    int flags;
+    std::atomic<int> next;
+    std::atomic<int> failed;
+};
+
+static int step_core(gc_core* core, int frames, int flags)
+{
+    if (!core->core->GetCartridge()->IsReady())
+        return GC_ERROR_NO_ROM;
+
+    bool audio = (flags & GC_STEP_AUDIO) != 0;
+
+    // Buffers only grow when a step asks for more frames than ever before
+    if (audio && (core->audio_capacity < (frames * GC_AUDIO_BUFFER_SIZE)))
+    {
+        SafeDeleteArray(core->audio_buffer);
+        core->audio_capacity = frames * GC_AUDIO_BUFFER_SIZE;
+        core->audio_buffer = new (std::nothrow) s16[core->audio_capacity];
+
+        if (!IsValidPointer(core->audio_buffer))
+        {
+            core->audio_capacity = 0;
+            return GC_ERROR_BUFFER_TOO_SMALL;
+        }
+    }
+
+    Video* video = core->core->GetVideo();
+    core->audio_count = 0;
+
+    for (int i = 0; i < frames; i++)
+    {
+        bool last = (i == (frames - 1));
+        bool render = ((flags & GC_STEP_RENDER) != 0) && last;
+        bool observe = ((flags & GC_STEP_OBSERVE) != 0) && last;
+        video->SetSkipRender(!render && !observe);
+
+        int sample_count = 0;
+        s16* samples = audio ? (core->audio_buffer + core->audio_count) : NULL;
+        core->core->RunToVBlank(core->frame_buffer, samples, audio ? &sample_count : NULL, NULL, render);
+        core->audio_count += sample_count;
+    }
+
+    video->SetSkipRender(false);
+
+    if (flags & GC_STEP_RENDER)
+    {
+        GC_RuntimeInfo runtime;
+        core->core->GetRuntimeInfo(runtime);
+        core->width = runtime.screen_width;
+        core->height = runtime.screen_height;
+    }
+
+    return GC_OK;
+}
+
+static void run_pool_jobs(gc_pool* pool)
+{
+    while (true)
+    {
+        int index = pool->next++;
+        if (index >= pool->count)
+            break;
+
+        gc_core* core = pool->cores[index];
+        if (!IsValidPointer(core) || (step_core(core, pool->frames, pool->flags) != GC_OK))
+            pool->failed++;
+    }
+}
+
+static void pool_thread_func(gc_pool* pool)
+{
+    u64 generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->work_cv.wait(lock, [pool, generation]() { return pool->quit || (pool->generation != generation); });
+
+            if (pool->quit)
+                return;
+
+            generation = pool->generation;
+        }
+
+        run_pool_jobs(pool);
+
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->busy--;
+        if (pool->busy == 0)
+            pool->done_cv.notify_one();
+    }
+}
+
+extern "C" {
+
+const char* gc_version(void)
+{
+    return GEARCOLECO_VERSION;
+}
+
+gc_core* gc_create(void)
+{
+    gc_core* core = new (std::nothrow) gc_core();
+    if (!IsValidPointer(core))
+        return NULL;
+
+    core->core = new (std::nothrow) GearcolecoCore();
+    core->frame_buffer = new (std::nothrow) u8[GC_CAPI_FRAME_BUFFER_SIZE];
+
+    if (!IsValidPointer(core->core) || !IsValidPointer(core->frame_buffer))
+    {
+        gc_destroy(core);
+        return NULL;
+    }
+
+    core->core->Init(GC_PIXEL_RGBA8888);
+    InitPointer(core->audio_buffer);
+    core->audio_capacity = 0;
+    core->audio_count = 0;
+    core->width = GC_RESOLUTION_WIDTH;
+    core->height = GC_RESOLUTION_HEIGHT;
+    core->input[0] = 0;
+    core->input[1] = 0;
+    memset(core->frame_buffer, 0, GC_CAPI_FRAME_BUFFER_SIZE);
+
+    return core;
+}
+
+void gc_destroy(gc_core* core)
+{
+    if (!IsValidPointer(core))
+        return;
+
+    SafeDelete(core->core);
+    SafeDeleteArray(core->frame_buffer);
+    SafeDeleteArray(core->audio_buffer);
+    SafeDelete(core);
+}
+
+int gc_load_bios(gc_core* core, const uint8_t* data, size_t size)
+{
+    if (!IsValidPointer(core) || !IsValidPointer(data))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    return core->core->GetMemory()->LoadBiosFromBuffer(data, (int)size) ? GC_OK : GC_ERROR_LOAD_FAILED;
+}
+
+int gc_load_rom(gc_core* core, const uint8_t* data, size_t size)
+{
+    if (!IsValidPointer(core) || !IsValidPointer(data) || (size == 0) || (size > MAX_ROM_SIZE))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if (!core->core->LoadROMFromBuffer(data, (int)size))
+        return GC_ERROR_LOAD_FAILED;
+
+    core->input[0] = 0;
+    core->input[1] = 0;
+
+    return GC_OK;
+}
+
+int gc_reset(gc_core* core)
+{
+    if (!IsValidPointer(core))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if (!core->core->GetCartridge()->IsReady())
+        return GC_ERROR_NO_ROM;
+
+    core->core->ResetROM();
+    core->input[0] = 0;
+    core->input[1] = 0;
+
+    return GC_OK;
+}
+
+void gc_seed_random(gc_core* core, uint32_t seed)
+{
+    if (IsValidPointer(core))
+        core->core->SeedRandom(seed);
+}
+
+int gc_set_input(gc_core* core, int controller, uint32_t buttons)
+{
+    if (!IsValidPointer(core) || (controller < 0) || (controller > 1))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    // Only the buttons that changed reach the core
+    u32 changed = core->input[controller] ^ buttons;
+    GC_Controllers pad = (GC_Controllers)controller;
+
+    for (int i = 0; (i < GC_CAPI_INPUT_COUNT) && (changed != 0); i++)
+    {
+        u32 bit = 1u << i;
+
+        if (!(changed & bit))
+            continue;
+
+        if (buttons & bit)
+            core->core->KeyPressed(pad, k_input_keys[i]);
+        else
+            core->core->KeyReleased(pad, k_input_keys[i]);
+
+        changed &= ~bit;
+    }
+
+    core->input[controller] = buttons & ((1u << GC_CAPI_INPUT_COUNT) - 1);
+
+    return GC_OK;
+}
+
+int gc_set_spinner(gc_core* core, int controller, int movement)
+{
+    if (!IsValidPointer(core) || (controller < 0) || (controller > 1))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if (controller == 0)
+        core->core->Spinner1(movement);
+    else
+        core->core->Spinner2(movement);
+
+    return GC_OK;
+}
+
+int gc_step(gc_core* core, int frames, int flags)
+{
+    if (!IsValidPointer(core) || (frames <= 0))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    return step_core(core, frames, flags);
+}
+
+const uint8_t* gc_get_frame_buffer(const gc_core* core, int* width, int* height)
+{
+    if (!IsValidPointer(core))
+        return NULL;
+
+    if (IsValidPointer(width))
+        *width = core->width;
+    if (IsValidPointer(height))
+        *height = core->height;
+
+    return core->frame_buffer;
+}
+
+const int16_t* gc_get_audio(const gc_core* core, int* sample_count)
+{
+    if (!IsValidPointer(core))
+        return NULL;
+
+    if (IsValidPointer(sample_count))
+        *sample_count = core->audio_count;
+
+    return core->audio_buffer;
+}
+
+int gc_get_observation(const gc_core* core, uint8_t* buffer, size_t size, int format, int scale)
+{
+    if (!IsValidPointer(core) || !IsValidPointer(buffer) || ((scale != 1) && (scale != 2) && (scale != 4)))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if ((format != GC_OBSERVE_INDEX) && (format != GC_OBSERVE_GREYSCALE))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if (size < (size_t)((GC_RESOLUTION_WIDTH / scale) * (GC_RESOLUTION_HEIGHT / scale)))
+        return GC_ERROR_BUFFER_TOO_SMALL;
+
+    GC_Observation_Format observation = (format == GC_OBSERVE_GREYSCALE) ? GC_OBSERVATION_GREYSCALE : GC_OBSERVATION_INDEX;
+    core->core->RenderObservation(buffer, observation, scale);
+
+    return GC_OK;
+}
+
+uint8_t* gc_get_ram(gc_core* core, size_t* size)
+{
+    if (!IsValidPointer(core))
+        return NULL;
+
+    if (IsValidPointer(size))
+        *size = 0x400;
+
+    return core->core->GetMemory()->GetRam();
+}
+
+uint8_t* gc_get_sgm_ram(gc_core* core, size_t* size)
+{
+    if (!IsValidPointer(core))
+        return NULL;
+
+    if (IsValidPointer(size))
+        *size = 0x8000;
+
+    return core->core->GetMemory()->GetSGMRam();
+}
+
+uint8_t* gc_get_vram(gc_core* core, size_t* size)
+{
+    if (!IsValidPointer(core))
+        return NULL;
+
+    if (IsValidPointer(size))
+        *size = 0x4000;
+
+    return core->core->GetVideo()->GetVRAM();
+}
+
+size_t gc_get_state_size(gc_core* core)
+{
+    return IsValidPointer(core) ? core->core->GetSaveStateSize(false) : 0;
+}
+
+int gc_save_state(gc_core* core, uint8_t* buffer, size_t* size)
+{
+    if (!IsValidPointer(core) || !IsValidPointer(buffer) || !IsValidPointer(size))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if (!core->core->GetCartridge()->IsReady())
+        return GC_ERROR_NO_ROM;
+
+    if (*size < core->core->GetSaveStateSize(false))
+        return GC_ERROR_BUFFER_TOO_SMALL;
+
+    return core->core->SaveState(buffer, *size, false) ? GC_OK : GC_ERROR_STATE_FAILED;
+}
+
+int gc_load_state(gc_core* core, const uint8_t* buffer, size_t size)
+{
+    if (!IsValidPointer(core) || !IsValidPointer(buffer) || (size == 0))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    if (!core->core->GetCartridge()->IsReady())
+        return GC_ERROR_NO_ROM;
+
+    return core->core->LoadState(buffer, size) ? GC_OK : GC_ERROR_STATE_FAILED;
+}
+
+gc_pool* gc_pool_create(int threads)
+{
+    gc_pool* pool = new (std::nothrow) gc_pool();
+    if (!IsValidPointer(pool))
+        return NULL;
+
+    pool->generation = 0;
+    pool->busy = 0;
+    pool->quit = false;
+    pool->cores = NULL;
+    pool->count = 0;
+    pool->frames = 0;
+    pool->flags = 0;
+    pool->next = 0;
+    pool->failed = 0;
+
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+
+    // The calling thread of gc_step_many is one of the workers
+    for (int i = 1; i < threads; i++)
+        pool->threads.push_back(std::thread(pool_thread_func, pool));
+
+    return pool;
+}
+
+void gc_pool_destroy(gc_pool* pool)
+{
+    if (!IsValidPointer(pool))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->quit = true;
+    }
+
+    pool->work_cv.notify_all();
+
+    for (size_t i = 0; i < pool->threads.size(); i++)
+        pool->threads[i].join();
+
+    SafeDelete(pool);
+}
+
+int gc_step_many(gc_pool* pool, gc_core* const* cores, int count, int frames, int flags)
+{
+    if (!IsValidPointer(pool) || !IsValidPointer(cores) || (count < 0) || (frames <= 0))
+        return GC_ERROR_INVALID_ARGUMENT;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->cores = cores;
+        pool->count = count;
+        pool->frames = frames;
+        pool->flags = flags;
+        pool->next = 0;
+        pool->failed = 0;
+        pool->busy = (int)pool->threads.size();
+        pool->generation++;
+    }
+
+    pool->work_cv.notify_all();
+
+    run_pool_jobs(pool);
+
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    pool->done_cv.wait(lock, [pool]() { return pool->busy == 0; });
+
+    return pool->failed;
+}
+
+}
@@ -0,0 +1,137 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef GEARCOLECO_CAPI_H
+#define GEARCOLECO_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #if defined(GC_CAPI_BUILD)
+        #define GC_API __declspec(dllexport)
+    #else
+        #define GC_API
+    #endif
+#else
+    #define GC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GC_CAPI_VERSION 1
+
+typedef struct gc_core gc_core;
+typedef struct gc_pool gc_pool;
+
+typedef enum
+{
+    GC_OK = 0,
+    GC_ERROR_INVALID_ARGUMENT = -1,
+    GC_ERROR_LOAD_FAILED = -2,
+    GC_ERROR_NO_ROM = -3,
+    GC_ERROR_BUFFER_TOO_SMALL = -4,
+    GC_ERROR_STATE_FAILED = -5
+} gc_status;
+
+/* Flags for gc_step and gc_step_many */
+#define GC_STEP_RENDER  0x01 /* Draw the last stepped frame into the frame buffer */
+#define GC_STEP_AUDIO   0x02 /* Mix audio and keep the samples of every stepped frame */
+#define GC_STEP_OBSERVE 0x04 /* Draw the last stepped frame for gc_get_observation only */
+
+/* Formats for gc_get_observation */
+#define GC_OBSERVE_INDEX     0 /* Palette index 0-15 per pixel */
+#define GC_OBSERVE_GREYSCALE 1 /* Luma 0-255 per pixel, box filtered when scaled */
+
+/* Button bits for gc_set_input, one mask per controller */
+#define GC_INPUT_UP              (1u << 0)
+#define GC_INPUT_DOWN            (1u << 1)
+#define GC_INPUT_LEFT            (1u << 2)
+#define GC_INPUT_RIGHT           (1u << 3)
+#define GC_INPUT_LEFT_BUTTON     (1u << 4)
+#define GC_INPUT_RIGHT_BUTTON    (1u << 5)
+#define GC_INPUT_KEYPAD_0        (1u << 6)
+#define GC_INPUT_KEYPAD_1        (1u << 7)
+#define GC_INPUT_KEYPAD_2        (1u << 8)
+#define GC_INPUT_KEYPAD_3        (1u << 9)
+#define GC_INPUT_KEYPAD_4        (1u << 10)
+#define GC_INPUT_KEYPAD_5        (1u << 11)
+#define GC_INPUT_KEYPAD_6        (1u << 12)
+#define GC_INPUT_KEYPAD_7        (1u << 13)
+#define GC_INPUT_KEYPAD_8        (1u << 14)
+#define GC_INPUT_KEYPAD_9        (1u << 15)
+#define GC_INPUT_KEYPAD_ASTERISK (1u << 16)
+#define GC_INPUT_KEYPAD_HASH     (1u << 17)
+#define GC_INPUT_BLUE            (1u << 18)
+#define GC_INPUT_PURPLE          (1u << 19)
+
+GC_API const char* gc_version(void);
+
+/* Cores are independent and may be used from different threads, each one
+   from a single thread at a time. */
+GC_API gc_core* gc_create(void);
+GC_API void gc_destroy(gc_core* core);
+
+GC_API int gc_load_bios(gc_core* core, const uint8_t* data, size_t size);
+GC_API int gc_load_rom(gc_core* core, const uint8_t* data, size_t size);
+GC_API int gc_reset(gc_core* core);
+
+/* Power-on RAM is random, the seed applies from the next load or reset */
+GC_API void gc_seed_random(gc_core* core, uint32_t seed);
+
+GC_API int gc_set_input(gc_core* core, int controller, uint32_t buttons);
+GC_API int gc_set_spinner(gc_core* core, int controller, int movement);
+
+GC_API int gc_step(gc_core* core, int frames, int flags);
+
+/* RGBA8888 image of the last rendered frame, valid until the core is destroyed */
+GC_API const uint8_t* gc_get_frame_buffer(const gc_core* core, int* width, int* height);
+/* Interleaved stereo samples at 44100 Hz from the last step with GC_STEP_AUDIO,
+   sample_count receives the number of int16 values */
+GC_API const int16_t* gc_get_audio(const gc_core* core, int* sample_count);
+
+/* Packed 8-bit image of the last frame drawn with GC_STEP_RENDER or GC_STEP_OBSERVE,
+   256/scale x 192/scale bytes with no stride. Scale is 1, 2 or 4. */
+GC_API int gc_get_observation(const gc_core* core, uint8_t* buffer, size_t size, int format, int scale);
+
+GC_API uint8_t* gc_get_ram(gc_core* core, size_t* size);
+GC_API uint8_t* gc_get_sgm_ram(gc_core* core, size_t* size);
+GC_API uint8_t* gc_get_vram(gc_core* core, size_t* size);
+
+GC_API size_t gc_get_state_size(gc_core* core);
+/* On input *size is the buffer capacity, on success it holds the bytes written */
+GC_API int gc_save_state(gc_core* core, uint8_t* buffer, size_t* size);
+GC_API int gc_load_state(gc_core* core, const uint8_t* buffer, size_t size);
+
+/* A pool of worker threads for gc_step_many, 0 threads means one per CPU */
+GC_API gc_pool* gc_pool_create(int threads);
+GC_API void gc_pool_destroy(gc_pool* pool);
+
+/* Steps every core by the same number of frames. The calling thread works
+   alongside the pool and the call returns once all cores are done. Returns
+   GC_OK or the number of cores that could not be stepped. */
+GC_API int gc_step_many(gc_pool* pool, gc_core* const* cores, int count, int frames, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GEARCOLECO_CAPI_H */
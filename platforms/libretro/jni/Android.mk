@@ -8,7 +8,7 @@ INCLUDES   := -I$(CORE_DIR) -I$(SOURCE_DIR) -I$(DEPS_DIR)/miniz
 
 include $(CORE_DIR)/Makefile.common
 
-COREFLAGS := -DHAVE_STDINT_H -DHAVE_INTTYPES_H -D__LIBRETRO__ -DGEARCOLECO_DISABLE_DISASSEMBLER -DGEARCOLECO_DISABLE_VGMRECORDER $(INCLUDES)
+COREFLAGS := -DHAVE_STDINT_H -DHAVE_INTTYPES_H -D__LIBRETRO__ -DGEARCOLECO_DISABLE_DISASSEMBLER -DGEARCOLECO_DISABLE_VGMRECORDER -DGEARCOLECO_DISABLE_PROFILER $(INCLUDES)
 
 GIT_VERSION ?= " $(shell git -c safe.directory="$(abspath $(ROOT_DIR))" describe --abbrev=7 --dirty --always --tags || echo unknown)"
 ifneq ($(GIT_VERSION)," unknown")
@@ -805,6 +805,11 @@ void retro_run(void)
 
     update_input();
 
+    // Frontend run-ahead runs frames with video disabled
+    int av_enable = 3;
+    bool skip_video = environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable) && !(av_enable & 1);
+    core->GetVideo()->SetSkipRender(skip_video);
+
     core->RunToVBlank(frame_buffer, audio_buf, &audio_sample_count);
 
     GC_RuntimeInfo runtime_info;
@@ -0,0 +1,465 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+// Micro-benchmarks for the core hot paths. Everything runs on synthetic
+// BIOS, ROM and VRAM contents so no media is needed. Results go to stdout
+// as JSON, progress goes to stderr.
+
+#include <stdio.h>
+#include <string.h>
+#include <initializer_list>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "gearcoleco.h"
+
+// Keeps core logging off stdout, which carries the JSON report
+bool g_mcp_stdio_mode = true;
+
+#define BENCH_FRAME_CYCLES (GC_CYCLES_PER_LINE * GC_LINES_PER_FRAME_NTSC)
+#define BENCH_SAMPLES 5
+
+struct BenchResult
+{
+    std::string name;
+    const char* unit;
+    u64 iterations;
+    double median_ns;
+    double min_ns;
+};
+
+static std::vector<BenchResult> bench_results;
+static double bench_min_sample_ms = 50.0;
+static const char* bench_filter = NULL;
+
+static double now_ns(void)
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Grows the iteration count until a sample lasts long enough to be stable,
+// then keeps the median and best of several samples
+template <typename F>
+static void bench(const std::string& name, const char* unit, F func)
+{
+    if (IsValidPointer(bench_filter) && (name.compare(0, strlen(bench_filter), bench_filter) != 0))
+        return;
+
+    fprintf(stderr, "%-32s", name.c_str());
+
+    func();
+
+    u64 iterations = 1;
+    while (true)
+    {
+        double start = now_ns();
+        for (u64 i = 0; i < iterations; i++)
+            func();
+        double elapsed = now_ns() - start;
+
+        if ((elapsed >= bench_min_sample_ms * 1000000.0) || (iterations >= (1ULL << 30)))
+            break;
+
+        iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    for (int s = 0; s < BENCH_SAMPLES; s++)
+    {
+        double start = now_ns();
+        for (u64 i = 0; i < iterations; i++)
+            func();
+        samples.push_back((now_ns() - start) / (double)iterations);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.name = name;
+    result.unit = unit;
+    result.iterations = iterations;
+    result.median_ns = samples[BENCH_SAMPLES / 2];
+    result.min_ns = samples[0];
+    bench_results.push_back(result);
+
+    fprintf(stderr, "%12.1f ns/%s\n", result.median_ns, unit);
+}
+
+static u32 bench_random_state = 0x12345678;
+
+static u8 bench_random(void)
+{
+    bench_random_state = (bench_random_state * 1103515245) + 12345;
+    return (u8)(bench_random_state >> 16);
+}
+
+// Minimal Z80 emitter for the synthetic instruction mixes
+class Code
+{
+public:
+    Code(u16 origin) : m_Origin(origin) { }
+    u16 Here() const { return (u16)(m_Origin + m_Bytes.size()); }
+    void Emit(std::initializer_list<u8> bytes) { m_Bytes.insert(m_Bytes.end(), bytes); }
+    void Emit16(u8 opcode, u16 value) { Emit({ opcode, (u8)(value & 0xFF), (u8)(value >> 8) }); }
+    void Patch16(u16 address, u16 value) { m_Bytes[address - m_Origin] = (u8)(value & 0xFF); m_Bytes[address - m_Origin + 1] = (u8)(value >> 8); }
+    const std::vector<u8>& Bytes() const { return m_Bytes; }
+
+private:
+    u16 m_Origin;
+    std::vector<u8> m_Bytes;
+};
+
+static void emit_pointers(Code& code)
+{
+    code.Emit16(0x21, 0x7000);              // LD HL,7000h
+    code.Emit16(0x11, 0x7100);              // LD DE,7100h
+    code.Emit16(0x01, 0x0010);              // LD BC,0010h
+}
+
+static std::vector<u8> build_mix(int mix)
+{
+    Code code(0x8024);
+
+    code.Emit16(0x31, 0x7400);              // LD SP,7400h
+    code.Emit({ 0xDD, 0x21, 0x00, 0x72 });  // LD IX,7200h
+    code.Emit({ 0xFD, 0x21, 0x00, 0x73 });  // LD IY,7300h
+
+    u16 loop = code.Here();
+
+    switch (mix)
+    {
+        // 8-bit arithmetic and logic
+        case 0:
+            code.Emit({ 0x80, 0x91, 0xA2, 0xB3, 0xAC, 0x2C, 0x3D, 0xB8, 0x07, 0x8F,
+                        0x9A, 0x27, 0x2F, 0x3C, 0x04, 0x0D, 0xC6, 0x12, 0xE6, 0xF0,
+                        0xEE, 0x55, 0x0F, 0x17, 0x1F });
+            break;
+        // Loads, stores and stack traffic
+        case 1:
+            emit_pointers(code);
+            for (int i = 0; i < 8; i++)
+                code.Emit({ 0x7E, 0x12, 0x23, 0x13 });
+            code.Emit({ 0xDD, 0x46, 0x01, 0xDD, 0x77, 0x03, 0xFD, 0x4E, 0x02, 0xFD, 0x71, 0x04 });
+            code.Emit({ 0xC5, 0xC1, 0xF5, 0xF1 });
+            code.Emit16(0x3A, 0x7050);
+            code.Emit16(0x32, 0x7051);
+            code.Emit16(0x2A, 0x7060);
+            code.Emit16(0x22, 0x7062);
+            break;
+        // Jumps, calls and loops
+        case 2:
+        {
+            code.Emit({ 0x06, 0x08, 0x10, 0xFE });  // LD B,8 / DJNZ $
+            u16 call = code.Here();
+            code.Emit16(0xCD, 0x0000);
+            code.Emit({ 0x20, 0x00, 0x28, 0x00, 0x18, 0x00, 0xB7 });
+            code.Emit16(0xC2, (u16)(code.Here() + 3));
+            code.Emit16(0xCA, (u16)(code.Here() + 3));
+            code.Emit16(0xC3, loop);
+            u16 sub = code.Here();
+            code.Emit({ 0xAF, 0xC8, 0xC9 });        // XOR A / RET Z / RET
+            code.Patch16((u16)(call + 1), sub);
+            break;
+        }
+        // CB, ED and indexed prefixes
+        case 3:
+            code.Emit16(0x21, 0x7000);
+            code.Emit({ 0xCB, 0x5F, 0xCB, 0xC8, 0xCB, 0x11, 0xCB, 0x3A, 0xCB, 0x06, 0xCB, 0x7E,
+                        0xED, 0x44, 0xED, 0x4A, 0xED, 0x42, 0xED, 0x5F, 0xED, 0x67,
+                        0xDD, 0x09, 0xDD, 0x23, 0xDD, 0x2B, 0xDD, 0xCB, 0x01, 0x46,
+                        0xFD, 0xCB, 0x02, 0xC6, 0xDD, 0x7E, 0x05, 0xFD, 0x86, 0x06 });
+            break;
+        // Block transfers and searches
+        case 4:
+            emit_pointers(code);
+            code.Emit16(0x01, 0x0040);
+            code.Emit({ 0xED, 0xB0 });              // LDIR
+            code.Emit16(0x21, 0x7000);
+            code.Emit16(0x01, 0x0040);
+            code.Emit({ 0x3E, 0x00, 0xED, 0xB1 });  // LD A,0 / CPIR
+            break;
+    }
+
+    if (mix != 2)
+        code.Emit16(0xC3, loop);
+
+    std::vector<u8> rom(0x8000, 0xFF);
+    rom[0] = 0xAA;
+    rom[1] = 0x55;
+    memcpy(&rom[0x24], code.Bytes().data(), code.Bytes().size());
+    return rom;
+}
+
+static std::vector<u8> build_bios(void)
+{
+    std::vector<u8> bios(0x2000, 0xFF);
+    bios[0x00] = 0xC3;                      // JP 8024h
+    bios[0x01] = 0x24;
+    bios[0x02] = 0x80;
+    bios[0x66] = 0xED;                      // RETN
+    bios[0x67] = 0x45;
+    return bios;
+}
+
+static GearcolecoCore* create_core(const std::vector<u8>& bios, const std::vector<u8>& rom)
+{
+    GearcolecoCore* core = new GearcolecoCore();
+    core->Init(GC_PIXEL_RGBA8888);
+    core->GetMemory()->LoadBiosFromBuffer(bios.data(), (int)bios.size());
+    core->LoadROMFromBuffer(rom.data(), (int)rom.size());
+    return core;
+}
+
+static void bench_cpu(const std::vector<u8>& bios)
+{
+    static const char* const k_mixes[] = { "alu", "memory", "branch", "prefixed", "block" };
+
+    for (int mix = 0; mix < 5; mix++)
+    {
+        GearcolecoCore* core = create_core(bios, build_mix(mix));
+        Processor* processor = core->GetProcessor();
+        processor->EnableBreakpoints(false, false);
+        processor->EnableFastCore(true);
+
+        bench(std::string("cpu_runfor_") + k_mixes[mix], "frame", [processor]() {
+            processor->RunFor(BENCH_FRAME_CYCLES);
+            processor->TakePendingTStates();
+        });
+
+        SafeDelete(core);
+    }
+}
+
+static void write_register(Video* video, u8 reg, u8 value)
+{
+    video->WriteControl(value);
+    video->WriteControl(0x80 | reg);
+}
+
+static void bench_video(const std::vector<u8>& bios, const std::vector<u8>& rom)
+{
+    // Registers 0, 1 and 3 select the mode, the tables sit in the usual places
+    static const struct { const char* name; u8 r0; u8 r1; u8 r3; u8 r4; } k_modes[] = {
+        { "graphics1", 0x00, 0xC0, 0x80, 0x00 },
+        { "graphics2", 0x02, 0xC0, 0xFF, 0x03 },
+        { "multicolor", 0x00, 0xC8, 0x80, 0x00 },
+        { "text", 0x00, 0xD0, 0x80, 0x00 },
+    };
+
+    GearcolecoCore* core = create_core(bios, rom);
+    Video* video = core->GetVideo();
+    u8* vram = video->GetVRAM();
+
+    for (int i = 0; i < 0x4000; i++)
+        vram[i] = bench_random();
+
+    // 32 sprites spread so that several lines hit the four per line limit
+    for (int i = 0; i < 32; i++)
+    {
+        u8* sprite = &vram[0x1B00 + (i * 4)];
+        sprite[0] = (u8)((i * 37) % 180);
+        sprite[1] = (u8)(i * 8);
+        sprite[2] = (u8)i;
+        sprite[3] = (u8)(1 + (i % 15));
+    }
+
+    for (int m = 0; m < 4; m++)
+    {
+        write_register(video, 0, k_modes[m].r0);
+        write_register(video, 1, k_modes[m].r1);
+        write_register(video, 2, 0x06);
+        write_register(video, 3, k_modes[m].r3);
+        write_register(video, 4, k_modes[m].r4);
+        write_register(video, 5, 0x36);
+        write_register(video, 6, 0x07);
+        write_register(video, 7, 0x04);
+
+        // The line cache would skip unchanged lines, every line is rendered here
+        bench(std::string("vdp_scanline_") + k_modes[m].name, "frame", [video]() {
+            video->InvalidateLineCache();
+            while (!video->Tick(GC_CYCLES_PER_LINE)) { }
+        });
+    }
+
+    u16* src = video->GetFrameBuffer();
+    std::vector<u8> dst(GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN * 4);
+    int size = GC_RESOLUTION_WIDTH * GC_RESOLUTION_HEIGHT;
+
+    bench("vdp_render32bit", "frame", [video, src, &dst, size]() {
+        video->Render32bit(src, dst.data(), GC_PIXEL_RGBA8888, size);
+    });
+
+    bench("vdp_render16bit", "frame", [video, src, &dst, size]() {
+        video->Render16bit(src, dst.data(), GC_PIXEL_RGB565, size);
+    });
+
+    bench("vdp_observe_index", "frame", [video, src, &dst]() {
+        video->RenderIndexed(src, dst.data());
+    });
+
+    bench("vdp_observe_greyscale_4x", "frame", [video, src, &dst]() {
+        video->RenderGreyscale(src, dst.data(), 4);
+    });
+
+    SafeDelete(core);
+}
+
+static void bench_audio(void)
+{
+    Stereo_Buffer buffer;
+    buffer.clock_rate(GC_MASTER_CLOCK_NTSC);
+    buffer.set_sample_rate(GC_AUDIO_SAMPLE_RATE);
+
+    std::vector<blip_sample_t> samples(GC_AUDIO_BUFFER_SIZE);
+
+    AY8910 ay;
+    ay.Init(GC_MASTER_CLOCK_NTSC);
+    ay.SetOutput(buffer.center());
+
+    // Three tones, noise on channel C and the envelope on channel B
+    static const u8 k_ay_registers[14] = { 0x1C, 0x01, 0xFD, 0x00, 0x7A, 0x02, 0x0F, 0x18, 0x0F, 0x10, 0x0C, 0x40, 0x00, 0x0E };
+    for (int i = 0; i < 14; i++)
+    {
+        ay.SelectRegister((u8)i);
+        ay.WriteRegister(k_ay_registers[i]);
+    }
+
+    u8 tone = 0;
+    bench("ay8910_sync", "frame", [&ay, &buffer, &samples, &tone]() {
+        ay.Tick(BENCH_FRAME_CYCLES / 2);
+        ay.SelectRegister(0);
+        ay.WriteRegister(tone++);
+        ay.Tick(BENCH_FRAME_CYCLES / 2);
+        ay.EndFrame();
+        buffer.end_frame(BENCH_FRAME_CYCLES);
+        buffer.read_samples(samples.data(), GC_AUDIO_BUFFER_SIZE);
+    });
+
+    Sms_Apu apu;
+    buffer.clear();
+    apu.output(buffer.center(), buffer.left(), buffer.right());
+    apu.volume(0.6);
+
+    // Tone periods and volumes for the three squares plus white noise
+    static const u8 k_psg_writes[] = { 0x8E, 0x0F, 0x90, 0xA5, 0x0A, 0xB2, 0xC1, 0x1C, 0xD4, 0xE4, 0xF3 };
+
+    bench("psg_end_frame", "frame", [&apu, &buffer, &samples]() {
+        for (size_t i = 0; i < sizeof(k_psg_writes); i++)
+            apu.write_data((blip_time_t)(i * (BENCH_FRAME_CYCLES / sizeof(k_psg_writes))), k_psg_writes[i]);
+        apu.end_frame(BENCH_FRAME_CYCLES);
+        buffer.end_frame(BENCH_FRAME_CYCLES);
+        buffer.read_samples(samples.data(), GC_AUDIO_BUFFER_SIZE);
+    });
+}
+
+static void bench_savestate(const std::vector<u8>& bios, const std::vector<u8>& rom)
+{
+    GearcolecoCore* core = create_core(bios, rom);
+    std::vector<u8> frame_buffer(GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN * 4);
+    std::vector<s16> audio(GC_AUDIO_BUFFER_SIZE);
+
+    for (int i = 0; i < 10; i++)
+    {
+        int count = 0;
+        core->RunToVBlank(frame_buffer.data(), audio.data(), &count);
+    }
+
+    std::vector<u8> state(core->GetSaveStateSize(false));
+    size_t size = state.size();
+
+    if ((size == 0) || !core->SaveState(state.data(), size, false) || !core->LoadState(state.data(), size))
+    {
+        fprintf(stderr, "Savestate round trip failed, skipping\n");
+        SafeDelete(core);
+        return;
+    }
+
+    bench("savestate_roundtrip", "op", [core, &state]() {
+        size_t size = state.size();
+        core->SaveState(state.data(), size, false);
+        core->LoadState(state.data(), size);
+    });
+
+    SafeDelete(core);
+}
+
+// A group runs when the filter is a prefix of its name or the other way round
+static bool selected(const char* group)
+{
+    if (!IsValidPointer(bench_filter))
+        return true;
+
+    size_t length = MIN(strlen(bench_filter), strlen(group));
+    return strncmp(bench_filter, group, length) == 0;
+}
+
+static void write_json(FILE* file)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"emulator\": \"%s\",\n", GEARCOLECO_TITLE);
+    fprintf(file, "  \"build\": \"%s\",\n", GEARCOLECO_VERSION);
+    fprintf(file, "  \"samples\": %d,\n", BENCH_SAMPLES);
+    fprintf(file, "  \"results\": [\n");
+
+    for (size_t i = 0; i < bench_results.size(); i++)
+    {
+        const BenchResult& r = bench_results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %llu, \"median_ns\": %.1f, \"min_ns\": %.1f, \"ops_per_second\": %.1f }%s\n",
+                r.name.c_str(), r.unit, (unsigned long long)r.iterations, r.median_ns, r.min_ns,
+                (r.median_ns > 0.0) ? (1000000000.0 / r.median_ns) : 0.0,
+                (i + 1 < bench_results.size()) ? "," : "");
+    }
+
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--filter") == 0) && (i + 1 < argc))
+            bench_filter = argv[++i];
+        else if ((strcmp(argv[i], "--quick") == 0))
+            bench_min_sample_ms = 5.0;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--filter PREFIX] [--quick]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    std::vector<u8> bios = build_bios();
+    std::vector<u8> rom = build_mix(1);
+
+    if (selected("cpu"))
+        bench_cpu(bios);
+    if (selected("vdp"))
+        bench_video(bios, rom);
+    if (selected("ay8910") || selected("psg"))
+        bench_audio();
+    if (selected("savestate"))
+        bench_savestate(bios, rom);
+
+    write_json(stdout);
+
+    return 0;
+}
@@ -35,6 +35,16 @@ struct ApplicationParams
     bool mcp_tcp_port_set = false;
     std::string mcp_http_address = "127.0.0.1";
     bool mcp_http_address_set = false;
+    const char* bios_file = NULL;
+    int benchmark_frames = 0;
+    bool benchmark_no_render = false;
+    bool benchmark_no_audio = false;
+    const char* batch_path = NULL;
+    int batch_frames = 600;
+    int batch_jobs = 0;
+    const char* batch_output = NULL;
+    const char* batch_baseline = NULL;
+    const char* batch_screenshots = NULL;
 };
 
 #ifdef APPLICATION_IMPORT
@@ -141,3 +141,116 @@ void application_headless_mainloop(void)
             SDL_Delay((Uint32)ceilf(target_ms - elapsed_ms));
     }
 }
+
+int application_headless_benchmark(const ApplicationParams& params)
+{
+    const char* bios_file = IsValidPointer(params.bios_file) ? params.bios_file : config_emulator.bios_path.c_str();
+
+    if (!IsValidPointer(params.rom_file) || (strlen(params.rom_file) == 0))
+    {
+        Error("Benchmark mode requires a ROM file");
+        return 1;
+    }
+
+    if (strlen(bios_file) == 0)
+    {
+        Error("Benchmark mode requires a BIOS, set one with --bios");
+        return 1;
+    }
+
+    GearcolecoCore* core = new GearcolecoCore();
+    core->Init(GC_PIXEL_RGBA8888);
+    core->GetMemory()->LoadBios(bios_file);
+
+    if (!core->GetMemory()->IsBiosLoaded())
+    {
+        Error("Benchmark mode could not load the BIOS: %s", bios_file);
+        SafeDelete(core);
+        return 2;
+    }
+
+    if (!core->LoadROM(params.rom_file))
+    {
+        Error("Benchmark mode could not load the ROM: %s", params.rom_file);
+        SafeDelete(core);
+        return 2;
+    }
+
+    bool render = !params.benchmark_no_render;
+    bool audio = !params.benchmark_no_audio;
+    int frames = params.benchmark_frames;
+
+    u8* frame_buffer = new u8[GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN * 4];
+    s16* sample_buffer = new s16[GC_AUDIO_BUFFER_SIZE];
+
+    core->GetVideo()->SetSkipRender(!render);
+
+    // Keep the starting point so the instrumented pass replays the same frames
+    size_t state_size = core->GetSaveStateSize(false);
+    u8* state = new u8[state_size];
+    core->SaveState(state, state_size, false);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int i = 0; i < frames; i++)
+    {
+        int sample_count = 0;
+        core->RunToVBlank(frame_buffer, audio ? sample_buffer : NULL, audio ? &sample_count : NULL, NULL, render);
+    }
+
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    // Timing every subsystem call slows emulation down noticeably, so the
+    // split comes from a second pass and is scaled to the uninstrumented time
+    Profiler* profiler = core->GetProfiler();
+    core->LoadState(state, state_size);
+    profiler->Reset();
+    profiler->Enable(true);
+
+    for (int i = 0; i < frames; i++)
+    {
+        int sample_count = 0;
+        core->RunToVBlank(frame_buffer, audio ? sample_buffer : NULL, audio ? &sample_count : NULL, NULL, render);
+    }
+
+    profiler->Enable(false);
+
+    GC_RuntimeInfo runtime;
+    core->GetRuntimeInfo(runtime);
+    bool pal = (runtime.region == Region_PAL);
+
+    double seconds = (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+    double fps = (seconds > 0.0) ? ((double)frames / seconds) : 0.0;
+    double real_fps = pal ? ((double)GC_MASTER_CLOCK_PAL / (GC_LINES_PER_FRAME_PAL * GC_CYCLES_PER_LINE)) :
+                            ((double)GC_MASTER_CLOCK_NTSC / (GC_LINES_PER_FRAME_NTSC * GC_CYCLES_PER_LINE));
+
+    static const char* const k_sections[PROFILE_SECTION_COUNT] = { "Other", "CPU", "VDP", "PSG", "AY8910", "Pixels" };
+    static const GC_Profile_Section k_order[PROFILE_SECTION_COUNT] = { PROFILE_CPU, PROFILE_VDP, PROFILE_PSG, PROFILE_AY8910, PROFILE_PIXELS, PROFILE_OTHER };
+
+    u64 profiled = 0;
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++)
+        profiled += profiler->GetNanoseconds((GC_Profile_Section)i);
+
+    printf("\nROM:        %s (CRC32 %08X)\n", core->GetCartridge()->GetFileName(), core->GetCartridge()->GetCRC());
+    printf("Region:     %s (%.2f Hz)\n", pal ? "PAL" : "NTSC", real_fps);
+    printf("Rendering:  %s\n", render ? "on" : "off");
+    printf("Audio:      %s\n", audio ? "on" : "off");
+    printf("Frames:     %d\n", frames);
+    printf("Time:       %.3f s\n", seconds);
+    printf("Emulated:   %.1f FPS\n", fps);
+    printf("Speed:      %.2fx real time\n", fps / real_fps);
+    printf("\n%-10s %10s %7s\n", "Subsystem", "Time (ms)", "Share");
+
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++)
+    {
+        double share = (profiled > 0) ? ((double)profiler->GetNanoseconds(k_order[i]) / (double)profiled) : 0.0;
+        printf("%-10s %10.1f %6.1f%%\n", k_sections[k_order[i]], share * seconds * 1000.0, share * 100.0);
+    }
+
+    SafeDeleteArray(state);
+    SafeDeleteArray(frame_buffer);
+    SafeDeleteArray(sample_buffer);
+    SafeDelete(core);
+
+    return 0;
+}
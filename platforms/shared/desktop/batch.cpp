@@ -0,0 +1,547 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+#include "gearcoleco.h"
+#include "config.h"
+#include "utils.h"
+#include "stb_image_write.h"
+
+#define BATCH_IMPORT
+#include "batch.h"
+
+// Power-on RAM is random, every ROM starts from the same contents instead
+#define BATCH_RANDOM_SEED 0x12345678
+#define BATCH_MAX_PATH 4096
+
+extern bool g_mcp_stdio_mode;
+
+enum Batch_Status
+{
+    Batch_Status_Error = 0,
+    Batch_Status_Done,
+    Batch_Status_New,
+    Batch_Status_Pass,
+    Batch_Status_Fail
+};
+
+struct Batch_Frame_Hash
+{
+    u64 video;
+    u64 audio;
+};
+
+struct Batch_Job
+{
+    std::string rom_path;
+    std::string name;
+    Batch_Status status;
+    u32 crc;
+    int compared_frames;
+    int first_video_diff;
+    int first_audio_diff;
+    u64 final_video;
+    u64 final_audio;
+};
+
+struct Batch_Context
+{
+    std::vector<Batch_Job> jobs;
+    std::vector<int> screenshot_frames;
+    std::atomic<int> next_job;
+    std::atomic<int> finished_jobs;
+    std::mutex progress_mutex;
+    u8 bios[0x2000];
+    int frames;
+    const char* output_dir;
+    const char* baseline_dir;
+};
+
+static bool is_rom_file(const char* path);
+static bool collect_roms(const char* path, std::vector<Batch_Job>& jobs);
+static bool parse_screenshot_frames(const char* list, std::vector<int>& frames);
+static bool load_bios(const char* path, u8* bios);
+static void worker_thread_func(Batch_Context* context);
+static void run_job(Batch_Context* context, GearcolecoCore* core, Batch_Job& job, u8* frame_buffer, s16* sample_buffer);
+static void compare_with_baseline(Batch_Context* context, Batch_Job& job, const std::vector<Batch_Frame_Hash>& hashes);
+static bool write_hashes(const char* path, const Batch_Job& job, const std::vector<Batch_Frame_Hash>& hashes);
+static bool read_hashes(const char* path, std::vector<Batch_Frame_Hash>& hashes);
+static u64 hash_buffer(const u8* data, size_t size);
+static const char* status_name(Batch_Status status);
+
+int batch_run(const ApplicationParams& params)
+{
+    const char* bios_file = IsValidPointer(params.bios_file) ? params.bios_file : config_emulator.bios_path.c_str();
+
+    if (strlen(bios_file) == 0)
+    {
+        fprintf(stderr, "Batch mode requires a BIOS, set one with --bios\n");
+        return 1;
+    }
+
+    Batch_Context* context = new Batch_Context();
+    context->frames = params.batch_frames;
+    context->output_dir = params.batch_output;
+    context->baseline_dir = params.batch_baseline;
+    context->next_job = 0;
+    context->finished_jobs = 0;
+
+    if (!load_bios(bios_file, context->bios))
+    {
+        fprintf(stderr, "Batch mode could not load the BIOS: %s\n", bios_file);
+        SafeDelete(context);
+        return 2;
+    }
+
+    if (IsValidPointer(params.batch_screenshots) && !parse_screenshot_frames(params.batch_screenshots, context->screenshot_frames))
+    {
+        fprintf(stderr, "Invalid screenshot frame list: %s\n", params.batch_screenshots);
+        SafeDelete(context);
+        return 1;
+    }
+
+    if (!collect_roms(params.batch_path, context->jobs) || context->jobs.empty())
+    {
+        fprintf(stderr, "No ROMs found in %s\n", params.batch_path);
+        SafeDelete(context);
+        return 2;
+    }
+
+    if (IsValidPointer(context->output_dir) && !SDL_CreateDirectory(context->output_dir))
+    {
+        fprintf(stderr, "Could not create output directory %s: %s\n", context->output_dir, SDL_GetError());
+        SafeDelete(context);
+        return 2;
+    }
+
+    int job_count = (int)context->jobs.size();
+    int threads = (params.batch_jobs > 0) ? params.batch_jobs : SDL_GetNumLogicalCPUCores();
+    threads = CLAMP(threads, 1, job_count);
+
+    // Core logging goes to stdout and would interleave between workers
+    bool log_disabled = g_mcp_stdio_mode;
+    g_mcp_stdio_mode = true;
+
+    fprintf(stderr, "Running %d ROMs for %d frames on %d threads\n", job_count, context->frames, threads);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // Every worker owns a core and pulls the next pending ROM when it is
+    // done, so long and short jobs balance out without a fixed split
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.push_back(std::thread(worker_thread_func, context));
+
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    g_mcp_stdio_mode = log_disabled;
+
+    int counts[Batch_Status_Fail + 1] = { };
+
+    for (int i = 0; i < job_count; i++)
+    {
+        const Batch_Job& job = context->jobs[i];
+        counts[job.status]++;
+
+        printf("%-5s %s", status_name(job.status), job.name.c_str());
+
+        if (job.status == Batch_Status_Fail)
+        {
+            if (job.first_video_diff >= 0)
+                printf(" video differs from frame %d", job.first_video_diff);
+            if (job.first_audio_diff >= 0)
+                printf(" audio differs from frame %d", job.first_audio_diff);
+            printf(" (%d frames compared)", job.compared_frames);
+        }
+        else if (job.status != Batch_Status_Error)
+        {
+            printf(" crc=%08X video=%016llx audio=%016llx", job.crc, (unsigned long long)job.final_video, (unsigned long long)job.final_audio);
+        }
+
+        printf("\n");
+    }
+
+    double seconds = (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+    double total_frames = (double)(job_count - counts[Batch_Status_Error]) * (double)context->frames;
+
+    printf("\n%d ROMs: %d passed, %d failed, %d new, %d done, %d errors\n", job_count,
+           counts[Batch_Status_Pass], counts[Batch_Status_Fail], counts[Batch_Status_New],
+           counts[Batch_Status_Done], counts[Batch_Status_Error]);
+    printf("Time: %.3f s (%.1f FPS aggregate)\n", seconds, (seconds > 0.0) ? (total_frames / seconds) : 0.0);
+
+    int ret = ((counts[Batch_Status_Fail] > 0) || (counts[Batch_Status_Error] > 0)) ? 1 : 0;
+
+    SafeDelete(context);
+
+    return ret;
+}
+
+static bool is_rom_file(const char* path)
+{
+    return ends_with_no_case(path, ".col") || ends_with_no_case(path, ".cv") || ends_with_no_case(path, ".rom") ||
+           ends_with_no_case(path, ".bin") || ends_with_no_case(path, ".zip");
+}
+
+static bool is_job_name_used(const std::string& name, const std::vector<Batch_Job>& jobs)
+{
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (SDL_strcasecmp(jobs[i].name.c_str(), name.c_str()) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// Output files are named after the job, a ROM file name that is already
+// taken gets the job number appended so results never overwrite each other
+static void add_job(const std::string& rom_path, std::vector<Batch_Job>& jobs)
+{
+    char name[BATCH_MAX_PATH];
+    get_filename_without_extension(rom_path.c_str(), name, sizeof(name));
+
+    std::string job_name = name;
+    while (is_job_name_used(job_name, jobs))
+        job_name += "_" + std::to_string(jobs.size() + 1);
+
+    Batch_Job job;
+    job.rom_path = rom_path;
+    job.name = job_name;
+    job.status = Batch_Status_Error;
+    job.crc = 0;
+    job.compared_frames = 0;
+    job.first_video_diff = -1;
+    job.first_audio_diff = -1;
+    job.final_video = 0;
+    job.final_audio = 0;
+    jobs.push_back(job);
+}
+
+// A directory is scanned for ROMs, any other file is read as a list of ROM
+// paths, one per line, relative to the list itself
+static bool collect_roms(const char* path, std::vector<Batch_Job>& jobs)
+{
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(path, &info))
+        return false;
+
+    if (info.type == SDL_PATHTYPE_DIRECTORY)
+    {
+        int count = 0;
+        char** entries = SDL_GlobDirectory(path, NULL, 0, &count);
+        if (!IsValidPointer(entries))
+            return false;
+
+        std::vector<std::string> files;
+        for (int i = 0; i < count; i++)
+        {
+            char rom_path[BATCH_MAX_PATH];
+            if (is_rom_file(entries[i]) && join_path(path, entries[i], rom_path, sizeof(rom_path)))
+                files.push_back(rom_path);
+        }
+
+        SDL_free(entries);
+
+        std::sort(files.begin(), files.end());
+
+        for (size_t i = 0; i < files.size(); i++)
+            add_job(files[i], jobs);
+
+        return true;
+    }
+
+    std::ifstream file;
+    open_ifstream_utf8(file, path);
+
+    if (!file.is_open())
+        return false;
+
+    char directory[BATCH_MAX_PATH];
+    get_directory(path, directory, sizeof(directory));
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        size_t last = line.find_last_not_of(" \t\r");
+
+        if ((first == std::string::npos) || (line[first] == '#'))
+            continue;
+
+        char rom_path[BATCH_MAX_PATH];
+        if (join_path(directory, line.substr(first, last - first + 1).c_str(), rom_path, sizeof(rom_path)))
+            add_job(rom_path, jobs);
+    }
+
+    return true;
+}
+
+static bool parse_screenshot_frames(const char* list, std::vector<int>& frames)
+{
+    const char* cursor = list;
+
+    while (*cursor != '\0')
+    {
+        char* end = NULL;
+        long frame = strtol(cursor, &end, 10);
+
+        if ((end == cursor) || (frame < 0) || ((*end != ',') && (*end != '\0')))
+            return false;
+
+        frames.push_back((int)frame);
+        cursor = (*end == ',') ? end + 1 : end;
+    }
+
+    return !frames.empty();
+}
+
+static bool load_bios(const char* path, u8* bios)
+{
+    std::ifstream file;
+    open_ifstream_utf8(file, path, std::ios::in | std::ios::binary | std::ios::ate);
+
+    if (!file.is_open() || (file.tellg() != 0x2000))
+        return false;
+
+    file.seekg(0, std::ios::beg);
+    return (bool)file.read(reinterpret_cast<char*>(bios), 0x2000);
+}
+
+static void worker_thread_func(Batch_Context* context)
+{
+    GearcolecoCore* core = new GearcolecoCore();
+    core->Init(GC_PIXEL_RGBA8888);
+    core->GetMemory()->LoadBiosFromBuffer(context->bios, 0x2000);
+
+    u8* frame_buffer = new u8[GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN * 4];
+    s16* sample_buffer = new s16[GC_AUDIO_BUFFER_SIZE];
+    int job_count = (int)context->jobs.size();
+
+    while (true)
+    {
+        int index = context->next_job++;
+        if (index >= job_count)
+            break;
+
+        Batch_Job& job = context->jobs[index];
+        run_job(context, core, job, frame_buffer, sample_buffer);
+
+        int finished = ++context->finished_jobs;
+
+        std::lock_guard<std::mutex> lock(context->progress_mutex);
+        fprintf(stderr, "[%d/%d] %s %s\n", finished, job_count, status_name(job.status), job.name.c_str());
+    }
+
+    SafeDeleteArray(frame_buffer);
+    SafeDeleteArray(sample_buffer);
+    SafeDelete(core);
+}
+
+static void run_job(Batch_Context* context, GearcolecoCore* core, Batch_Job& job, u8* frame_buffer, s16* sample_buffer)
+{
+    core->SeedRandom(BATCH_RANDOM_SEED);
+
+    if (!core->LoadROM(job.rom_path.c_str()))
+    {
+        job.status = Batch_Status_Error;
+        return;
+    }
+
+    job.crc = core->GetCartridge()->GetCRC();
+
+    std::vector<Batch_Frame_Hash> hashes;
+    hashes.reserve(context->frames);
+
+    for (int frame = 0; frame < context->frames; frame++)
+    {
+        int sample_count = 0;
+        core->RunToVBlank(frame_buffer, sample_buffer, &sample_count);
+
+        GC_RuntimeInfo runtime;
+        core->GetRuntimeInfo(runtime);
+        int width = runtime.screen_width;
+        int height = runtime.screen_height;
+
+        Batch_Frame_Hash hash;
+        hash.video = hash_buffer(frame_buffer, (size_t)width * height * 4);
+        hash.audio = hash_buffer(reinterpret_cast<u8*>(sample_buffer), (size_t)sample_count * sizeof(s16));
+        hashes.push_back(hash);
+
+        if (IsValidPointer(context->output_dir) &&
+            (std::find(context->screenshot_frames.begin(), context->screenshot_frames.end(), frame) != context->screenshot_frames.end()))
+        {
+            char file_name[BATCH_MAX_PATH];
+            char path[BATCH_MAX_PATH];
+            snprintf(file_name, sizeof(file_name), "%s_%06d.png", job.name.c_str(), frame);
+
+            if (join_path(context->output_dir, file_name, path, sizeof(path)))
+                stbi_write_png(path, width, height, 4, frame_buffer, width * 4);
+        }
+    }
+
+    if (!hashes.empty())
+    {
+        job.final_video = hashes.back().video;
+        job.final_audio = hashes.back().audio;
+    }
+
+    job.status = Batch_Status_Done;
+
+    if (IsValidPointer(context->output_dir))
+    {
+        char file_name[BATCH_MAX_PATH];
+        char path[BATCH_MAX_PATH];
+        snprintf(file_name, sizeof(file_name), "%s.txt", job.name.c_str());
+
+        if (!join_path(context->output_dir, file_name, path, sizeof(path)) || !write_hashes(path, job, hashes))
+        {
+            job.status = Batch_Status_Error;
+            return;
+        }
+    }
+
+    if (IsValidPointer(context->baseline_dir))
+        compare_with_baseline(context, job, hashes);
+}
+
+// Only the frames both runs cover are compared, so a short run can be
+// checked against a longer baseline
+static void compare_with_baseline(Batch_Context* context, Batch_Job& job, const std::vector<Batch_Frame_Hash>& hashes)
+{
+    char file_name[BATCH_MAX_PATH];
+    char path[BATCH_MAX_PATH];
+    snprintf(file_name, sizeof(file_name), "%s.txt", job.name.c_str());
+
+    std::vector<Batch_Frame_Hash> baseline;
+
+    if (!join_path(context->baseline_dir, file_name, path, sizeof(path)) || !read_hashes(path, baseline))
+    {
+        job.status = Batch_Status_New;
+        return;
+    }
+
+    int frames = (int)MIN(baseline.size(), hashes.size());
+
+    for (int i = 0; i < frames; i++)
+    {
+        if ((job.first_video_diff < 0) && (baseline[i].video != hashes[i].video))
+            job.first_video_diff = i;
+        if ((job.first_audio_diff < 0) && (baseline[i].audio != hashes[i].audio))
+            job.first_audio_diff = i;
+    }
+
+    job.compared_frames = frames;
+    job.status = ((job.first_video_diff < 0) && (job.first_audio_diff < 0)) ? Batch_Status_Pass : Batch_Status_Fail;
+}
+
+static bool write_hashes(const char* path, const Batch_Job& job, const std::vector<Batch_Frame_Hash>& hashes)
+{
+    FILE* file = fopen_utf8(path, "w");
+
+    if (!IsValidPointer(file))
+        return false;
+
+    fprintf(file, "# %s batch hashes\n", GEARCOLECO_TITLE);
+    fprintf(file, "# rom: %s crc32: %08X frames: %d\n", job.rom_path.c_str(), job.crc, (int)hashes.size());
+    fprintf(file, "# frame video audio\n");
+
+    for (size_t i = 0; i < hashes.size(); i++)
+        fprintf(file, "%d %016llx %016llx\n", (int)i, (unsigned long long)hashes[i].video, (unsigned long long)hashes[i].audio);
+
+    return fclose(file) == 0;
+}
+
+static bool read_hashes(const char* path, std::vector<Batch_Frame_Hash>& hashes)
+{
+    FILE* file = fopen_utf8(path, "r");
+
+    if (!IsValidPointer(file))
+        return false;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#')
+            continue;
+
+        int frame = 0;
+        unsigned long long video = 0;
+        unsigned long long audio = 0;
+
+        if ((sscanf(line, "%d %llx %llx", &frame, &video, &audio) != 3) || (frame != (int)hashes.size()))
+            break;
+
+        Batch_Frame_Hash hash;
+        hash.video = video;
+        hash.audio = audio;
+        hashes.push_back(hash);
+    }
+
+    fclose(file);
+    return !hashes.empty();
+}
+
+// FNV-1a over 64-bit words, the tail is folded in bytewise
+static u64 hash_buffer(const u8* data, size_t size)
+{
+    const u64 prime = 0x100000001B3ULL;
+    u64 hash = 0xCBF29CE484222325ULL;
+    size_t words = size / 8;
+
+    for (size_t i = 0; i < words; i++)
+    {
+        u64 word;
+        memcpy(&word, data + (i * 8), 8);
+        hash = (hash ^ word) * prime;
+    }
+
+    for (size_t i = words * 8; i < size; i++)
+        hash = (hash ^ data[i]) * prime;
+
+    return hash;
+}
+
+static const char* status_name(Batch_Status status)
+{
+    switch (status)
+    {
+        case Batch_Status_Done:
+            return "DONE";
+        case Batch_Status_New:
+            return "NEW";
+        case Batch_Status_Pass:
+            return "PASS";
+        case Batch_Status_Fail:
+            return "FAIL";
+        default:
+            return "ERROR";
+    }
+}
@@ -63,6 +63,7 @@ struct config_Emulator
     bool ffwd;
     int ffwd_speed;
     int runahead;
+    bool runahead_second_instance;
     int mapper;
     int region;
     bool show_info;
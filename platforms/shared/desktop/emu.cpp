@@ -51,6 +51,8 @@ static double rewind_pop_accumulator = 0.0;
 u16* debug_background_buffer;
 u16* debug_tile_buffer;
 u16* debug_sprite_buffers[GC_MAX_SPRITES];
+static u32 debug_vram_dirty[64];
+static bool debug_tile_color_mode;
 
 enum Loading_State
 {
@@ -74,9 +76,11 @@ static const char* get_configurated_dir(int option, const char* path);
 static void init_debug(void);
 static void destroy_debug(void);
 static void update_debug(void);
-static void update_debug_background_buffer(void);
-static void update_debug_tile_buffer(void);
-static void update_debug_sprite_buffers(void);
+static bool is_debug_vram_dirty(int address);
+static void update_debug_rect(u16* src_buffer, u8* dst_buffer, u32* dirty_rows, int x, int y, int width, int height);
+static void update_debug_background_buffer(bool refresh);
+static void update_debug_tile_buffer(bool refresh);
+static void update_debug_sprite_buffers(bool refresh);
 static void debug_step_instruction(void);
 static void reset_rewind_timing(void);
 static int get_rewind_pop_budget(void);
@@ -110,6 +114,7 @@ bool emu_init(void)
     emu_frame_counter = 0;
     emu_debug_tile_palette = 0;
     emu_debug_tile_color_mode = true;
+    debug_tile_color_mode = true;
 
     for (int i = 0; i < 5; i++)
     {
@@ -213,7 +218,7 @@ void emu_render_current_frame(void)
         return;
 
     int size = gearcoleco->GetMemory()->IsBiosLoaded() ? GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN : GC_RESOLUTION_WIDTH * GC_RESOLUTION_HEIGHT;
-    u16* src_buffer = gearcoleco->GetMemory()->IsBiosLoaded() ? gearcoleco->GetVideo()->GetFrameBuffer() : kNoBiosImage;
+    const u16* src_buffer = gearcoleco->GetMemory()->IsBiosLoaded() ? gearcoleco->GetVideo()->GetFrameBuffer() : kNoBiosImage;
 
     gearcoleco->GetVideo()->Render32bit(src_buffer, emu_frame_buffer, GC_PIXEL_RGBA8888, size, true);
 
@@ -1008,20 +1013,45 @@ static void debug_step_instruction(void)
 
 static void update_debug(void)
 {
-    Video* video = gearcoleco->GetVideo();
+    memset(debug_vram_dirty, 0, sizeof(debug_vram_dirty));
+    bool refresh = gearcoleco->GetVideo()->TakeDebugVRAMChanges(debug_vram_dirty);
 
-    update_debug_background_buffer();
-    update_debug_tile_buffer();
-    update_debug_sprite_buffers();
+    if (debug_tile_color_mode != emu_debug_tile_color_mode)
+    {
+        debug_tile_color_mode = emu_debug_tile_color_mode;
+        refresh = true;
+    }
 
-    video->Render32bit(debug_background_buffer, emu_debug_background_buffer, GC_PIXEL_RGBA8888, 256 * 256);
-    video->Render32bit(debug_tile_buffer, emu_debug_tile_buffer, GC_PIXEL_RGBA8888, 32 * 32 * 64);
+    update_debug_background_buffer(refresh);
+    update_debug_tile_buffer(refresh);
+    update_debug_sprite_buffers(refresh);
+}
 
-    for (int s = 0; s < GC_MAX_SPRITES; s++)
-        video->Render32bit(debug_sprite_buffers[s], emu_debug_sprite_buffers[s], GC_PIXEL_RGBA8888, 16 * 16);
+static bool is_debug_vram_dirty(int address)
+{
+    address &= 0x3FFF;
+    return (debug_vram_dirty[address >> 8] >> ((address >> 3) & 0x1F)) & 1;
+}
+
+// Converts a redecoded rect and flags the 8x8 texture blocks it touches for upload
+static void update_debug_rect(u16* src_buffer, u8* dst_buffer, u32* dirty_rows, int x, int y, int width, int height)
+{
+    Video* video = gearcoleco->GetVideo();
+
+    for (int row = y; row < (y + height); row++)
+    {
+        int offset = (row * 256) + x;
+        video->Render32bit(src_buffer + offset, dst_buffer + (offset * 4), GC_PIXEL_RGBA8888, width);
+    }
+
+    for (int block_y = (y >> 3); block_y <= ((y + height - 1) >> 3); block_y++)
+    {
+        for (int block_x = (x >> 3); block_x <= ((x + width - 1) >> 3); block_x++)
+            dirty_rows[block_y] |= 1u << block_x;
+    }
 }
 
-static void update_debug_background_buffer(void)
+static void update_debug_background_buffer(bool refresh)
 {
     Video* video = gearcoleco->GetVideo();
     u8* vram = video->GetVRAM();
@@ -1045,29 +1075,34 @@ static void update_debug_background_buffer(void)
             int bg_color = backdrop_color;
             fg_color = (fg_color > 0) ? fg_color : backdrop_color;
 
-            for (int line = 0; line < 192; line++)
+            for (int tile_y = 0; tile_y < 24; tile_y++)
             {
-                int line_offset = line * GC_RESOLUTION_WIDTH;
-                int tile_y = line >> 3;
-                int tile_y_offset = line & 7;
-
                 for (int tile_x = 0; tile_x < 40; tile_x++)
                 {
                     int tile_number = (tile_y * 40) + tile_x;
                     int name_tile_addr = name_table_addr + tile_number;
                     int name_tile = vram[name_tile_addr & 0x3FFF];
-                    u8 pattern_line = vram[(pattern_table_addr + (name_tile << 3) + tile_y_offset) & 0x3FFF];
+                    int pattern_addr = pattern_table_addr + (name_tile << 3);
 
-                    int screen_offset = line_offset + (tile_x * 6);
+                    if (!refresh && !is_debug_vram_dirty(name_tile_addr) && !is_debug_vram_dirty(pattern_addr))
+                        continue;
 
-                    for (int tile_pixel = 0; tile_pixel < 6; tile_pixel++)
+                    for (int tile_y_offset = 0; tile_y_offset < 8; tile_y_offset++)
                     {
-                        int pixel = screen_offset + tile_pixel;
-                        if (pixel < 256 * 256)
-                            debug_background_buffer[pixel] = IsSetBit(pattern_line, 7 - tile_pixel) ? fg_color : bg_color;
+                        u8 pattern_line = vram[(pattern_addr + tile_y_offset) & 0x3FFF];
+                        int screen_offset = (((tile_y << 3) + tile_y_offset) * GC_RESOLUTION_WIDTH) + (tile_x * 6);
+
+                        for (int tile_pixel = 0; tile_pixel < 6; tile_pixel++)
+                            debug_background_buffer[screen_offset + tile_pixel] = IsSetBit(pattern_line, 7 - tile_pixel) ? fg_color : bg_color;
                     }
+
+                    if (!refresh)
+                        update_debug_rect(debug_background_buffer, emu_debug_background_buffer, emu_debug_background_dirty, tile_x * 6, tile_y << 3, 6, 8);
                 }
             }
+
+            if (refresh)
+                update_debug_rect(debug_background_buffer, emu_debug_background_buffer, emu_debug_background_dirty, 0, 0, 256, 256);
             return;
         }
         case 2:
@@ -1083,11 +1118,8 @@ static void update_debug_background_buffer(void)
         }
     }
 
-    for (int line = 0; line < 192; line++)
+    for (int tile_y = 0; tile_y < 24; tile_y++)
     {
-        int line_offset = line * GC_RESOLUTION_WIDTH;
-        int tile_y = line >> 3;
-        int tile_y_offset = line & 7;
         region = (tile_y & 0x18) << 5;
 
         for (int tile_x = 0; tile_x < 32; tile_x++)
@@ -1095,67 +1127,75 @@ static void update_debug_background_buffer(void)
             int tile_number = (tile_y << 5) + tile_x;
             int name_tile_addr = name_table_addr + tile_number;
             int name_tile = vram[name_tile_addr & 0x3FFF];
-            u8 pattern_line = 0;
-            u8 color_line = 0;
+            int pattern_addr = pattern_table_addr + (name_tile << 3);
+            int color_addr = color_table_addr + (name_tile >> 3);
 
-            if (mode == 4)
+            if (mode == 2)
             {
-                int offset_color = pattern_table_addr + (name_tile << 3) + ((tile_y & 0x03) << 1) + (line & 0x04 ? 1 : 0);
-                color_line = vram[offset_color & 0x3FFF];
+                name_tile += region;
+                pattern_addr = pattern_table_addr + ((name_tile & region_mask) << 3);
+                color_addr = color_table_addr + ((name_tile & color_mask) << 3);
+            }
 
-                int left_color = color_line >> 4;
-                int right_color = color_line & 0x0F;
-                left_color = (left_color > 0) ? left_color : backdrop_color;
-                right_color = (right_color > 0) ? right_color : backdrop_color;
+            if (!refresh && !is_debug_vram_dirty(name_tile_addr) && !is_debug_vram_dirty(pattern_addr) && !is_debug_vram_dirty(color_addr))
+                continue;
 
-                int screen_offset = line_offset + (tile_x << 3);
+            for (int tile_y_offset = 0; tile_y_offset < 8; tile_y_offset++)
+            {
+                int line = (tile_y << 3) + tile_y_offset;
+                int screen_offset = (line * GC_RESOLUTION_WIDTH) + (tile_x << 3);
+                u8 pattern_line = 0;
+                u8 color_line = 0;
 
-                for (int tile_pixel = 0; tile_pixel < 4; tile_pixel++)
+                if (mode == 4)
                 {
-                    int pixel = screen_offset + tile_pixel;
-                    if (pixel < 256 * 256)
-                        debug_background_buffer[pixel] = left_color;
-                }
+                    int offset_color = pattern_addr + ((tile_y & 0x03) << 1) + (line & 0x04 ? 1 : 0);
+                    color_line = vram[offset_color & 0x3FFF];
 
-                for (int tile_pixel = 4; tile_pixel < 8; tile_pixel++)
-                {
-                    int pixel = screen_offset + tile_pixel;
-                    if (pixel < 256 * 256)
-                        debug_background_buffer[pixel] = right_color;
-                }
+                    int left_color = color_line >> 4;
+                    int right_color = color_line & 0x0F;
+                    left_color = (left_color > 0) ? left_color : backdrop_color;
+                    right_color = (right_color > 0) ? right_color : backdrop_color;
 
-                continue;
-            }
-            else if (mode == 0)
-            {
-                pattern_line = vram[(pattern_table_addr + (name_tile << 3) + tile_y_offset) & 0x3FFF];
-                color_line = vram[(color_table_addr + (name_tile >> 3)) & 0x3FFF];
-            }
-            else if (mode == 2)
-            {
-                name_tile += region;
-                pattern_line = vram[(pattern_table_addr + ((name_tile & region_mask) << 3) + tile_y_offset) & 0x3FFF];
-                color_line = vram[(color_table_addr + ((name_tile & color_mask) << 3) + tile_y_offset) & 0x3FFF];
-            }
+                    for (int tile_pixel = 0; tile_pixel < 4; tile_pixel++)
+                        debug_background_buffer[screen_offset + tile_pixel] = left_color;
 
-            int fg_color = color_line >> 4;
-            int bg_color = color_line & 0x0F;
-            fg_color = (fg_color > 0) ? fg_color : backdrop_color;
-            bg_color = (bg_color > 0) ? bg_color : backdrop_color;
+                    for (int tile_pixel = 4; tile_pixel < 8; tile_pixel++)
+                        debug_background_buffer[screen_offset + tile_pixel] = right_color;
 
-            int screen_offset = line_offset + (tile_x << 3);
+                    continue;
+                }
+                else if (mode == 0)
+                {
+                    pattern_line = vram[(pattern_addr + tile_y_offset) & 0x3FFF];
+                    color_line = vram[color_addr & 0x3FFF];
+                }
+                else if (mode == 2)
+                {
+                    pattern_line = vram[(pattern_addr + tile_y_offset) & 0x3FFF];
+                    color_line = vram[(color_addr + tile_y_offset) & 0x3FFF];
+                }
 
-            for (int tile_pixel = 0; tile_pixel < 8; tile_pixel++)
-            {
-                int pixel = screen_offset + tile_pixel;
-                if (pixel < 256 * 256)
-                    debug_background_buffer[pixel] = IsSetBit(pattern_line, 7 - tile_pixel) ? fg_color : bg_color;
+                int fg_color = color_line >> 4;
+                int bg_color = color_line & 0x0F;
+                fg_color = (fg_color > 0) ? fg_color : backdrop_color;
+                bg_color = (bg_color > 0) ? bg_color : backdrop_color;
+
+                for (int tile_pixel = 0; tile_pixel < 8; tile_pixel++)
+                    debug_background_buffer[screen_offset + tile_pixel] = IsSetBit(pattern_line, 7 - tile_pixel) ? fg_color : bg_color;
             }
+
+            if (!refresh)
+                update_debug_rect(debug_background_buffer, emu_debug_background_buffer, emu_debug_background_dirty, tile_x << 3, tile_y << 3, 8, 8);
         }
     }
+
+    // A refresh also converts the area outside the active cells
+    if (refresh)
+        update_debug_rect(debug_background_buffer, emu_debug_background_buffer, emu_debug_background_dirty, 0, 0, 256, 256);
 }
 
-static void update_debug_tile_buffer(void)
+static void update_debug_tile_buffer(bool refresh)
 {
     Video* video = gearcoleco->GetVideo();
     u8* vram = video->GetVRAM();
@@ -1163,13 +1203,12 @@ static void update_debug_tile_buffer(void)
     int mode = video->GetMode();
 
     int pattern_table_addr = (regs[4] & ((mode == 2) ? 0x04 : 0x07)) << 11;
+    int color_table_addr = regs[3] << 6;
+    int backdrop_color = regs[7] & 0x0F;
+    backdrop_color = (backdrop_color > 0) ? backdrop_color : 1;
 
     if (emu_debug_tile_color_mode)
     {
-        int color_table_addr = regs[3] << 6;
-        int backdrop_color = regs[7] & 0x0F;
-        backdrop_color = (backdrop_color > 0) ? backdrop_color : 1;
-
         if (mode == 2)
         {
             pattern_table_addr &= 0x2000;
@@ -1179,20 +1218,38 @@ static void update_debug_tile_buffer(void)
         {
             pattern_table_addr &= 0x2000;
         }
+    }
+
+    for (int tile_number = 0; tile_number < (32 * 32); tile_number++)
+    {
+        int tile_x = tile_number & 0x1F;
+        int tile_y = tile_number >> 5;
+        bool dirty = refresh || is_debug_vram_dirty(pattern_table_addr + (tile_number << 3));
+
+        if (emu_debug_tile_color_mode && (mode == 0))
+            dirty = dirty || is_debug_vram_dirty(color_table_addr + (tile_number >> 3));
+        else if (emu_debug_tile_color_mode && (mode == 2))
+            dirty = dirty || is_debug_vram_dirty(color_table_addr + (tile_number << 3));
+
+        if (!dirty)
+            continue;
 
-        for (int y = 0; y < 256; y++)
+        for (int offset_y = 0; offset_y < 8; offset_y++)
         {
-            int width_y = (y * 256);
-            int tile_y = y / 8;
-            int offset_y = y & 0x7;
+            int tile_data_addr = (pattern_table_addr + (tile_number * 8) + offset_y) & 0x3FFF;
+            int width_y = (((tile_y << 3) + offset_y) * 256) + (tile_x << 3);
 
-            for (int x = 0; x < 256; x++)
+            for (int x = 0; x < 8; x++)
             {
-                int tile_x = x / 8;
-                int offset_x = 7 - (x & 0x7);
+                int offset_x = 7 - x;
                 int pixel = width_y + x;
 
-                int tile_number = (tile_y * 32) + tile_x;
+                if (!emu_debug_tile_color_mode)
+                {
+                    debug_tile_buffer[pixel] = IsSetBit(vram[tile_data_addr], offset_x) ? 15 : 0;
+                    continue;
+                }
+
                 u8 pattern_line = 0;
                 u8 color_line = 0;
                 int fg_color = 15;
@@ -1203,8 +1260,6 @@ static void update_debug_tile_buffer(void)
                     fg_color = (regs[7] >> 4) & 0x0F;
                     bg_color = backdrop_color;
                     fg_color = (fg_color > 0) ? fg_color : backdrop_color;
-
-                    int tile_data_addr = (pattern_table_addr + (tile_number * 8) + offset_y) & 0x3FFF;
                     pattern_line = vram[tile_data_addr];
                 }
                 else if (mode == 4)
@@ -1217,15 +1272,11 @@ static void update_debug_tile_buffer(void)
                     left_color = (left_color > 0) ? left_color : backdrop_color;
                     right_color = (right_color > 0) ? right_color : backdrop_color;
 
-                    if ((x & 0x07) < 4)
-                        debug_tile_buffer[pixel] = left_color;
-                    else
-                        debug_tile_buffer[pixel] = right_color;
+                    debug_tile_buffer[pixel] = (x < 4) ? left_color : right_color;
                     continue;
                 }
                 else if (mode == 0)
                 {
-                    int tile_data_addr = (pattern_table_addr + (tile_number * 8) + offset_y) & 0x3FFF;
                     pattern_line = vram[tile_data_addr];
                     color_line = vram[(color_table_addr + (tile_number >> 3)) & 0x3FFF];
 
@@ -1236,7 +1287,6 @@ static void update_debug_tile_buffer(void)
                 }
                 else if (mode == 2)
                 {
-                    int tile_data_addr = (pattern_table_addr + (tile_number * 8) + offset_y) & 0x3FFF;
                     pattern_line = vram[tile_data_addr];
                     color_line = vram[(color_table_addr + (tile_number * 8) + offset_y) & 0x3FFF];
 
@@ -1247,43 +1297,18 @@ static void update_debug_tile_buffer(void)
                 }
                 else
                 {
-                    int tile_data_addr = (pattern_table_addr + (tile_number * 8) + offset_y) & 0x3FFF;
                     pattern_line = vram[tile_data_addr];
-                    fg_color = 15;
-                    bg_color = 0;
                 }
 
-                bool color_bit = IsSetBit(pattern_line, offset_x);
-                debug_tile_buffer[pixel] = color_bit ? fg_color : bg_color;
+                debug_tile_buffer[pixel] = IsSetBit(pattern_line, offset_x) ? fg_color : bg_color;
             }
         }
-    }
-    else
-    {
-        for (int y = 0; y < 256; y++)
-        {
-            int width_y = (y * 256);
-            int tile_y = y / 8;
-            int offset_y = y & 0x7;
 
-            for (int x = 0; x < 256; x++)
-            {
-                int tile_x = x / 8;
-                int offset_x = 7 - (x & 0x7);
-                int pixel = width_y + x;
-
-                int tile_number = (tile_y * 32) + tile_x;
-
-                int tile_data_addr = (pattern_table_addr + (tile_number * 8) + offset_y) & 0x3FFF;
-                bool color = IsSetBit(vram[tile_data_addr], offset_x);
-
-                debug_tile_buffer[pixel] = color ? 15 : 0;
-            }
-        }
+        update_debug_rect(debug_tile_buffer, emu_debug_tile_buffer, emu_debug_tile_dirty, tile_x << 3, tile_y << 3, 8, 8);
     }
 }
 
-static void update_debug_sprite_buffers(void)
+static void update_debug_sprite_buffers(bool refresh)
 {
     Video* video = gearcoleco->GetVideo();
     u8* regs = video->GetRegisters();
@@ -1299,6 +1324,14 @@ static void update_debug_sprite_buffers(void)
         int sprite_color = vram[sprite_attribute_offset + 3] & 0x0F;
         int sprite_tile = vram[sprite_attribute_offset + 2];
         sprite_tile &= (sprite_size == 16) ? 0xFC : 0xFF;
+        bool dirty = refresh || is_debug_vram_dirty(sprite_attribute_offset);
+
+        // 16x16 sprites fetch four consecutive 8 byte patterns
+        for (int block = 0; block < ((sprite_size == 16) ? 4 : 1); block++)
+            dirty = dirty || is_debug_vram_dirty(sprite_pattern_addr + ((sprite_tile + block) << 3));
+
+        if (!dirty)
+            continue;
 
         for (int pixel_y = 0; pixel_y < sprite_size; pixel_y++)
         {
@@ -1321,6 +1354,9 @@ static void update_debug_sprite_buffers(void)
                 debug_sprite_buffers[s][pixel] = sprite_pixel ? sprite_color : 0;
             }
         }
+
+        video->Render32bit(debug_sprite_buffers[s], emu_debug_sprite_buffers[s], GC_PIXEL_RGBA8888, 16 * 16);
+        emu_debug_sprite_dirty |= 1u << s;
     }
 }
 
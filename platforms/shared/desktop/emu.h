@@ -54,6 +54,10 @@ EXTERN u32 emu_savestates_generation;
 EXTERN u8* emu_debug_background_buffer;
 EXTERN u8* emu_debug_tile_buffer;
 EXTERN u8* emu_debug_sprite_buffers[GC_MAX_SPRITES];
+// Bit x of row y flags the 8x8 block at (x, y) as redrawn since the last upload
+EXTERN u32 emu_debug_background_dirty[32];
+EXTERN u32 emu_debug_tile_dirty[32];
+EXTERN u32 emu_debug_sprite_dirty;
 
 EXTERN Debug_Command emu_debug_command;
 EXTERN bool emu_debug_pc_changed;
@@ -118,6 +118,8 @@ void gui_debug_windows(void)
         gui_debug_memory_search_window();
         gui_debug_memory_find_bytes_window();
     }
+
+    gui_debug_memory_commit_writes();
 }
 
 void gui_debug_save_settings(const char* file_path)
@@ -134,12 +136,12 @@ void gui_debug_save_settings(const char* file_path)
     GearcolecoCore* core = emu_get_core();
     Processor* processor = core->GetProcessor();
 
-    std::vector<Processor::GC_Breakpoint>* breakpoints = processor->GetBreakpoints();
+    const std::vector<Processor::GC_Breakpoint>* breakpoints = processor->GetBreakpoints();
     int bp_count = (int)breakpoints->size();
     file.write((const char*)&bp_count, sizeof(int));
     for (int i = 0; i < bp_count; i++)
     {
-        Processor::GC_Breakpoint& bp = (*breakpoints)[i];
+        const Processor::GC_Breakpoint& bp = (*breakpoints)[i];
         file.write((const char*)&bp.enabled, sizeof(bool));
         file.write((const char*)&bp.type, sizeof(int));
         file.write((const char*)&bp.address1, sizeof(u16));
@@ -262,7 +264,7 @@ void gui_debug_load_settings(const char* file_path)
         return;
     }
 
-    processor->GetBreakpoints()->swap(breakpoints);
+    processor->EditBreakpoints()->swap(breakpoints);
     emu_debug_irq_breakpoints = irq_breakpoints;
 
     gui_debug_reset_disassembler_bookmarks();
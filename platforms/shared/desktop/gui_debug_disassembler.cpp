@@ -118,7 +118,7 @@ static void disassembler_menu(void);
 static void add_bookmark_popup(void);
 static void add_symbol_popup(void);
 static void save_full_disassembler(FILE* file);
-static void save_full_disassembler_map(FILE* file, const char* map_name, GC_Disassembler_Record** records, int size);
+static void save_full_disassembler_map(FILE* file, const char* map_name, DisassemblerMap* map);
 static void save_current_disassembler(FILE* file);
 static bool disassembler_uses_assembler_syntax(void);
 static bool symbol_sort_address_asc(const SymbolEntry& a, const SymbolEntry& b);
@@ -468,11 +468,13 @@ static void draw_breakpoints_content(void)
     ImGui::PushFont(gui_default_font);
 
     int remove = -1;
-    std::vector<Processor::GC_Breakpoint>* breakpoints = emu_get_core()->GetProcessor()->GetBreakpoints();
+    int toggle = -1;
+    Processor* processor = emu_get_core()->GetProcessor();
+    const std::vector<Processor::GC_Breakpoint>* breakpoints = processor->GetBreakpoints();
 
     for (long unsigned int b = 0; b < breakpoints->size(); b++)
     {
-        Processor::GC_Breakpoint* brk = &(*breakpoints)[b];
+        const Processor::GC_Breakpoint* brk = &(*breakpoints)[b];
 
         ImGui::PushID(10000 + b);
         if (ImGui::SmallButton("X"))
@@ -495,7 +497,7 @@ static void draw_breakpoints_content(void)
         ImGui::PushID(20000 + b);
         if (ImGui::SmallButton(brk->enabled ? "-" : "+"))
         {
-            brk->enabled = !brk->enabled;
+            toggle = b;
         }
         ImGui::PopID();
         if (ImGui::IsItemHovered())
@@ -564,9 +566,16 @@ static void draw_breakpoints_content(void)
 
     ImGui::PopFont();
 
+    if (toggle >= 0)
+    {
+        Processor::GC_Breakpoint* brk = &(*processor->EditBreakpoints())[toggle];
+        brk->enabled = !brk->enabled;
+    }
+
     if (remove >= 0)
     {
-        breakpoints->erase(breakpoints->begin() + remove);
+        std::vector<Processor::GC_Breakpoint>* edit = processor->EditBreakpoints();
+        edit->erase(edit->begin() + remove);
     }
 
     ImGui::EndChild();
@@ -683,11 +692,11 @@ static void prepare_drawable_lines(void)
             snprintf(line.name_enhanced, 64, "%s", line.record->name);
             line.tooltip[0] = 0;
 
-            std::vector<Processor::GC_Breakpoint>* breakpoints = emu_get_core()->GetProcessor()->GetBreakpoints();
+            const std::vector<Processor::GC_Breakpoint>* breakpoints = emu_get_core()->GetProcessor()->GetBreakpoints();
 
             for (long unsigned int b = 0; b < breakpoints->size(); b++)
             {
-                Processor::GC_Breakpoint* brk = &(*breakpoints)[b];
+                const Processor::GC_Breakpoint* brk = &(*breakpoints)[b];
 
                 if (brk->execute && (brk->address1 == i))
                 {
@@ -2457,20 +2466,20 @@ static void save_full_disassembler(FILE* file)
     Memory* memory = emu_get_core()->GetMemory();
     bool assembler_syntax = disassembler_uses_assembler_syntax();
 
-    save_full_disassembler_map(file, assembler_syntax ? "" : "BIOS", memory->GetDisassemblerBiosMap(), 0x2000);
-    save_full_disassembler_map(file, assembler_syntax ? "" : "RAM", memory->GetDisassemblerRamMap(), 0x400);
-    save_full_disassembler_map(file, assembler_syntax ? "" : "SGM", memory->GetDisassemblerSGMRamMap(), 0x8000);
-    save_full_disassembler_map(file, assembler_syntax ? "" : "ROM", memory->GetDisassemblerRomMap(), MAX_ROM_SIZE);
+    save_full_disassembler_map(file, assembler_syntax ? "" : "BIOS", memory->GetDisassemblerBiosMap());
+    save_full_disassembler_map(file, assembler_syntax ? "" : "RAM", memory->GetDisassemblerRamMap());
+    save_full_disassembler_map(file, assembler_syntax ? "" : "SGM", memory->GetDisassemblerSGMRamMap());
+    save_full_disassembler_map(file, assembler_syntax ? "" : "ROM", memory->GetDisassemblerRomMap());
 }
 
-static void save_full_disassembler_map(FILE* file, const char* map_name, GC_Disassembler_Record** records, int size)
+static void save_full_disassembler_map(FILE* file, const char* map_name, DisassemblerMap* map)
 {
-    if (!IsValidPointer(records))
+    if (!IsValidPointer(map))
         return;
 
-    for (int i = 0; i < size; i++)
+    for (int i = 0; i < (int)map->GetSize(); i++)
     {
-        GC_Disassembler_Record* record = records[i];
+        GC_Disassembler_Record* record = map->Get(i);
 
         if (IsValidPointer(record) && (record->name[0] != 0))
         {
@@ -38,6 +38,7 @@ MemEditor::MemEditor()
     m_jump_to_address = -1;
     m_scroll_to_address = -1;
     InitPointer(m_mem_data);
+    m_mem_written = false;
     m_mem_size = 0;
     m_mem_base_addr = 0;
     m_hex_addr_format[0] = 0;
@@ -283,6 +284,8 @@ void MemEditor::Draw(bool ascii, bool preview, bool options, bool cursors)
                                         mem_data_16[byte_address] = value;
                                     }
 
+                                    m_mem_written = true;
+
                                     if (byte_address < (m_mem_size - 1))
                                     {
                                         m_editing_address = byte_address + 1;
@@ -1721,6 +1724,8 @@ void MemEditor::Paste()
             m_mem_data[i] = data[i - start];
         }
 
+        m_mem_written = true;
+
         delete[] data;
     }
 
@@ -1807,6 +1812,8 @@ void MemEditor::SetValueToSelection(int value)
         for (int i = selection_start; i <= selection_end; i++)
             mem_data_16[i] = (uint16_t)value;
     }
+
+    m_mem_written = true;
 }
 
 void MemEditor::SaveToTextFile(const char* file_path)
@@ -1877,12 +1884,11 @@ void MemEditor::LoadFromBinaryFile(const char* file_path)
     if (file)
     {
         size_t bytes = (size_t)size;
-        if (fread(m_mem_data, 1, bytes, file) != bytes)
-        {
-            fclose(file);
-            return;
-        }
+        size_t read = fread(m_mem_data, 1, bytes, file);
         fclose(file);
+
+        if (read > 0)
+            m_mem_written = true;
     }
 }
 
@@ -2157,6 +2163,13 @@ int MemEditor::FindBytesSequence(const char* hex_str, int* out_addresses, int ma
     return count;
 }
 
+bool MemEditor::ConsumeWrites()
+{
+    bool written = m_mem_written;
+    m_mem_written = false;
+    return written;
+}
+
 void MemEditor::AddWatch()
 {
     m_add_watch = true;
@@ -2253,6 +2266,8 @@ void MemEditor::WriteWatchValue(const Watch& watch, uint32_t value)
     {
         m_mem_data[byte_offset + i] = (uint8_t)((value >> (i * 8)) & 0xFF);
     }
+
+    m_mem_written = true;
 }
 
 int MemEditor::WatchSizeBytes(int size)
@@ -106,6 +106,7 @@ public:
     int PerformSearch(int op, int compare_type, int compare_value, int data_type);
     std::vector<Search>* GetSearchResults();
     int FindBytesSequence(const char* hex_str, int* out_addresses, int max_results);
+    bool ConsumeWrites();
 
 private:
     bool IsColumnSeparator(int current_column, int column_count);
@@ -157,6 +158,7 @@ private:
     char m_hex_addr_format[16];
     int m_hex_addr_digits;
     int m_mem_word;
+    bool m_mem_written;
     char m_goto_address[7];
     char m_find_next[5];
     bool m_add_bookmark;
@@ -166,6 +166,17 @@ void gui_debug_memory_step_frame(void)
     }
 }
 
+void gui_debug_memory_commit_writes(void)
+{
+    // VRAM edits bypass the VDP, so its line cache and the VRAM viewers must be told
+    if (mem_edit[MEMORY_EDITOR_VRAM].ConsumeWrites())
+    {
+        Video* video = emu_get_core()->GetVideo();
+        video->InvalidateLineCache();
+        video->InvalidateDebugVRAM();
+    }
+}
+
 void gui_debug_memory_copy(void)
 {
     mem_edit[current_mem_edit].Copy();
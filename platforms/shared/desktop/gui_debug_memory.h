@@ -47,6 +47,7 @@ EXTERN void gui_debug_memory_search_window(void);
 EXTERN void gui_debug_memory_find_bytes_window(void);
 EXTERN void gui_debug_memory_watches_window(void);
 EXTERN void gui_debug_memory_step_frame(void);
+EXTERN void gui_debug_memory_commit_writes(void);
 EXTERN void gui_debug_memory_copy(void);
 EXTERN void gui_debug_memory_paste(void);
 EXTERN void gui_debug_memory_select_all(void);
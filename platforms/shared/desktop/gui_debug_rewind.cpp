@@ -32,6 +32,7 @@ static bool scrubbing = false;
 
 static void draw_transport_bar(void);
 static void draw_timeline(void);
+static void draw_stats(void);
 
 void gui_debug_window_rewind(void)
 {
@@ -48,6 +49,8 @@ void gui_debug_window_rewind(void)
     ImGui::Spacing();
     draw_timeline();
     ImGui::Spacing();
+    ImGui::Separator();
+    draw_stats();
 
     ImGui::End();
     ImGui::PopStyleVar();
@@ -167,6 +170,36 @@ static void draw_timeline(void)
     }
 }
 
+static void draw_stats(void)
+{
+    rewind_Stats stats;
+    rewind_get_stats(&stats);
+
+    float ratio = (stats.stored_bytes > 0) ? (float)stats.raw_bytes / (float)stats.stored_bytes : 0.0f;
+
+    ImGui::PushFont(gui_default_font);
+
+    ImGui::TextColored(violet, "HISTORY   "); ImGui::SameLine();
+    ImGui::TextColored(white, "%.1fs", stats.seconds); ImGui::SameLine();
+    ImGui::TextColored(gray, "(%d snapshots, %d keyframes)", stats.snapshots, stats.keyframes);
+
+    ImGui::TextColored(violet, "STORED    "); ImGui::SameLine();
+    ImGui::TextColored(white, "%.2f MB", (float)stats.stored_bytes / (1024.0f * 1024.0f)); ImGui::SameLine();
+    ImGui::TextColored(gray, "of %.1f MB raw", (float)stats.raw_bytes / (1024.0f * 1024.0f));
+
+    ImGui::TextColored(violet, "RATIO     "); ImGui::SameLine();
+    ImGui::TextColored(white, "%.1f:1", ratio); ImGui::SameLine();
+    ImGui::TextColored(gray, "(%.1f MB allocated)", (float)stats.allocated_bytes / (1024.0f * 1024.0f));
+
+    ImGui::TextColored(violet, "COST      "); ImGui::SameLine();
+    ImGui::TextColored(white, "%.0f us", stats.push_us); ImGui::SameLine();
+    ImGui::TextColored(gray, "per snapshot,"); ImGui::SameLine();
+    ImGui::TextColored(white, "%.0f us", stats.seek_us); ImGui::SameLine();
+    ImGui::TextColored(gray, "last seek");
+
+    ImGui::PopFont();
+}
+
 bool gui_debug_rewind_seek(int age)
 {
     int snapshot_count = rewind_get_snapshot_count();
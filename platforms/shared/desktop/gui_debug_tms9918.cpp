@@ -693,6 +693,10 @@ void gui_debug_window_vram_regs(void)
     ImGui::Text("%d", video->GetRenderLine());
     ImGui::TextColored(violet, " CYCLE COUNTER    ");ImGui::SameLine();
     ImGui::Text("%d", video->GetCycleCounter());
+    ImGui::TextColored(violet, " LINE CACHE HITS  ");ImGui::SameLine();
+    ImGui::Text("%llu", (unsigned long long)video->GetLineCacheHits());
+    ImGui::TextColored(violet, " LINE CACHE MISSES");ImGui::SameLine();
+    ImGui::Text("%llu", (unsigned long long)video->GetLineCacheMisses());
 
     ImGui::NewLine();
     ImGui::TextColored(brown, "REGISTERS");
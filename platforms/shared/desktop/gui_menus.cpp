@@ -217,6 +217,17 @@ static void menu_gearcoleco(void)
                 ImGui::EndTooltip();
             }
 
+            ImGui::MenuItem("Second Instance", NULL, &config_emulator.runahead_second_instance);
+
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                ImGui::Text("Runs the speculative frames on a second emulator kept in sync with the real one.");
+                ImGui::Text("Avoids restoring a savestate every frame and uses another CPU core when available.");
+                ImGui::Text("Doubles memory use and falls back to the regular mode if the copy cannot be created.");
+                ImGui::EndTooltip();
+            }
+
             ImGui::EndMenu();
         }
 
@@ -22,6 +22,7 @@
 #include "gearcoleco.h"
 #include "application.h"
 #include "application_headless.h"
+#include "batch.h"
 #include "config.h"
 #include "console_utils.h"
 
@@ -88,6 +89,83 @@ int main(int argc, char* argv[])
             {
                 portable = true;
             }
+            else if (strcmp(argv[i], "--benchmark") == 0)
+            {
+                if (i + 1 >= argc || argv[i + 1][0] == '-')
+                {
+                    fprintf(stderr, "Missing value for --benchmark\n");
+                    return -1;
+                }
+
+                char* end = NULL;
+                long frames = strtol(argv[++i], &end, 10);
+                if (!end || *end != '\0' || frames <= 0 || frames > 100000000)
+                {
+                    fprintf(stderr, "Invalid frame count: %s\n", argv[i]);
+                    return -1;
+                }
+                app_params.benchmark_frames = (int)frames;
+            }
+            else if ((strcmp(argv[i], "--frames") == 0) || (strcmp(argv[i], "--jobs") == 0))
+            {
+                if (i + 1 >= argc || argv[i + 1][0] == '-')
+                {
+                    fprintf(stderr, "Missing value for %s\n", argv[i]);
+                    return -1;
+                }
+
+                bool frames_option = (strcmp(argv[i], "--frames") == 0);
+                char* end = NULL;
+                long value = strtol(argv[++i], &end, 10);
+                if (!end || *end != '\0' || value <= 0 || value > 100000000)
+                {
+                    fprintf(stderr, "Invalid %s: %s\n", frames_option ? "frame count" : "job count", argv[i]);
+                    return -1;
+                }
+
+                if (frames_option)
+                    app_params.batch_frames = (int)value;
+                else
+                    app_params.batch_jobs = (int)value;
+            }
+            else if ((strcmp(argv[i], "--batch") == 0) || (strcmp(argv[i], "--output") == 0) ||
+                     (strcmp(argv[i], "--baseline") == 0) || (strcmp(argv[i], "--screenshots") == 0))
+            {
+                if (i + 1 >= argc || argv[i + 1][0] == '-')
+                {
+                    fprintf(stderr, "Missing value for %s\n", argv[i]);
+                    return -1;
+                }
+
+                const char* option = argv[i++];
+
+                if (strcmp(option, "--batch") == 0)
+                    app_params.batch_path = argv[i];
+                else if (strcmp(option, "--output") == 0)
+                    app_params.batch_output = argv[i];
+                else if (strcmp(option, "--baseline") == 0)
+                    app_params.batch_baseline = argv[i];
+                else
+                    app_params.batch_screenshots = argv[i];
+            }
+            else if (strcmp(argv[i], "--bios") == 0)
+            {
+                if (i + 1 >= argc || argv[i + 1][0] == '-')
+                {
+                    fprintf(stderr, "Missing value for --bios\n");
+                    return -1;
+                }
+
+                app_params.bios_file = argv[++i];
+            }
+            else if (strcmp(argv[i], "--no-render") == 0)
+            {
+                app_params.benchmark_no_render = true;
+            }
+            else if (strcmp(argv[i], "--no-audio") == 0)
+            {
+                app_params.benchmark_no_audio = true;
+            }
             else if (strcmp(argv[i], "--mcp-http-port") == 0)
             {
                 if (i + 1 >= argc || argv[i + 1][0] == '-')
@@ -129,7 +207,11 @@ int main(int argc, char* argv[])
     int non_option_count = 0;
     for (int i = 1; i < argc; i++)
     {
-        if ((strcmp(argv[i], "--mcp-http-port") == 0) || (strcmp(argv[i], "--mcp-http-address") == 0))
+        if ((strcmp(argv[i], "--mcp-http-port") == 0) || (strcmp(argv[i], "--mcp-http-address") == 0) ||
+            (strcmp(argv[i], "--benchmark") == 0) || (strcmp(argv[i], "--bios") == 0) ||
+            (strcmp(argv[i], "--batch") == 0) || (strcmp(argv[i], "--frames") == 0) ||
+            (strcmp(argv[i], "--jobs") == 0) || (strcmp(argv[i], "--output") == 0) ||
+            (strcmp(argv[i], "--baseline") == 0) || (strcmp(argv[i], "--screenshots") == 0))
         {
             if (i + 1 < argc)
                 i++;
@@ -176,6 +258,16 @@ int main(int argc, char* argv[])
         printf("      --mcp-http-port N       HTTP port for MCP server (default: 7777)\n");
         printf("      --headless              Run without GUI (requires --mcp-stdio or --mcp-http)\n");
         printf("      --portable              Store configuration and user data beside the application\n");
+        printf("      --benchmark N           Run N frames uncapped without GUI and print a timing report\n");
+        printf("      --bios FILE             BIOS used by --benchmark and --batch (default: the configured BIOS)\n");
+        printf("      --no-render             Skip video rendering in --benchmark\n");
+        printf("      --no-audio              Skip audio output in --benchmark\n");
+        printf("      --batch PATH            Run every ROM in a directory or list file without GUI\n");
+        printf("      --frames N              Frames to run per ROM in --batch (default: 600)\n");
+        printf("      --jobs N                Worker threads for --batch (default: one per CPU core)\n");
+        printf("      --output DIR            Write --batch frame hashes and screenshots to DIR\n");
+        printf("      --baseline DIR          Compare --batch frame hashes against a previous --output DIR\n");
+        printf("      --screenshots F1,F2,... Frames saved as PNG to the --output DIR\n");
         printf("  -v, --version               Display version information\n");
         printf("  -h, --help                  Display this help message\n");
         return ret;
@@ -197,6 +289,20 @@ int main(int argc, char* argv[])
     else
         app_params.mcp_http_address = config_emulator.mcp_http_address;
 
+    if (IsValidPointer(app_params.batch_path))
+    {
+        ret = batch_run(app_params);
+        config_destroy();
+        return ret;
+    }
+
+    if (app_params.benchmark_frames > 0)
+    {
+        ret = application_headless_benchmark(app_params);
+        config_destroy();
+        return ret;
+    }
+
     if (headless)
     {
         ret = application_headless_init(app_params);
@@ -178,7 +178,7 @@ void DebugAdapter::SetBreakpointRange(u16 start_address, u16 end_address, int ty
 void DebugAdapter::ClearBreakpointByAddress(u16 address, int type, u16 end_address)
 {
     Processor* cpu = m_core->GetProcessor();
-    std::vector<Processor::GC_Breakpoint>* breakpoints = cpu->GetBreakpoints();
+    std::vector<Processor::GC_Breakpoint>* breakpoints = cpu->EditBreakpoints();
 
     for (int i = (int)breakpoints->size() - 1; i >= 0; i--)
     {
@@ -204,7 +204,7 @@ std::vector<BreakpointInfo> DebugAdapter::ListBreakpoints()
 {
     std::vector<BreakpointInfo> result;
     Processor* cpu = m_core->GetProcessor();
-    std::vector<Processor::GC_Breakpoint>* breakpoints = cpu->GetBreakpoints();
+    const std::vector<Processor::GC_Breakpoint>* breakpoints = cpu->GetBreakpoints();
 
     for (const Processor::GC_Breakpoint& brk : *breakpoints)
     {
@@ -358,6 +358,12 @@ void DebugAdapter::WriteMemoryArea(int area, u32 offset, const std::vector<u8>&
     {
         info.data[offset + i] = data[i];
     }
+
+    if (area == MEMORY_EDITOR_VRAM)
+    {
+        m_core->GetVideo()->InvalidateLineCache();
+        m_core->GetVideo()->InvalidateDebugVRAM();
+    }
 }
 
 std::vector<DisasmLine> DebugAdapter::GetDisassembly(u16 start_address, u16 end_address, int bank, bool resolve_symbols)
@@ -1275,12 +1281,18 @@ json DebugAdapter::ToggleFastForward(bool enabled)
 json DebugAdapter::GetRewindStatus()
 {
     json result;
+    rewind_Stats stats;
+    rewind_get_stats(&stats);
 
     result["active"] = rewind_is_active();
     result["snapshot_count"] = rewind_get_snapshot_count();
     result["capacity"] = rewind_get_capacity();
     result["frames_per_snapshot"] = rewind_get_frames_per_snapshot();
     result["memory_usage"] = rewind_get_memory_usage();
+    result["keyframe_count"] = stats.keyframes;
+    result["history_seconds"] = stats.seconds;
+    result["raw_bytes"] = stats.raw_bytes;
+    result["stored_bytes"] = stats.stored_bytes;
     result["enabled"] = config_rewind.enabled;
     result["buffer_seconds"] = config_rewind.buffer_seconds;
     result["speed"] = config_rewind.speed;
@@ -67,6 +67,7 @@ static void render_quad(uint32_t program, uint32_t texture, int viewport_width,
 static void render_quad_preset(int pass_index, uint32_t program, uint32_t texture, int input_width, int input_height, int viewport_width, int viewport_height);
 static void update_system_texture(void);
 static void update_debug_textures(void);
+static void upload_dirty_blocks(uint32_t texture, u8* buffer, u32* dirty_rows);
 static void update_savestates_texture(void);
 static void load_configured_shader_preset(void);
 static void apply_shader_parameter_config(void);
@@ -477,28 +478,62 @@ static void update_system_texture(void)
 static void update_debug_textures(void)
 {
     if (config_debug.show_video_nametable)
-    {
-        glBindTexture(GL_TEXTURE_2D, ogl_renderer_emu_debug_vram_background);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 256,
-            GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*) emu_debug_background_buffer);
-    }
+        upload_dirty_blocks(ogl_renderer_emu_debug_vram_background, emu_debug_background_buffer, emu_debug_background_dirty);
 
     if (config_debug.show_video_sprites)
     {
         for (int s = 0; s < GC_MAX_SPRITES; s++)
         {
+            if (!((emu_debug_sprite_dirty >> s) & 1))
+                continue;
+
             glBindTexture(GL_TEXTURE_2D, ogl_renderer_emu_debug_vram_sprites[s]);
             glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 16, 16,
                 GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*) emu_debug_sprite_buffers[s]);
         }
+
+        emu_debug_sprite_dirty = 0;
     }
 
     if (config_debug.show_video_tiles)
+        upload_dirty_blocks(ogl_renderer_emu_debug_vram_tiles, emu_debug_tile_buffer, emu_debug_tile_dirty);
+}
+
+// Uploads each horizontal run of redrawn 8x8 blocks of a 256x256 texture
+static void upload_dirty_blocks(uint32_t texture, u8* buffer, u32* dirty_rows)
+{
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 256);
+
+    for (int block_y = 0; block_y < 32; block_y++)
     {
-        glBindTexture(GL_TEXTURE_2D, ogl_renderer_emu_debug_vram_tiles);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 32 * 8, 32 * 8,
-            GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*) emu_debug_tile_buffer);
+        u32 row = dirty_rows[block_y];
+        dirty_rows[block_y] = 0;
+        int block_x = 0;
+
+        while (row != 0)
+        {
+            while (!(row & 1))
+            {
+                row >>= 1;
+                block_x++;
+            }
+
+            int first = block_x;
+
+            while (row & 1)
+            {
+                row >>= 1;
+                block_x++;
+            }
+
+            int offset = ((block_y * 8 * 256) + (first * 8)) * 4;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, first * 8, block_y * 8, (block_x - first) * 8, 8,
+                GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*) (buffer + offset));
+        }
     }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 }
 
 static void update_savestates_texture(void)
@@ -18,6 +18,8 @@
  */
 
 #include <string.h>
+#include <SDL3/SDL.h>
+#include "miniz.h"
 #include "emu.h"
 #include "config.h"
 #include "events.h"
@@ -25,8 +27,33 @@
 #define REWIND_IMPORT
 #include "rewind.h"
 
-static u8* buffer = NULL;
-static size_t sizes[REWIND_MAX_SNAPSHOTS] = { 0 };
+// Shortest run of unchanged bytes worth closing a literal run for
+#define REWIND_MIN_ZERO_RUN 8
+
+// The newest snapshot is kept raw. Every older one is stored in the pool
+// either as a deflated keyframe or as the XOR against its newer neighbour,
+// so stepping back one snapshot decodes a single entry.
+struct rewind_Snapshot
+{
+    size_t offset;
+    size_t size;
+    size_t raw_size;
+    u32 sequence;
+    bool keyframe;
+};
+
+static rewind_Snapshot* snapshots = NULL;
+static u8* pool = NULL;
+static size_t pool_head = 0;
+static u8* newest = NULL;
+static size_t newest_size = 0;
+static u8* incoming = NULL;
+static u8* seek_buffer = NULL;
+static size_t seek_size = 0;
+static int seek_cache_age = -1;
+static u8* encoded = NULL;
+static size_t state_capacity = 0;
+static u32 sequence = 0;
 static int head = 0;
 static int count = 0;
 static int capacity = 0;
@@ -34,16 +61,32 @@ static int frame_accum = 0;
 static bool active = false;
 static bool storage_dirty = true;
 static int seek_age = -1;
-static size_t slot_size = 0;
 static size_t allocated_size = 0;
+static int keyframe_count = 0;
+static size_t raw_bytes = 0;
+static size_t stored_bytes = 0;
+static double push_time_total = 0.0;
+static int push_time_count = 0;
+static float last_seek_us = 0.0f;
 
 static int slot_at(int age);
 static int get_target_capacity(void);
 static size_t get_target_slot_size(void);
 static bool ensure_storage(void);
+static bool ensure_state_buffers(size_t size);
 static void release_storage(void);
+static void clear_history(void);
+static void drop_oldest(void);
+static bool drop_newest(void);
+static bool encode_newest(const u8* younger, size_t younger_size);
+static bool reserve_pool(size_t size, size_t* offset);
+static bool decode_snapshot(const rewind_Snapshot* snapshot, u8* state, size_t* state_size);
+static bool reconstruct(int age);
+static size_t encode_delta(const u8* state, size_t size, const u8* base, size_t base_size, u8* out, size_t out_size);
+static bool apply_delta(const u8* delta, size_t delta_size, u8* state, size_t size);
 static void truncate_to_seek_position(void);
 static void restore_screenshot(const u8* slot, size_t size);
+static float elapsed_us(Uint64 start);
 
 bool rewind_init(void)
 {
@@ -64,14 +107,11 @@ void rewind_destroy(void)
 
 void rewind_reset(void)
 {
-    head = 0;
-    count = 0;
     frame_accum = 0;
     active = false;
     storage_dirty = true;
     seek_age = -1;
-    for (int i = 0; i < REWIND_MAX_SNAPSHOTS; i++)
-        sizes[i] = 0;
+    clear_history();
 
     if (!config_rewind.enabled || emu_is_empty())
     {
@@ -79,7 +119,6 @@ void rewind_reset(void)
         return;
     }
 
-    capacity = get_target_capacity();
     ensure_storage();
 }
 
@@ -87,7 +126,7 @@ void rewind_push(void)
 {
     if (!config_rewind.enabled)
         return;
-    if (!IsValidPointer(buffer))
+    if (!IsValidPointer(pool))
         return;
     if (emu_is_empty() || emu_is_paused())
         return;
@@ -102,52 +141,76 @@ void rewind_push(void)
     if (!ensure_storage())
         return;
 
-    u8* slot = buffer + ((size_t)head * slot_size);
-    size_t size = slot_size;
+    Uint64 start = SDL_GetPerformanceCounter();
+    size_t size = state_capacity;
 
-    if (!emu_get_core()->SaveState(slot, size, true))
+    if (!emu_get_core()->SaveState(incoming, size, true))
     {
-        storage_dirty = true;
-        if (!ensure_storage())
+        // The state outgrew the buffers, grow them and retry once
+        if (!ensure_state_buffers(get_target_slot_size()))
             return;
 
-        slot = buffer + ((size_t)head * slot_size);
-        size = slot_size;
-        if (!emu_get_core()->SaveState(slot, size, true))
+        size = state_capacity;
+        if (!emu_get_core()->SaveState(incoming, size, true))
         {
-            Log("Rewind: failed to save snapshot into %zu-byte slot", slot_size);
+            Log("Rewind: failed to save snapshot into %zu-byte buffer", state_capacity);
             return;
         }
     }
 
-    sizes[head] = size;
+    seek_cache_age = -1;
+
+    if ((count > 0) && (capacity > 1) && !encode_newest(incoming, size))
+        clear_history();
+
+    if (count == capacity)
+        drop_oldest();
+
+    u8* swap = newest;
+    newest = incoming;
+    incoming = swap;
+    newest_size = size;
+
+    rewind_Snapshot* snapshot = &snapshots[head];
+    snapshot->offset = 0;
+    snapshot->size = 0;
+    snapshot->raw_size = size;
+    snapshot->sequence = sequence++;
+    snapshot->keyframe = false;
+    raw_bytes += size;
+
     head = (head + 1) % capacity;
-    if (count < capacity)
-        count++;
+    count++;
+
+    push_time_total += elapsed_us(start);
+    push_time_count++;
 }
 
 bool rewind_pop(void)
 {
     if (count == 0)
         return false;
-    if (!IsValidPointer(buffer))
+    if (!IsValidPointer(pool))
         return false;
 
-    int idx = slot_at(0);
-    const u8* slot = buffer + ((size_t)idx * slot_size);
-    size_t size = sizes[idx];
-
-    bool ok = emu_get_core()->LoadState(slot, size);
+    Uint64 start = SDL_GetPerformanceCounter();
+    bool ok = emu_get_core()->LoadState(newest, newest_size);
 
     if (ok)
     {
-        restore_screenshot(slot, size);
+        restore_screenshot(newest, newest_size);
         events_sync_input();
     }
 
-    head = idx;
-    count--;
+    if (!drop_newest())
+    {
+        Log("Rewind: failed to decode snapshot, clearing history");
+        clear_history();
+    }
+
     seek_age = -1;
+    seek_cache_age = -1;
+    last_seek_us = elapsed_us(start);
     return ok;
 }
 
@@ -178,26 +241,47 @@ size_t rewind_get_memory_usage(void)
     return allocated_size;
 }
 
+void rewind_get_stats(rewind_Stats* stats)
+{
+    int fps = config_rewind.frames_per_snapshot;
+    if (fps < 1)
+        fps = 1;
+
+    stats->snapshots = count;
+    stats->keyframes = keyframe_count;
+    stats->seconds = (float)(count * fps) / 60.0f;
+    stats->raw_bytes = raw_bytes;
+    stats->stored_bytes = (count > 0) ? stored_bytes + newest_size : 0;
+    stats->allocated_bytes = allocated_size;
+    stats->push_us = (push_time_count > 0) ? (float)(push_time_total / push_time_count) : 0.0f;
+    stats->seek_us = last_seek_us;
+}
+
 bool rewind_seek(int age)
 {
     if (age < 0 || age >= count)
         return false;
-    if (!IsValidPointer(buffer))
+    if (!IsValidPointer(pool))
         return false;
 
-    int idx = slot_at(age);
-    const u8* slot = buffer + ((size_t)idx * slot_size);
-    size_t size = sizes[idx];
+    Uint64 start = SDL_GetPerformanceCounter();
 
-    bool ok = emu_get_core()->LoadState(slot, size);
+    if (!reconstruct(age))
+    {
+        Log("Rewind: failed to decode snapshot %d", age);
+        return false;
+    }
+
+    bool ok = emu_get_core()->LoadState(seek_buffer, seek_size);
 
     if (ok)
     {
-        restore_screenshot(slot, size);
+        restore_screenshot(seek_buffer, seek_size);
         events_sync_input();
         seek_age = age;
     }
 
+    last_seek_us = elapsed_us(start);
     return ok;
 }
 
@@ -255,67 +339,464 @@ static bool ensure_storage(void)
     }
 
     int target_capacity = get_target_capacity();
-    if (!storage_dirty && IsValidPointer(buffer) && (capacity == target_capacity))
+    if (!storage_dirty && IsValidPointer(pool) && (capacity == target_capacity))
         return true;
 
     size_t target_slot_size = get_target_slot_size();
     if (target_slot_size == 0)
         return false;
 
-    if (storage_dirty && IsValidPointer(buffer) && (capacity == target_capacity) && (slot_size >= target_slot_size))
+    if (!IsValidPointer(pool))
     {
-        storage_dirty = false;
-        return true;
+        pool = new (std::nothrow) u8[REWIND_POOL_SIZE];
+        if (!IsValidPointer(pool))
+        {
+            Log("Rewind: failed to allocate %d bytes", REWIND_POOL_SIZE);
+            return false;
+        }
     }
 
-    size_t target_size = (size_t)target_capacity * target_slot_size;
-    u8* new_buffer = new (std::nothrow) u8[target_size];
-    if (!IsValidPointer(new_buffer))
+    if (!IsValidPointer(snapshots) || (capacity != target_capacity))
     {
-        Log("Rewind: failed to allocate %zu bytes", target_size);
-        return false;
+        rewind_Snapshot* new_snapshots = new (std::nothrow) rewind_Snapshot[target_capacity];
+        if (!IsValidPointer(new_snapshots))
+        {
+            Log("Rewind: failed to allocate %d snapshots", target_capacity);
+            return false;
+        }
+
+        SafeDeleteArray(snapshots);
+        snapshots = new_snapshots;
+        capacity = target_capacity;
     }
 
-    SafeDeleteArray(buffer);
-    buffer = new_buffer;
-    allocated_size = target_size;
-    slot_size = target_slot_size;
-    capacity = target_capacity;
-    head = 0;
-    count = 0;
+    if (!ensure_state_buffers(target_slot_size))
+        return false;
+
+    clear_history();
     frame_accum = 0;
     active = false;
     storage_dirty = false;
     seek_age = -1;
-    for (int i = 0; i < REWIND_MAX_SNAPSHOTS; i++)
-        sizes[i] = 0;
 
-    Log("Rewind: allocated %.1f MB ring buffer (%d snapshots, %zu-byte slots)",
-        (double)target_size / (1024.0 * 1024.0), target_capacity, target_slot_size);
+    Log("Rewind: allocated %.1f MB (%d snapshots, %.1f MB compressed pool)",
+        (double)allocated_size / (1024.0 * 1024.0), capacity, (double)REWIND_POOL_SIZE / (1024.0 * 1024.0));
+
+    return true;
+}
+
+static bool ensure_state_buffers(size_t size)
+{
+    if (size == 0)
+        return false;
+    if (size <= state_capacity)
+        return true;
+
+    // Deltas against a smaller state treat the missing tail as zeros
+    size_t encoded_size = (size * 2) + 64;
+    u8* new_newest = new (std::nothrow) u8[size];
+    u8* new_incoming = new (std::nothrow) u8[size];
+    u8* new_seek = new (std::nothrow) u8[size];
+    u8* new_encoded = new (std::nothrow) u8[encoded_size];
+
+    if (!IsValidPointer(new_newest) || !IsValidPointer(new_incoming) || !IsValidPointer(new_seek) || !IsValidPointer(new_encoded))
+    {
+        Log("Rewind: failed to allocate %zu-byte state buffers", size);
+        SafeDeleteArray(new_newest);
+        SafeDeleteArray(new_incoming);
+        SafeDeleteArray(new_seek);
+        SafeDeleteArray(new_encoded);
+        return false;
+    }
+
+    if (IsValidPointer(newest))
+        memcpy(new_newest, newest, newest_size);
+
+    SafeDeleteArray(newest);
+    SafeDeleteArray(incoming);
+    SafeDeleteArray(seek_buffer);
+    SafeDeleteArray(encoded);
+    newest = new_newest;
+    incoming = new_incoming;
+    seek_buffer = new_seek;
+    encoded = new_encoded;
+    state_capacity = size;
+    seek_cache_age = -1;
+
+    allocated_size = REWIND_POOL_SIZE + ((size_t)capacity * sizeof(rewind_Snapshot)) + (3 * size) + encoded_size;
 
     return true;
 }
 
 static void release_storage(void)
 {
-    SafeDeleteArray(buffer);
+    SafeDeleteArray(pool);
+    SafeDeleteArray(snapshots);
+    SafeDeleteArray(newest);
+    SafeDeleteArray(incoming);
+    SafeDeleteArray(seek_buffer);
+    SafeDeleteArray(encoded);
+    state_capacity = 0;
     allocated_size = 0;
-    slot_size = 0;
     capacity = 0;
+    clear_history();
+}
+
+static void clear_history(void)
+{
+    head = 0;
+    count = 0;
+    pool_head = 0;
+    newest_size = 0;
+    seek_cache_age = -1;
+    keyframe_count = 0;
+    raw_bytes = 0;
+    stored_bytes = 0;
+    push_time_total = 0.0;
+    push_time_count = 0;
+    last_seek_us = 0.0f;
+}
+
+static void drop_oldest(void)
+{
+    rewind_Snapshot* snapshot = &snapshots[slot_at(count - 1)];
+
+    stored_bytes -= snapshot->size;
+    raw_bytes -= snapshot->raw_size;
+    if (snapshot->keyframe)
+        keyframe_count--;
+
+    count--;
+}
+
+// Makes the snapshot before the newest one the new raw newest state
+static bool drop_newest(void)
+{
+    int idx = slot_at(0);
+    raw_bytes -= snapshots[idx].raw_size;
+
+    if (count > 1)
+    {
+        rewind_Snapshot* snapshot = &snapshots[slot_at(1)];
+
+        if (!decode_snapshot(snapshot, newest, &newest_size))
+            return false;
+
+        stored_bytes -= snapshot->size;
+        if (snapshot->keyframe)
+            keyframe_count--;
+
+        pool_head = snapshot->offset;
+        snapshot->size = 0;
+        snapshot->keyframe = false;
+    }
+
+    head = idx;
+    count--;
+    return true;
+}
+
+// Moves the raw newest state into the pool, encoded against the state that replaces it
+static bool encode_newest(const u8* younger, size_t younger_size)
+{
+    rewind_Snapshot* snapshot = &snapshots[slot_at(0)];
+    size_t encoded_capacity = (state_capacity * 2) + 64;
+    size_t size = 0;
+    bool keyframe = (snapshot->sequence % REWIND_KEYFRAME_INTERVAL) == 0;
+
+    if (!keyframe)
+    {
+        size = encode_delta(newest, newest_size, younger, younger_size, encoded, encoded_capacity);
+        keyframe = (size == 0) && (newest_size > 0);
+    }
+
+    if (keyframe)
+    {
+        int flags = (int)tdefl_create_comp_flags_from_zip_params(MZ_BEST_SPEED, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+        size = tdefl_compress_mem_to_mem(encoded, encoded_capacity, newest, newest_size, flags);
+        if (size == 0)
+            return false;
+    }
+
+    size_t offset = 0;
+    if (!reserve_pool(size, &offset))
+    {
+        Log("Rewind: %zu-byte snapshot does not fit in the pool", size);
+        return false;
+    }
+
+    memcpy(pool + offset, encoded, size);
+    pool_head = offset + size;
+
+    snapshot->offset = offset;
+    snapshot->size = size;
+    snapshot->keyframe = keyframe;
+    stored_bytes += size;
+    if (keyframe)
+        keyframe_count++;
+
+    return true;
+}
+
+// Finds room for a new entry after the newest one, evicting the oldest snapshots
+static bool reserve_pool(size_t size, size_t* offset)
+{
+    if (size > REWIND_POOL_SIZE)
+        return false;
+
+    for (;;)
+    {
+        if (count < 2)
+        {
+            *offset = 0;
+            return true;
+        }
+
+        size_t tail = snapshots[slot_at(count - 1)].offset;
+
+        if (tail < pool_head)
+        {
+            // Live entries are [tail, pool_head)
+            if ((pool_head + size) <= REWIND_POOL_SIZE)
+            {
+                *offset = pool_head;
+                return true;
+            }
+            if (size <= tail)
+            {
+                *offset = 0;
+                return true;
+            }
+        }
+        else if ((pool_head + size) <= tail)
+        {
+            // Live entries wrap around, [tail, end) and [0, pool_head)
+            *offset = pool_head;
+            return true;
+        }
+
+        drop_oldest();
+    }
+}
+
+static bool decode_snapshot(const rewind_Snapshot* snapshot, u8* state, size_t* state_size)
+{
+    const u8* data = pool + snapshot->offset;
+
+    if (snapshot->keyframe)
+    {
+        size_t size = tinfl_decompress_mem_to_mem(state, snapshot->raw_size, data, snapshot->size, 0);
+        if (size != snapshot->raw_size)
+            return false;
+    }
+    else
+    {
+        if (snapshot->raw_size > *state_size)
+            memset(state + *state_size, 0, snapshot->raw_size - *state_size);
+
+        if (!apply_delta(data, snapshot->size, state, snapshot->raw_size))
+            return false;
+    }
+
+    *state_size = snapshot->raw_size;
+    return true;
+}
+
+// Rebuilds the state at the given age into the seek buffer, starting from the
+// closest newer keyframe, the previous seek position or the raw newest state
+static bool reconstruct(int age)
+{
+    int from = age;
+    while ((from > 0) && (from != seek_cache_age) && !snapshots[slot_at(from)].keyframe)
+        from--;
+
+    if (from != seek_cache_age)
+    {
+        if (from == 0)
+        {
+            memcpy(seek_buffer, newest, newest_size);
+            seek_size = newest_size;
+        }
+        else if (!decode_snapshot(&snapshots[slot_at(from)], seek_buffer, &seek_size))
+        {
+            seek_cache_age = -1;
+            return false;
+        }
+    }
+
+    for (int i = from + 1; i <= age; i++)
+    {
+        if (!decode_snapshot(&snapshots[slot_at(i)], seek_buffer, &seek_size))
+        {
+            seek_cache_age = -1;
+            return false;
+        }
+    }
+
+    seek_cache_age = age;
+    return true;
+}
+
+static INLINE size_t write_varint(u8* out, size_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80)
+    {
+        out[n++] = (u8)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (u8)value;
+    return n;
+}
+
+static INLINE bool read_varint(const u8** in, const u8* end, size_t* value)
+{
+    size_t result = 0;
+    int shift = 0;
+    while (*in < end)
+    {
+        u8 byte = *(*in)++;
+        result |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+static INLINE u8 delta_at(const u8* state, const u8* base, size_t base_size, size_t i)
+{
+    return state[i] ^ ((i < base_size) ? base[i] : 0);
+}
+
+// Encodes state ^ base as pairs of (unchanged run, changed run) lengths, each
+// followed by the changed bytes. Returns 0 if it does not fit in out_size.
+static size_t encode_delta(const u8* state, size_t size, const u8* base, size_t base_size, u8* out, size_t out_size)
+{
+    size_t common = MIN(size, base_size);
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < size)
+    {
+        size_t run_start = i;
+
+        while ((i + 8) <= common)
+        {
+            u64 a, b;
+            memcpy(&a, state + i, 8);
+            memcpy(&b, base + i, 8);
+            if (a != b)
+                break;
+            i += 8;
+        }
+        while ((i < size) && (delta_at(state, base, base_size, i) == 0))
+            i++;
+
+        if (i == size)
+            break;
+
+        size_t literal_start = i;
+        size_t literal_end = i;
+        size_t j = i;
+        while ((j < size) && ((j - literal_end) < REWIND_MIN_ZERO_RUN))
+        {
+            if (delta_at(state, base, base_size, j) != 0)
+                literal_end = j + 1;
+            j++;
+        }
+
+        size_t literal_size = literal_end - literal_start;
+        if ((o + 20 + literal_size) > out_size)
+            return 0;
+
+        o += write_varint(out + o, literal_start - run_start);
+        o += write_varint(out + o, literal_size);
+        for (size_t k = literal_start; k < literal_end; k++)
+            out[o++] = delta_at(state, base, base_size, k);
+
+        i = literal_end;
+    }
+
+    // An empty delta still needs a byte so it is not mistaken for a failure
+    if (o == 0)
+    {
+        if (out_size < 2)
+            return 0;
+        o += write_varint(out, size);
+        o += write_varint(out + o, 0);
+    }
+
+    return o;
+}
+
+static bool apply_delta(const u8* delta, size_t delta_size, u8* state, size_t size)
+{
+    const u8* in = delta;
+    const u8* end = delta + delta_size;
+    size_t pos = 0;
+
+    while (in < end)
+    {
+        size_t run = 0;
+        size_t literal_size = 0;
+
+        if (!read_varint(&in, end, &run) || !read_varint(&in, end, &literal_size))
+            return false;
+
+        pos += run;
+        if ((pos + literal_size > size) || (literal_size > (size_t)(end - in)))
+            return false;
+
+        for (size_t k = 0; k < literal_size; k++)
+            state[pos + k] ^= in[k];
+
+        in += literal_size;
+        pos += literal_size;
+    }
+
+    return true;
 }
 
 static void truncate_to_seek_position(void)
 {
-    if (seek_age <= 0)
+    if ((seek_age <= 0) || (seek_cache_age != seek_age))
     {
         seek_age = -1;
         return;
     }
 
+    for (int age = 0; age < seek_age; age++)
+    {
+        rewind_Snapshot* snapshot = &snapshots[slot_at(age)];
+        stored_bytes -= snapshot->size;
+        raw_bytes -= snapshot->raw_size;
+        if (snapshot->keyframe)
+            keyframe_count--;
+    }
+
+    // The seek buffer already holds this state raw, so it becomes the newest one
     int idx = slot_at(seek_age);
+    rewind_Snapshot* snapshot = &snapshots[idx];
+    stored_bytes -= snapshot->size;
+    if (snapshot->keyframe)
+        keyframe_count--;
+    pool_head = snapshot->offset;
+    snapshot->size = 0;
+    snapshot->keyframe = false;
+
+    u8* swap = newest;
+    newest = seek_buffer;
+    seek_buffer = swap;
+    newest_size = seek_size;
+
     head = (idx + 1) % capacity;
     count -= seek_age;
     seek_age = -1;
+    seek_cache_age = -1;
 }
 
 static void restore_screenshot(const u8* slot, size_t size)
@@ -343,3 +824,9 @@ static void restore_screenshot(const u8* slot, size_t size)
 
     memcpy(emu_frame_buffer, screenshot_data, header.screenshot_size);
 }
+
+static float elapsed_us(Uint64 start)
+{
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+    return (float)((double)elapsed * 1000000.0 / (double)SDL_GetPerformanceFrequency());
+}
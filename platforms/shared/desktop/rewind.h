@@ -28,8 +28,21 @@
     #define EXTERN extern
 #endif
 
-#define REWIND_MAX_STATE_SIZE       (256 * 1024)
-#define REWIND_MAX_SNAPSHOTS        600
+#define REWIND_MAX_SNAPSHOTS        36000
+#define REWIND_POOL_SIZE            (16 * 1024 * 1024)
+#define REWIND_KEYFRAME_INTERVAL    60
+
+struct rewind_Stats
+{
+    int snapshots;
+    int keyframes;
+    float seconds;
+    size_t raw_bytes;
+    size_t stored_bytes;
+    size_t allocated_bytes;
+    float push_us;
+    float seek_us;
+};
 
 EXTERN bool rewind_init(void);
 EXTERN void rewind_destroy(void);
@@ -44,6 +57,7 @@ EXTERN int rewind_get_snapshot_count(void);
 EXTERN int rewind_get_capacity(void);
 EXTERN int rewind_get_frames_per_snapshot(void);
 EXTERN size_t rewind_get_memory_usage(void);
+EXTERN void rewind_get_stats(rewind_Stats* stats);
 
 #undef REWIND_IMPORT
 #undef EXTERN
@@ -17,6 +17,12 @@
  *
  */
 
+#include <string.h>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <SDL3/SDL.h>
 #include "emu.h"
 #include "config.h"
 #include "gearcoleco.h"
@@ -24,11 +30,51 @@
 #define RUNAHEAD_IMPORT
 #include "runahead.h"
 
+// One checkpoint per frame the shadow core is ahead, plus the one being verified
+#define RUNAHEAD_MAX_CHECKPOINTS 4
+
 static u8* runahead_buffer = NULL;
 static s16* runahead_audio = NULL;
 static size_t runahead_buffer_size = 0;
 
+// Second instance: a shadow core that runs ahead of the authoritative one.
+// After every frame it runs, its state is kept as a checkpoint. Next frame the
+// authoritative state is compared with the oldest checkpoint: if it matches,
+// the prediction held and the shadow only needs to advance one more frame.
+// Anything else (new input, loads, resets, debugging) forces a resync.
+static GearcolecoCore* shadow = NULL;
+static s16* shadow_audio = NULL;
+static u8* checkpoints[RUNAHEAD_MAX_CHECKPOINTS] = { };
+static size_t checkpoint_sizes[RUNAHEAD_MAX_CHECKPOINTS] = { };
+static size_t checkpoint_capacity = 0;
+static int checkpoint_head = 0;
+static int checkpoint_count = 0;
+
+static std::thread shadow_thread;
+static std::mutex shadow_mutex;
+static std::condition_variable shadow_cv;
+static bool shadow_threaded = false;
+static bool shadow_pending = false;
+static bool shadow_quit = false;
+
+static bool job_resync = false;
+static size_t job_state_size = 0;
+static int job_frames = 0;
+static u8* job_frame_buffer = NULL;
+static bool job_ok = false;
+
+static void run_single_instance(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_count);
+static bool run_second_instance(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_count);
 static bool ensure_buffer(void);
+static bool ensure_shadow(void);
+static bool ensure_checkpoints(void);
+static bool checkpoint_matches(int frames, size_t state_size);
+static void copy_untracked_memory(void);
+static void shadow_job(void);
+static void shadow_thread_func(void);
+static void start_shadow_job(void);
+static void finish_shadow_job(void);
+static void destroy_shadow(void);
 
 void runahead_init(void)
 {
@@ -39,6 +85,7 @@ void runahead_init(void)
 
 void runahead_destroy(void)
 {
+    destroy_shadow();
     SafeDeleteArray(runahead_audio);
     SafeDeleteArray(runahead_buffer);
     runahead_buffer_size = 0;
@@ -55,6 +102,14 @@ int runahead_get_frames(void)
 }
 
 void runahead_run(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_count)
+{
+    if (config_emulator.runahead_second_instance && run_second_instance(frames, frame_buffer, sample_buffer, sample_count))
+        return;
+
+    run_single_instance(frames, frame_buffer, sample_buffer, sample_count);
+}
+
+static void run_single_instance(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_count)
 {
     GearcolecoCore* core = emu_get_core();
 
@@ -84,6 +139,7 @@ void runahead_run(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_
     {
         int discarded_samples = 0;
         bool render = (i == (frames - 1));
+        core->GetVideo()->SetSkipRender(!render);
         core->RunToVBlank(frame_buffer, runahead_audio, &discarded_samples, NULL, render);
     }
 
@@ -98,6 +154,63 @@ void runahead_run(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_
     }
 }
 
+static bool run_second_instance(int frames, u8* frame_buffer, s16* sample_buffer, int* sample_count)
+{
+    GearcolecoCore* core = emu_get_core();
+
+    if (((frames + 1) > RUNAHEAD_MAX_CHECKPOINTS) || !ensure_shadow())
+        return false;
+
+    if (!IsValidPointer(runahead_buffer) && !ensure_buffer())
+        return false;
+
+    // Snapshot the authoritative state before it advances. It is never loaded
+    // back into the authoritative core, only compared or handed to the shadow.
+    size_t state_size = runahead_buffer_size;
+    if (!core->SaveState(runahead_buffer, state_size, false))
+    {
+        ensure_buffer();
+        return false;
+    }
+
+    if (!ensure_checkpoints())
+        return false;
+
+    shadow->GetVideo()->CopySettings(core->GetVideo());
+
+    if (checkpoint_matches(frames, state_size))
+    {
+        checkpoint_head = (checkpoint_head + 1) % RUNAHEAD_MAX_CHECKPOINTS;
+        checkpoint_count--;
+        job_resync = false;
+        job_frames = 1;
+    }
+    else
+    {
+        copy_untracked_memory();
+        checkpoint_head = 0;
+        checkpoint_count = 0;
+        job_resync = true;
+        job_frames = frames + 1;
+    }
+
+    job_state_size = state_size;
+    job_frame_buffer = frame_buffer;
+    job_ok = true;
+
+    start_shadow_job();
+    core->RunToVBlank(frame_buffer, sample_buffer, sample_count, NULL, false);
+    finish_shadow_job();
+
+    if (!job_ok)
+    {
+        checkpoint_count = 0;
+        core->RenderFrameBuffer(frame_buffer);
+    }
+
+    return true;
+}
+
 static bool ensure_buffer(void)
 {
     size_t needed = 0;
@@ -122,3 +235,210 @@ static bool ensure_buffer(void)
     runahead_buffer_size = needed;
     return true;
 }
+
+static bool ensure_shadow(void)
+{
+    GearcolecoCore* core = emu_get_core();
+    Cartridge* cartridge = core->GetCartridge();
+    Memory* memory = core->GetMemory();
+
+    if (!cartridge->IsReady() || !memory->IsBiosLoaded())
+        return false;
+
+    if (IsValidPointer(shadow))
+    {
+        Cartridge* shadow_cartridge = shadow->GetCartridge();
+
+        if (shadow_cartridge->IsReady() &&
+            (shadow_cartridge->GetCRC() == cartridge->GetCRC()) &&
+            (shadow_cartridge->GetROMSize() == cartridge->GetROMSize()) &&
+            (shadow_cartridge->GetType() == cartridge->GetType()) &&
+            (shadow_cartridge->IsPAL() == cartridge->IsPAL()) &&
+            (memcmp(shadow->GetMemory()->GetBios(), memory->GetBios(), 0x2000) == 0))
+            return true;
+    }
+    else
+    {
+        shadow = new (std::nothrow) GearcolecoCore();
+        shadow_audio = new (std::nothrow) s16[GC_AUDIO_BUFFER_SIZE];
+
+        if (!IsValidPointer(shadow) || !IsValidPointer(shadow_audio))
+        {
+            Log("Run-ahead: failed to allocate the second instance, falling back to single instance");
+            config_emulator.runahead_second_instance = false;
+            destroy_shadow();
+            return false;
+        }
+
+        shadow->Init();
+        shadow_threaded = (SDL_GetNumLogicalCPUCores() > 1);
+    }
+
+    // The shadow mirrors the exact media the authoritative core is running
+    checkpoint_count = 0;
+
+    Cartridge::ForceConfiguration config;
+    config.type = cartridge->GetType();
+    config.region = cartridge->IsPAL() ? Cartridge::CartridgePAL : Cartridge::CartridgeNTSC;
+
+    if (!shadow->GetMemory()->LoadBiosFromBuffer(memory->GetBios(), 0x2000) ||
+        !shadow->LoadROMFromBuffer(cartridge->GetROM(), cartridge->GetROMSize(), &config))
+    {
+        Log("Run-ahead: failed to set up the second instance, falling back to single instance");
+        config_emulator.runahead_second_instance = false;
+        destroy_shadow();
+        return false;
+    }
+
+    return true;
+}
+
+static bool ensure_checkpoints(void)
+{
+    size_t needed = MAX(runahead_buffer_size, shadow->GetSaveStateSize(false));
+
+    if (checkpoint_capacity >= needed)
+        return true;
+
+    for (int i = 0; i < RUNAHEAD_MAX_CHECKPOINTS; i++)
+    {
+        SafeDeleteArray(checkpoints[i]);
+        checkpoints[i] = new (std::nothrow) u8[needed];
+
+        if (!IsValidPointer(checkpoints[i]))
+        {
+            for (int j = 0; j < i; j++)
+                SafeDeleteArray(checkpoints[j]);
+
+            Log("Run-ahead: failed to allocate %zu bytes, falling back to single instance", needed * RUNAHEAD_MAX_CHECKPOINTS);
+            config_emulator.runahead_second_instance = false;
+            checkpoint_capacity = 0;
+            checkpoint_count = 0;
+            return false;
+        }
+    }
+
+    checkpoint_capacity = needed;
+    checkpoint_count = 0;
+    return true;
+}
+
+static bool checkpoint_matches(int frames, size_t state_size)
+{
+    // A different run-ahead depth or a checkpoint that failed to save
+    if (checkpoint_count != (frames + 1))
+        return false;
+
+    if ((checkpoint_sizes[checkpoint_head] != state_size) || (state_size <= sizeof(GC_SaveState_Header)))
+        return false;
+
+    // The trailing header holds a timestamp and the file name, only the payload has to match
+    return memcmp(checkpoints[checkpoint_head], runahead_buffer, state_size - sizeof(GC_SaveState_Header)) == 0;
+}
+
+static void copy_untracked_memory(void)
+{
+    GearcolecoCore* core = emu_get_core();
+
+    // Savestates leave out the OCM EEPROM, SGM RAM is copied alongside it
+    memcpy(shadow->GetMemory()->GetSGMRam(), core->GetMemory()->GetSGMRam(), 0x8000);
+
+    Mapper* mapper = core->GetMemory()->GetMapper();
+    Mapper* shadow_mapper = shadow->GetMemory()->GetMapper();
+
+    if (IsValidPointer(mapper) && IsValidPointer(shadow_mapper) &&
+        IsValidPointer(mapper->GetSaveData()) && IsValidPointer(shadow_mapper->GetSaveData()) &&
+        (mapper->GetSaveDataSize() == shadow_mapper->GetSaveDataSize()))
+        memcpy(shadow_mapper->GetSaveData(), mapper->GetSaveData(), mapper->GetSaveDataSize());
+}
+
+static void shadow_job(void)
+{
+    if (job_resync && !shadow->LoadState(runahead_buffer, job_state_size))
+    {
+        job_ok = false;
+        return;
+    }
+
+    for (int i = 0; i < job_frames; i++)
+    {
+        int discarded_samples = 0;
+        bool render = (i == (job_frames - 1));
+        shadow->GetVideo()->SetSkipRender(!render);
+        shadow->RunToVBlank(job_frame_buffer, shadow_audio, &discarded_samples, NULL, render);
+
+        // A checkpoint that does not fit leaves a gap, which resyncs next frame
+        int slot = (checkpoint_head + checkpoint_count) % RUNAHEAD_MAX_CHECKPOINTS;
+        checkpoint_sizes[slot] = checkpoint_capacity;
+        if (shadow->SaveState(checkpoints[slot], checkpoint_sizes[slot], false))
+            checkpoint_count++;
+    }
+}
+
+static void shadow_thread_func(void)
+{
+    std::unique_lock<std::mutex> lock(shadow_mutex);
+
+    while (true)
+    {
+        shadow_cv.wait(lock, [] { return shadow_pending || shadow_quit; });
+
+        if (shadow_quit)
+            return;
+
+        lock.unlock();
+        shadow_job();
+        lock.lock();
+
+        shadow_pending = false;
+        shadow_cv.notify_all();
+    }
+}
+
+static void start_shadow_job(void)
+{
+    if (!shadow_threaded)
+        return;
+
+    if (!shadow_thread.joinable())
+        shadow_thread = std::thread(shadow_thread_func);
+
+    std::lock_guard<std::mutex> lock(shadow_mutex);
+    shadow_pending = true;
+    shadow_cv.notify_all();
+}
+
+static void finish_shadow_job(void)
+{
+    if (!shadow_threaded)
+    {
+        shadow_job();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(shadow_mutex);
+    shadow_cv.wait(lock, [] { return !shadow_pending; });
+}
+
+static void destroy_shadow(void)
+{
+    if (shadow_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(shadow_mutex);
+            shadow_quit = true;
+            shadow_cv.notify_all();
+        }
+        shadow_thread.join();
+        shadow_quit = false;
+    }
+
+    for (int i = 0; i < RUNAHEAD_MAX_CHECKPOINTS; i++)
+        SafeDeleteArray(checkpoints[i]);
+
+    checkpoint_capacity = 0;
+    checkpoint_head = 0;
+    checkpoint_count = 0;
+    SafeDelete(shadow);
+    SafeDeleteArray(shadow_audio);
+}
@@ -21,7 +21,7 @@
 
 AY8910::AY8910()
 {
-    InitPointer(m_pBuffer);
+    InitPointer(m_pOutput);
     m_DebugEnabled = false;
     for (int i = 0; i < 3; i++)
     {
@@ -33,14 +33,15 @@ AY8910::AY8910()
 
 AY8910::~AY8910()
 {
-    SafeDeleteArray(m_pBuffer);
     for (int i = 0; i < 3; i++)
         SafeDeleteArray(m_pDebugChannelBuffer[i]);
 }
 
 void AY8910::Init(int clockRate)
 {
-    m_pBuffer = new s16[GC_AUDIO_BUFFER_SIZE];
+    // One output unit per volume table unit, the level the SGM was mixed at
+    m_Synth.volume((3.0 * 4096.0) / 65536.0);
+
     for (int i = 0; i < 3; i++)
         m_pDebugChannelBuffer[i] = new s16[GC_AUDIO_BUFFER_SIZE];
     Reset(clockRate);
@@ -84,16 +85,24 @@ void AY8910::Reset(int clockRate)
 
     for (int i = 0; i < GC_AUDIO_BUFFER_SIZE; i++)
     {
-        m_pBuffer[i] = 0;
         for (int c = 0; c < 3; c++)
             m_pDebugChannelBuffer[c][i] = 0;
     }
 
     for (int i = 0; i < 3; i++)
+    {
         m_DebugChannelSamples[i] = 0;
+        m_ChannelOutput[i] = 0;
+    }
 
     m_ElapsedCycles = 0;
-    m_CurrentSample = 0;
+    m_iTime = 0;
+    m_iOutput = 0;
+}
+
+void AY8910::SetOutput(Blip_Buffer* pBuffer)
+{
+    m_pOutput = pBuffer;
 }
 
 void AY8910::WriteRegister(u8 value)
@@ -240,152 +249,239 @@ void AY8910::EnvelopeReset()
     }
 }
 
-void AY8910::Tick(unsigned int clockCycles)
-{
-    m_ElapsedCycles += clockCycles;
-}
-
-void AY8910::Sync()
+void AY8910::EnvelopeStep()
 {
-    for (int i = 0; i < m_ElapsedCycles; i++)
+    if (m_EnvelopeStep)
     {
-        m_iCycleCounter ++;
-        if (m_iCycleCounter >= 16)
+        if (m_EnvelopeSegment)
         {
-            m_iCycleCounter -= 16;
-
-            for (int i = 0; i < 3; i++)
+            if ((m_Registers[13] == 10) || (m_Registers[13] == 12))
             {
-                m_ToneCounter[i]++;
-                if (m_ToneCounter[i] >= m_TonePeriod[i])
-                {
-                    m_ToneCounter[i] = 0;
-                    m_Sign[i] = !m_Sign[i];
-                }
+                m_EnvelopeVolume++;
             }
-
-            m_NoiseCounter++;
-            if (m_NoiseCounter >= (m_NoisePeriod << 1))
+            else if ((m_Registers[13] == 8) || (m_Registers[13] == 14))
             {
-                m_NoiseCounter = 0;
-                m_NoiseShift = (m_NoiseShift >> 1) | (((m_NoiseShift ^ (m_NoiseShift >> 3)) & 0x01) << 16);
+                m_EnvelopeVolume--;
             }
-
-            m_EnvelopeCounter++;
-            if (m_EnvelopeCounter >= (m_EnvelopePeriod << 1))
+        }
+        else
+        {
+            if (IsSetBit(m_Registers[13], 2))
+            {
+                m_EnvelopeVolume++;
+            }
+            else
             {
-                m_EnvelopeCounter = 0;
-
-                if (m_EnvelopeStep)
-                {
-                    if (m_EnvelopeSegment)
-                    {
-                        if ((m_Registers[13] == 10) || (m_Registers[13] == 12))
-                        {
-                            m_EnvelopeVolume++;
-                        }
-                        else if ((m_Registers[13] == 8) || (m_Registers[13] == 14))
-                        {
-                            m_EnvelopeVolume--;
-                        }
-                    }
-                    else
-                    {
-                        if (IsSetBit(m_Registers[13], 2))
-                        {
-                            m_EnvelopeVolume++;
-                        }
-                        else
-                        {
-                            m_EnvelopeVolume--;
-                        }
-                    }
-                }
-
-                m_EnvelopeStep++;
-                if (m_EnvelopeStep >= 16)
-                {
-                    if ((m_Registers[13] & 0x09) == 0x08)
-                    {
-                        m_EnvelopeSegment = !m_EnvelopeSegment;
-                    }
-                    else
-                    {
-                        m_EnvelopeSegment = true;
-                    }
-                    EnvelopeReset();
-                }
+                m_EnvelopeVolume--;
             }
         }
+    }
 
-        m_iSampleCounter += m_iSampleRateFactor;
-        if (m_iSampleCounter >= (1 << kAY8910SampleAccuracy))
+    m_EnvelopeStep++;
+    if (m_EnvelopeStep >= 16)
+    {
+        if ((m_Registers[13] & 0x09) == 0x08)
+        {
+            m_EnvelopeSegment = !m_EnvelopeSegment;
+        }
+        else
         {
-            m_iSampleCounter -= (1 << kAY8910SampleAccuracy);
-            m_CurrentSample = 0;
-            s16 channel_sample[3] = { 0, 0, 0 };
+            m_EnvelopeSegment = true;
+        }
+        EnvelopeReset();
+    }
+}
 
-            for (int i = 0; i < 3; i++)
-            {
-                // Filter out ultrasonic frequencies
-                bool toneOutput = m_ToneDisable[i] || ((m_TonePeriod[i] >= 8) && m_Sign[i]);
-                bool noiseOutput = m_NoiseDisable[i] || ((m_NoiseShift & 0x01) == 0x01);
-
-                if (toneOutput && noiseOutput)
-                {
-                    channel_sample[i] = m_EnvelopeMode[i] ? kAY8910VolumeTable[m_EnvelopeVolume] : kAY8910VolumeTable[m_Amplitude[i]];
-                    if (!m_ChannelMute[i])
-                        m_CurrentSample += channel_sample[i];
-                }
-            }
+void AY8910::Tick(unsigned int clockCycles)
+{
+    m_ElapsedCycles += clockCycles;
+}
 
-            if (m_iBufferIndex < 0 || (m_iBufferIndex + 1) >= GC_AUDIO_BUFFER_SIZE)
-            {
-                Debug("SGM Audio buffer overflow");
-                m_iBufferIndex = 0;
-            }
+void AY8910::Sync()
+{
+    int cycles = m_ElapsedCycles;
+    m_ElapsedCycles = 0;
 
-            m_pBuffer[m_iBufferIndex] = m_CurrentSample;
-            m_pBuffer[m_iBufferIndex + 1] = m_CurrentSample;
+    // Register writes and mute changes since the last sync land here
+    UpdateOutput();
 
-            if (m_DebugEnabled)
-            {
-                for (int i = 0; i < 3; i++)
-                {
-                    m_pDebugChannelBuffer[i][m_iBufferIndex] = channel_sample[i];
-                    m_pDebugChannelBuffer[i][m_iBufferIndex + 1] = channel_sample[i];
-                }
-            }
+    // Counters advance every 16 master cycles, jump straight to the next
+    // tick where an audible output can change
+    int cycles_to_tick = 16 - m_iCycleCounter;
+
+    while (cycles >= cycles_to_tick)
+    {
+        int ticks = MIN(1 + ((cycles - cycles_to_tick) >> 4), TicksToNextEdge());
+        int span = cycles_to_tick + ((ticks - 1) << 4);
+
+        FillDebugBuffer(span);
+        m_iTime += span;
+        cycles -= span;
+
+        for (int i = 0; i < 3; i++)
+            AdvanceTone(i, ticks);
+        AdvanceNoise(ticks);
+        AdvanceEnvelope(ticks);
+
+        UpdateOutput();
+        cycles_to_tick = 16;
+    }
+
+    FillDebugBuffer(cycles);
+    m_iTime += cycles;
+    m_iCycleCounter = 16 - cycles_to_tick + cycles;
+}
+
+int AY8910::TicksToNextEdge()
+{
+    int next = 0x7FFFFFFF;
+    bool noise = false;
+    bool envelope = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        // Filter out ultrasonic frequencies
+        if (!m_ToneDisable[i] && (m_TonePeriod[i] >= 8))
+            next = MIN(next, MAX(1, m_TonePeriod[i] - m_ToneCounter[i]));
+
+        noise = noise || !m_NoiseDisable[i];
+        envelope = envelope || m_EnvelopeMode[i];
+    }
+
+    if (noise)
+        next = MIN(next, MAX(1, (m_NoisePeriod << 1) - m_NoiseCounter));
+
+    if (envelope)
+        next = MIN(next, MAX(1, (int)(m_EnvelopePeriod << 1) - (int)m_EnvelopeCounter));
+
+    return next;
+}
+
+void AY8910::AdvanceTone(int channel, int ticks)
+{
+    int period = m_TonePeriod[channel];
+    int next = MAX(1, period - m_ToneCounter[channel]);
 
-            m_iBufferIndex += 2;
+    if (ticks < next)
+    {
+        m_ToneCounter[channel] += ticks;
+        return;
+    }
+
+    int remaining = ticks - next;
+    int flips = 1 + (remaining / period);
+    m_ToneCounter[channel] = remaining % period;
+
+    if (flips & 1)
+        m_Sign[channel] = !m_Sign[channel];
+}
+
+void AY8910::AdvanceNoise(int ticks)
+{
+    int period = m_NoisePeriod << 1;
+    int next = MAX(1, period - m_NoiseCounter);
+
+    if (ticks < next)
+    {
+        m_NoiseCounter += ticks;
+        return;
+    }
+
+    int remaining = ticks - next;
+    int steps = 1 + (remaining / period);
+    m_NoiseCounter = remaining % period;
+
+    for (int i = 0; i < steps; i++)
+        m_NoiseShift = (m_NoiseShift >> 1) | (((m_NoiseShift ^ (m_NoiseShift >> 3)) & 0x01) << 16);
+}
+
+void AY8910::AdvanceEnvelope(int ticks)
+{
+    int period = MAX(1, m_EnvelopePeriod << 1);
+    int next = MAX(1, period - (int)m_EnvelopeCounter);
+
+    if (ticks < next)
+    {
+        m_EnvelopeCounter += ticks;
+        return;
+    }
+
+    int remaining = ticks - next;
+    int steps = 1 + (remaining / period);
+    m_EnvelopeCounter = remaining % period;
+
+    for (int i = 0; i < steps; i++)
+        EnvelopeStep();
+}
+
+void AY8910::UpdateOutput()
+{
+    int output = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        // Filter out ultrasonic frequencies
+        bool toneOutput = m_ToneDisable[i] || ((m_TonePeriod[i] >= 8) && m_Sign[i]);
+        bool noiseOutput = m_NoiseDisable[i] || ((m_NoiseShift & 0x01) == 0x01);
+
+        m_ChannelOutput[i] = 0;
+
+        if (toneOutput && noiseOutput)
+        {
+            m_ChannelOutput[i] = m_EnvelopeMode[i] ? kAY8910VolumeTable[m_EnvelopeVolume] : kAY8910VolumeTable[m_Amplitude[i]];
+            if (!m_ChannelMute[i])
+                output += m_ChannelOutput[i];
         }
     }
 
-    m_ElapsedCycles = 0;
+    int delta = output - m_iOutput;
+
+    if (delta != 0)
+    {
+        m_iOutput = output;
+        if (IsValidPointer(m_pOutput))
+            m_Synth.offset(m_iTime, delta, m_pOutput);
+    }
 }
 
-int AY8910::EndFrame(s16* pSampleBuffer)
+void AY8910::FillDebugBuffer(int cycles)
 {
-    Sync();
+    m_iSampleCounter += cycles * m_iSampleRateFactor;
+    int samples = m_iSampleCounter >> kAY8910SampleAccuracy;
+    m_iSampleCounter &= (1 << kAY8910SampleAccuracy) - 1;
 
-    int ret = 0;
+    if (!m_DebugEnabled)
+        return;
 
-    if (IsValidPointer(pSampleBuffer))
+    for (int s = 0; s < samples; s++)
     {
-        ret = m_iBufferIndex;
+        if (m_iBufferIndex < 0 || (m_iBufferIndex + 1) >= GC_AUDIO_BUFFER_SIZE)
+        {
+            Debug("SGM Audio buffer overflow");
+            m_iBufferIndex = 0;
+        }
 
-        for (int i = 0; i < m_iBufferIndex; i++)
+        for (int i = 0; i < 3; i++)
         {
-            pSampleBuffer[i] = m_pBuffer[i];
+            m_pDebugChannelBuffer[i][m_iBufferIndex] = m_ChannelOutput[i];
+            m_pDebugChannelBuffer[i][m_iBufferIndex + 1] = m_ChannelOutput[i];
         }
+
+        m_iBufferIndex += 2;
     }
+}
+
+void AY8910::EndFrame()
+{
+    Sync();
+
+    // The output buffer starts a new frame at time 0
+    m_iTime = 0;
 
     for (int i = 0; i < 3; i++)
         m_DebugChannelSamples[i] = m_DebugEnabled ? m_iBufferIndex : 0;
 
     m_iBufferIndex = 0;
-
-    return ret;
 }
 
 void AY8910::EnableDebug(bool enable)
@@ -419,58 +515,94 @@ bool* AY8910::GetChannelMute(int channel)
     return &m_ChannelMute[channel];
 }
 
-void AY8910::SaveState(std::ostream& stream)
+void AY8910::SaveState(StateWriter& stream)
+{
+    stream.Write(m_Registers);
+    stream.Write(m_SelectedRegister);
+    stream.Write(m_TonePeriod);
+    stream.Write(m_ToneCounter);
+    stream.Write(m_Amplitude);
+    stream.Write(m_NoisePeriod);
+    stream.Write(m_NoiseCounter);
+    stream.Write(m_NoiseShift);
+    stream.Write(m_EnvelopePeriod);
+    stream.Write(m_EnvelopeCounter);
+    stream.Write(m_EnvelopeSegment);
+    stream.Write(m_EnvelopeStep);
+    stream.Write(m_EnvelopeVolume);
+    stream.Write(m_ToneDisable);
+    stream.Write(m_NoiseDisable);
+    stream.Write(m_EnvelopeMode);
+    stream.Write(m_Sign);
+    stream.Write(m_iCycleCounter);
+    stream.Write(m_iSampleCounter);
+    stream.Write(m_ElapsedCycles);
+    stream.Write(m_iClockRate);
+    stream.Write(m_iTime);
+    stream.Write(m_iOutput);
+}
+
+size_t AY8910::GetStateSize()
 {
-    stream.write(reinterpret_cast<const char*>(m_Registers), sizeof(m_Registers));
-    stream.write(reinterpret_cast<const char*>(&m_SelectedRegister), sizeof(m_SelectedRegister));
-    stream.write(reinterpret_cast<const char*>(m_TonePeriod), sizeof(m_TonePeriod));
-    stream.write(reinterpret_cast<const char*>(m_ToneCounter), sizeof(m_ToneCounter));
-    stream.write(reinterpret_cast<const char*>(m_Amplitude), sizeof(m_Amplitude));
-    stream.write(reinterpret_cast<const char*>(&m_NoisePeriod), sizeof(m_NoisePeriod));
-    stream.write(reinterpret_cast<const char*>(&m_NoiseCounter), sizeof(m_NoiseCounter));
-    stream.write(reinterpret_cast<const char*>(&m_NoiseShift), sizeof(m_NoiseShift));
-    stream.write(reinterpret_cast<const char*>(&m_EnvelopePeriod), sizeof(m_EnvelopePeriod));
-    stream.write(reinterpret_cast<const char*>(&m_EnvelopeCounter), sizeof(m_EnvelopeCounter));
-    stream.write(reinterpret_cast<const char*>(&m_EnvelopeSegment), sizeof(m_EnvelopeSegment));
-    stream.write(reinterpret_cast<const char*>(&m_EnvelopeStep), sizeof(m_EnvelopeStep));
-    stream.write(reinterpret_cast<const char*>(&m_EnvelopeVolume), sizeof(m_EnvelopeVolume));
-    stream.write(reinterpret_cast<const char*>(m_ToneDisable), sizeof(m_ToneDisable));
-    stream.write(reinterpret_cast<const char*>(m_NoiseDisable), sizeof(m_NoiseDisable));
-    stream.write(reinterpret_cast<const char*>(m_EnvelopeMode), sizeof(m_EnvelopeMode));
-    stream.write(reinterpret_cast<const char*>(m_Sign), sizeof(m_Sign));
-    stream.write(reinterpret_cast<const char*>(&m_iCycleCounter), sizeof(m_iCycleCounter));
-    stream.write(reinterpret_cast<const char*>(&m_iSampleCounter), sizeof(m_iSampleCounter));
-    stream.write(reinterpret_cast<const char*>(m_pBuffer), GC_AUDIO_BUFFER_SIZE * sizeof(s16));
-    stream.write(reinterpret_cast<const char*>(&m_iBufferIndex), sizeof(m_iBufferIndex));
-    stream.write(reinterpret_cast<const char*>(&m_ElapsedCycles), sizeof(m_ElapsedCycles));
-    stream.write(reinterpret_cast<const char*>(&m_iClockRate), sizeof(m_iClockRate));
-    stream.write(reinterpret_cast<const char*>(&m_CurrentSample), sizeof(m_CurrentSample));
+    size_t size = sizeof(m_Registers) + sizeof(m_SelectedRegister) + sizeof(m_TonePeriod) + sizeof(m_ToneCounter);
+    size += sizeof(m_Amplitude) + sizeof(m_NoisePeriod) + sizeof(m_NoiseCounter) + sizeof(m_NoiseShift);
+    size += sizeof(m_EnvelopePeriod) + sizeof(m_EnvelopeCounter) + sizeof(m_EnvelopeSegment) + sizeof(m_EnvelopeStep);
+    size += sizeof(m_EnvelopeVolume) + sizeof(m_ToneDisable) + sizeof(m_NoiseDisable) + sizeof(m_EnvelopeMode);
+    size += sizeof(m_Sign) + sizeof(m_iCycleCounter) + sizeof(m_iSampleCounter) + sizeof(m_ElapsedCycles);
+    size += sizeof(m_iClockRate) + sizeof(m_iTime) + sizeof(m_iOutput);
+    return size;
 }
 
-void AY8910::LoadState(std::istream& stream)
+void AY8910::LoadState(StateReader& stream, int version)
 {
-    stream.read(reinterpret_cast<char*>(m_Registers), sizeof(m_Registers));
-    stream.read(reinterpret_cast<char*>(&m_SelectedRegister), sizeof(m_SelectedRegister));
-    stream.read(reinterpret_cast<char*>(m_TonePeriod), sizeof(m_TonePeriod));
-    stream.read(reinterpret_cast<char*>(m_ToneCounter), sizeof(m_ToneCounter));
-    stream.read(reinterpret_cast<char*>(m_Amplitude), sizeof(m_Amplitude));
-    stream.read(reinterpret_cast<char*>(&m_NoisePeriod), sizeof(m_NoisePeriod));
-    stream.read(reinterpret_cast<char*>(&m_NoiseCounter), sizeof(m_NoiseCounter));
-    stream.read(reinterpret_cast<char*>(&m_NoiseShift), sizeof(m_NoiseShift));
-    stream.read(reinterpret_cast<char*>(&m_EnvelopePeriod), sizeof(m_EnvelopePeriod));
-    stream.read(reinterpret_cast<char*>(&m_EnvelopeCounter), sizeof(m_EnvelopeCounter));
-    stream.read(reinterpret_cast<char*>(&m_EnvelopeSegment), sizeof(m_EnvelopeSegment));
-    stream.read(reinterpret_cast<char*>(&m_EnvelopeStep), sizeof(m_EnvelopeStep));
-    stream.read(reinterpret_cast<char*>(&m_EnvelopeVolume), sizeof(m_EnvelopeVolume));
-    stream.read(reinterpret_cast<char*>(m_ToneDisable), sizeof(m_ToneDisable));
-    stream.read(reinterpret_cast<char*>(m_NoiseDisable), sizeof(m_NoiseDisable));
-    stream.read(reinterpret_cast<char*>(m_EnvelopeMode), sizeof(m_EnvelopeMode));
-    stream.read(reinterpret_cast<char*>(m_Sign), sizeof(m_Sign));
-    stream.read(reinterpret_cast<char*>(&m_iCycleCounter), sizeof(m_iCycleCounter));
-    stream.read(reinterpret_cast<char*>(&m_iSampleCounter), sizeof(m_iSampleCounter));
-    stream.read(reinterpret_cast<char*>(m_pBuffer), GC_AUDIO_BUFFER_SIZE * sizeof(s16));
-    stream.read(reinterpret_cast<char*>(&m_iBufferIndex), sizeof(m_iBufferIndex));
-    stream.read(reinterpret_cast<char*>(&m_ElapsedCycles), sizeof(m_ElapsedCycles));
-    stream.read(reinterpret_cast<char*>(&m_iClockRate), sizeof(m_iClockRate));
-    stream.read(reinterpret_cast<char*>(&m_CurrentSample), sizeof(m_CurrentSample));
+    stream.Read(m_Registers);
+    stream.Read(m_SelectedRegister);
+    stream.Read(m_TonePeriod);
+    stream.Read(m_ToneCounter);
+    stream.Read(m_Amplitude);
+    stream.Read(m_NoisePeriod);
+    stream.Read(m_NoiseCounter);
+    stream.Read(m_NoiseShift);
+    stream.Read(m_EnvelopePeriod);
+
+    if (version >= 106)
+    {
+        stream.Read(m_EnvelopeCounter);
+    }
+    else
+    {
+        u16 envelope_counter = 0;
+        stream.Read(envelope_counter);
+        m_EnvelopeCounter = envelope_counter;
+    }
+
+    stream.Read(m_EnvelopeSegment);
+    stream.Read(m_EnvelopeStep);
+    stream.Read(m_EnvelopeVolume);
+    stream.Read(m_ToneDisable);
+    stream.Read(m_NoiseDisable);
+    stream.Read(m_EnvelopeMode);
+    stream.Read(m_Sign);
+    stream.Read(m_iCycleCounter);
+    stream.Read(m_iSampleCounter);
+
+    if (version >= 106)
+    {
+        stream.Read(m_ElapsedCycles);
+        stream.Read(m_iClockRate);
+        stream.Read(m_iTime);
+        stream.Read(m_iOutput);
+    }
+    else
+    {
+        // Older states carry the point sampled output buffer
+        stream.Skip(GC_AUDIO_BUFFER_SIZE * sizeof(s16) + sizeof(int));
+        stream.Read(m_ElapsedCycles);
+        stream.Read(m_iClockRate);
+        stream.Skip(sizeof(s16));
+        m_iTime = 0;
+        m_iOutput = 0;
+    }
+
+    m_iBufferIndex = 0;
 }
@@ -22,6 +22,8 @@
 
 #include "definitions.h"
 #include "log.h"
+#include "audio/Blip_Buffer.h"
+#include "state_serializer.h"
 
 class AY8910
 {
@@ -33,10 +35,12 @@ public:
     void WriteRegister(u8 value);
     u8 ReadRegister();
     void SelectRegister(u8 reg);
+    void SetOutput(Blip_Buffer* pBuffer);
     void Tick(unsigned int clockCycles);
-    int EndFrame(s16* pSampleBuffer);
-    void SaveState(std::ostream& stream);
-    void LoadState(std::istream& stream);
+    void EndFrame();
+    void SaveState(StateWriter& stream);
+    size_t GetStateSize();
+    void LoadState(StateReader& stream, int version);
     const u8* GetRegisters() const { return m_Registers; }
     u8 GetSelectedRegister() const { return m_SelectedRegister; }
     const u16* GetTonePeriods() const { return m_TonePeriod; }
@@ -56,9 +60,19 @@ public:
     int GetDebugChannelSamples(int channel) const;
     bool* GetChannelMute(int channel);
 
+private:
+    typedef Blip_Synth<blip_good_quality, 4096 * 3> Synth;
+
 private:
     void EnvelopeReset();
+    void EnvelopeStep();
     void Sync();
+    int TicksToNextEdge();
+    void AdvanceTone(int channel, int ticks);
+    void AdvanceNoise(int ticks);
+    void AdvanceEnvelope(int ticks);
+    void UpdateOutput();
+    void FillDebugBuffer(int cycles);
 
 private:
     u8 m_Registers[16];
@@ -70,7 +84,7 @@ private:
     u16 m_NoiseCounter;
     u32 m_NoiseShift;
     u16 m_EnvelopePeriod;
-    u16 m_EnvelopeCounter;
+    u32 m_EnvelopeCounter;
     bool m_EnvelopeSegment;
     u8 m_EnvelopeStep;
     u8 m_EnvelopeVolume;
@@ -81,11 +95,14 @@ private:
     int m_iCycleCounter;
     int m_iSampleCounter;
     int m_iSampleRateFactor;
-    s16* m_pBuffer;
     int m_iBufferIndex;
     int m_ElapsedCycles;
     int m_iClockRate;
-    s16 m_CurrentSample;
+    blip_time_t m_iTime;
+    int m_iOutput;
+    s16 m_ChannelOutput[3];
+    Blip_Buffer* m_pOutput;
+    Synth m_Synth;
     s16* m_pDebugChannelBuffer[3];
     int m_DebugChannelSamples[3];
     bool m_ChannelMute[3];
@@ -26,14 +26,16 @@
 class ActivisionMapper : public Mapper
 {
 public:
-    ActivisionMapper(Cartridge* pCartridge);
+    ActivisionMapper(Cartridge* pCartridge, Memory* pMemory);
     virtual ~ActivisionMapper();
     
     virtual void Reset();
+    virtual void UpdatePages();
     virtual u8 Read(u16 address);
     virtual void Write(u16 address, u8 value);
-    virtual void SaveState(std::ostream& stream);
-    virtual void LoadState(std::istream& stream);
+    virtual void SaveState(StateWriter& stream);
+    virtual size_t GetStateSize();
+    virtual void LoadState(StateReader& stream);
     virtual u8 GetRomBank() { return m_RomBank; }
     virtual u32 GetRomBankAddress() { return m_RomBankAddress; }
 
@@ -42,7 +44,7 @@ private:
     u32 m_RomBankAddress;
 };
 
-inline ActivisionMapper::ActivisionMapper(Cartridge* pCartridge) : Mapper(pCartridge)
+inline ActivisionMapper::ActivisionMapper(Cartridge* pCartridge, Memory* pMemory) : Mapper(pCartridge, pMemory)
 {
     Reset();
 }
@@ -55,6 +57,22 @@ inline void ActivisionMapper::Reset()
 {
     m_RomBank = 0;
     m_RomBankAddress = 0;
+    UpdatePages();
+}
+
+inline void ActivisionMapper::UpdatePages()
+{
+    u8* pRom = m_pCartridge->GetROM();
+    u32 romSize = (u32)m_pCartridge->GetROMSize();
+
+    m_pMemory->MapPage(4, GetRomPage(pRom, romSize, 0x0000), NULL);
+    m_pMemory->MapPage(5, GetRomPage(pRom, romSize, 0x2000), NULL);
+    m_pMemory->MapPage(6, GetRomPage(pRom, romSize, m_RomBankAddress), NULL);
+#ifdef DEBUG_GEARCOLECO
+    m_pMemory->MapPage(7, NULL, NULL);
+#else
+    m_pMemory->MapPage(7, GetRomPage(pRom, romSize, m_RomBankAddress + 0x2000), NULL);
+#endif
 }
 
 inline u8 ActivisionMapper::Read(u16 address)
@@ -88,7 +106,10 @@ inline void ActivisionMapper::Write(u16 address, u8 value)
             m_RomBank = (address >> 4) & (m_pCartridge->GetROMBankCount() - 1);
             m_RomBankAddress = m_RomBank << 14;
             if (old_bank != m_RomBank)
+            {
+                UpdatePages();
                 TraceMapperEvent(TRACE_MAPPER_BANK, address, value, 0, old_bank);
+            }
         }
     }
     else
@@ -97,16 +118,22 @@ inline void ActivisionMapper::Write(u16 address, u8 value)
     }
 }
 
-inline void ActivisionMapper::SaveState(std::ostream& stream)
+inline void ActivisionMapper::SaveState(StateWriter& stream)
+{
+    stream.Write(m_RomBank);
+    stream.Write(m_RomBankAddress);
+}
+
+inline size_t ActivisionMapper::GetStateSize()
 {
-    stream.write(reinterpret_cast<const char*> (&m_RomBank), sizeof(m_RomBank));
-    stream.write(reinterpret_cast<const char*> (&m_RomBankAddress), sizeof(m_RomBankAddress));
+    return sizeof(m_RomBank) + sizeof(m_RomBankAddress);
 }
 
-inline void ActivisionMapper::LoadState(std::istream& stream)
+inline void ActivisionMapper::LoadState(StateReader& stream)
 {
-    stream.read(reinterpret_cast<char*> (&m_RomBank), sizeof(m_RomBank));
-    stream.read(reinterpret_cast<char*> (&m_RomBankAddress), sizeof(m_RomBankAddress));
+    stream.Read(m_RomBank);
+    stream.Read(m_RomBankAddress);
+    UpdatePages();
 }
 
 #endif /* ACTIVISIONMAPPER_H */
@@ -28,7 +28,6 @@ Audio::Audio()
     InitPointer(m_pSampleBuffer);
     m_bPAL = false;
     InitPointer(m_pAY8910);
-    InitPointer(m_pSGMBuffer);
     m_bMute = false;
     m_master_volume = 1.0f;
     m_bVgmRecordingEnabled = false;
@@ -38,6 +37,7 @@ Audio::Audio()
         InitPointer(m_pDebugChannelBuffer[i]);
         m_iDebugChannelSamples[i] = 0;
     }
+    InitPointer(m_pProfiler);
 }
 
 Audio::~Audio()
@@ -46,7 +46,6 @@ Audio::~Audio()
     SafeDelete(m_pBuffer);
     SafeDeleteArray(m_pSampleBuffer);
     SafeDelete(m_pAY8910);
-    SafeDeleteArray(m_pSGMBuffer);
     for (int i = 0; i < 4; i++)
         SafeDeleteArray(m_pDebugChannelBuffer[i]);
 }
@@ -67,10 +66,9 @@ void Audio::Init()
     m_pApu->output(m_pBuffer->center(), m_pBuffer->left(), m_pBuffer->right());
     m_pApu->volume(0.6);
 
-    m_pSGMBuffer = new s16[GC_AUDIO_BUFFER_SIZE];
-
     m_pAY8910 = new AY8910();
     m_pAY8910->Init(m_bPAL ? GC_MASTER_CLOCK_PAL : GC_MASTER_CLOCK_NTSC);
+    m_pAY8910->SetOutput(m_pBuffer->center());
 
     for (int i = 0; i < 4; i++)
         m_pDebugChannelBuffer[i] = new blip_sample_t[GC_AUDIO_BUFFER_SIZE];
@@ -104,7 +102,6 @@ void Audio::Reset(bool bPAL)
     }
 
     memset(m_pSampleBuffer, 0, GC_AUDIO_BUFFER_SIZE * sizeof(blip_sample_t));
-    memset(m_pSGMBuffer, 0, GC_AUDIO_BUFFER_SIZE * sizeof(s16));
 }
 
 void Audio::Mute(bool mute)
@@ -114,6 +111,13 @@ void Audio::Mute(bool mute)
 
 void Audio::EndFrame(s16* pSampleBuffer, int* pSampleCount)
 {
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+    GC_Profile_Section section = m_pProfiler->Enter(PROFILE_AY8910);
+    m_pAY8910->EndFrame();
+    m_pProfiler->Enter(PROFILE_PSG);
+#else
+    m_pAY8910->EndFrame();
+#endif
     m_pApu->end_frame((blip_time_t)m_ElapsedCycles);
     m_pBuffer->end_frame((blip_time_t)m_ElapsedCycles);
 
@@ -125,8 +129,6 @@ void Audio::EndFrame(s16* pSampleBuffer, int* pSampleCount)
             m_pApu->read_debug_samples(m_pDebugChannelBuffer[i], i, GC_AUDIO_BUFFER_SIZE, &m_iDebugChannelSamples[i]);
     }
 
-    m_pAY8910->EndFrame(m_pSGMBuffer);
-
     if (IsValidPointer(pSampleBuffer) && IsValidPointer(pSampleCount))
     {
         *pSampleCount = count;
@@ -139,7 +141,7 @@ void Audio::EndFrame(s16* pSampleBuffer, int* pSampleCount)
             }
             else
             {
-                s32 mix = m_pSampleBuffer[i] + m_pSGMBuffer[i];
+                s32 mix = m_pSampleBuffer[i];
                 mix = (s32)((float)mix * m_master_volume);
 
                 mix = CLAMP(mix, -32768, 32767);
@@ -150,24 +152,42 @@ void Audio::EndFrame(s16* pSampleBuffer, int* pSampleCount)
     }
 
     m_ElapsedCycles = 0;
+
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+    m_pProfiler->Leave(section);
+#endif
 }
 
-void Audio::SaveState(std::ostream& stream)
+void Audio::SetProfiler(Profiler* pProfiler)
 {
-    stream.write(reinterpret_cast<const char*> (&m_ElapsedCycles), sizeof(m_ElapsedCycles));
-    stream.write(reinterpret_cast<const char*> (m_pSampleBuffer), sizeof(blip_sample_t) * GC_AUDIO_BUFFER_SIZE);
-    stream.write(reinterpret_cast<const char*> (m_pSGMBuffer), sizeof(s16) * GC_AUDIO_BUFFER_SIZE);
+    m_pProfiler = pProfiler;
+}
+
+void Audio::SaveState(StateWriter& stream)
+{
+    stream.Write(m_ElapsedCycles);
     m_pAY8910->SaveState(stream);
     m_pApu->SaveState(stream);
     m_pBuffer->SaveState(stream);
 }
 
-void Audio::LoadState(std::istream& stream, int version)
+size_t Audio::GetStateSize()
 {
-    stream.read(reinterpret_cast<char*> (&m_ElapsedCycles), sizeof(m_ElapsedCycles));
-    stream.read(reinterpret_cast<char*> (m_pSampleBuffer), sizeof(blip_sample_t) * GC_AUDIO_BUFFER_SIZE);
-    stream.read(reinterpret_cast<char*> (m_pSGMBuffer), sizeof(s16) * GC_AUDIO_BUFFER_SIZE);
-    m_pAY8910->LoadState(stream);
+    return sizeof(m_ElapsedCycles) + m_pAY8910->GetStateSize() + m_pApu->GetStateSize() + m_pBuffer->GetStateSize();
+}
+
+void Audio::LoadState(StateReader& stream, int version)
+{
+    stream.Read(m_ElapsedCycles);
+
+    // Older states carry the last frame's output samples
+    if (version < 108)
+        stream.Skip(sizeof(blip_sample_t) * GC_AUDIO_BUFFER_SIZE);
+
+    if (version < 106)
+        stream.Skip(sizeof(s16) * GC_AUDIO_BUFFER_SIZE);
+
+    m_pAY8910->LoadState(stream, version);
 
     if (version >= 104)
     {
@@ -183,16 +203,13 @@ void Audio::LoadState(std::istream& stream, int version)
     m_pApu->volume(0.6);
 }
 
-void Audio::LoadStateV1(std::istream& stream)
+void Audio::LoadStateV1(StateReader& stream)
 {
-    using namespace std;
-
-    stream.read(reinterpret_cast<char*> (&m_ElapsedCycles), sizeof(m_ElapsedCycles));
-    stream.seekg(sizeof(blip_sample_t) * GC_AUDIO_BUFFER_SIZE_V1, ios::cur);
+    stream.Read(m_ElapsedCycles);
+    stream.Skip(sizeof(blip_sample_t) * GC_AUDIO_BUFFER_SIZE_V1);
     memset(m_pSampleBuffer, 0, sizeof(blip_sample_t) * GC_AUDIO_BUFFER_SIZE);
-    stream.seekg(sizeof(s16) * GC_AUDIO_BUFFER_SIZE_V1, ios::cur);
-    memset(m_pSGMBuffer, 0, sizeof(s16) * GC_AUDIO_BUFFER_SIZE);
-    m_pAY8910->LoadState(stream);
+    stream.Skip(sizeof(s16) * GC_AUDIO_BUFFER_SIZE_V1);
+    m_pAY8910->LoadState(stream, GC_SAVESTATE_VERSION_V1);
 
     m_pApu->reset();
     m_pApu->volume(0.6);
@@ -25,6 +25,8 @@
 #include "audio/Sms_Apu.h"
 #include "AY8910.h"
 #include "VgmRecorder.h"
+#include "state_serializer.h"
+#include "Profiler.h"
 
 class Audio
 {
@@ -41,9 +43,10 @@ public:
     void SGMRegister(u8 reg);
     void Tick(unsigned int clockCycles);
     void EndFrame(s16* pSampleBuffer, int* pSampleCount);
-    void SaveState(std::ostream& stream);
-    void LoadState(std::istream& stream, int version);
-    void LoadStateV1(std::istream& stream);
+    void SaveState(StateWriter& stream);
+    size_t GetStateSize();
+    void LoadState(StateReader& stream, int version);
+    void LoadStateV1(StateReader& stream);
     bool StartVgmRecording(const char* file_path, int clock_rate, bool is_pal, const VgmMetadata& metadata);
     void StopVgmRecording();
     bool IsVgmRecording() const;
@@ -57,6 +60,7 @@ public:
     int GetAY8910DebugChannelSamples(int channel);
     Sms_Apu* GetPSG() { return m_pApu; }
     AY8910* GetAY8910() { return m_pAY8910; }
+    void SetProfiler(Profiler* pProfiler);
 
 private:
     Sms_Apu* m_pApu;
@@ -66,7 +70,6 @@ private:
     int m_iSampleRate;
     blip_sample_t* m_pSampleBuffer;
     bool m_bPAL;
-    s16* m_pSGMBuffer;
     bool m_bMute;
     float m_master_volume;
     VgmRecorder m_VgmRecorder;
@@ -74,6 +77,7 @@ private:
     u8 m_AY8910Register;
     blip_sample_t* m_pDebugChannelBuffer[4];
     long m_iDebugChannelSamples[4];
+    Profiler* m_pProfiler;
 };
 
 inline void Audio::Tick(unsigned int clockCycles)
@@ -88,7 +92,13 @@ inline void Audio::Tick(unsigned int clockCycles)
 
 inline void Audio::WriteAudioRegister(u8 value)
 {
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+    GC_Profile_Section section = m_pProfiler->Enter(PROFILE_PSG);
     m_pApu->write_data((blip_time_t)m_ElapsedCycles, value);
+    m_pProfiler->Leave(section);
+#else
+    m_pApu->write_data((blip_time_t)m_ElapsedCycles, value);
+#endif
 #ifndef GEARCOLECO_DISABLE_VGMRECORDER
     if (m_bVgmRecordingEnabled)
         m_VgmRecorder.WritePSG(value);
@@ -97,7 +107,13 @@ inline void Audio::WriteAudioRegister(u8 value)
 
 inline void Audio::SGMWrite(u8 value)
 {
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+    GC_Profile_Section section = m_pProfiler->Enter(PROFILE_AY8910);
     m_pAY8910->WriteRegister(value);
+    m_pProfiler->Leave(section);
+#else
+    m_pAY8910->WriteRegister(value);
+#endif
 #ifndef GEARCOLECO_DISABLE_VGMRECORDER
     if (m_bVgmRecordingEnabled)
         m_VgmRecorder.WriteAY8910(m_AY8910Register, value);
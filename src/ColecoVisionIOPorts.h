@@ -28,6 +28,7 @@ class Input;
 class Cartridge;
 class Memory;
 class Processor;
+class Scheduler;
 class TraceLogger;
 
 class ColecoVisionIOPorts : public IOPorts
@@ -37,6 +38,7 @@ public:
     ~ColecoVisionIOPorts();
     void Reset();
     void SetTraceLogger(TraceLogger* pTraceLogger);
+    void SetScheduler(Scheduler* pScheduler);
     u8 In(u8 port);
     void Out(u8 port, u8 value);
 private:
@@ -60,6 +62,7 @@ private:
     Cartridge* m_pCartridge;
     Memory* m_pMemory;
     Processor* m_pProcessor;
+    Scheduler* m_pScheduler;
     TraceLogger* m_pTraceLogger;
 };
 
@@ -69,6 +72,7 @@ private:
 #include "Cartridge.h"
 #include "Memory.h"
 #include "Processor.h"
+#include "Scheduler.h"
 #include "TraceLogger.h"
 
 inline void ColecoVisionIOPorts::SetTraceLogger(TraceLogger* pTraceLogger)
@@ -76,6 +80,11 @@ inline void ColecoVisionIOPorts::SetTraceLogger(TraceLogger* pTraceLogger)
     m_pTraceLogger = pTraceLogger;
 }
 
+inline void ColecoVisionIOPorts::SetScheduler(Scheduler* pScheduler)
+{
+    m_pScheduler = pScheduler;
+}
+
 INLINE void ColecoVisionIOPorts::TraceIOEvent(u8 event, u8 port, u8 value)
 {
     if (IsValidPointer(m_pTraceLogger) && m_pTraceLogger->IsEventEnabled(TRACE_IO, event))
@@ -116,6 +125,8 @@ inline u8 ColecoVisionIOPorts::In(u8 port)
 {
     u8 ret = 0xFF;
 
+    m_pScheduler->CatchUp();
+
     switch(port & 0xE0) {
         case 0xA0:
         {
@@ -148,6 +159,8 @@ inline u8 ColecoVisionIOPorts::In(u8 port)
 
 inline void ColecoVisionIOPorts::Out(u8 port, u8 value)
 {
+    m_pScheduler->CatchUp();
+
     TraceIOEvent(TRACE_IO_WRITE, port, value);
 
     switch(port & 0xE0) {
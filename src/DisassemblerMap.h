@@ -0,0 +1,175 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef DISASSEMBLERMAP_H
+#define	DISASSEMBLERMAP_H
+
+#include "definitions.h"
+#include <vector>
+
+#define GC_DISASSEMBLER_PAGE_SHIFT 13
+#define GC_DISASSEMBLER_PAGE_SIZE (1 << GC_DISASSEMBLER_PAGE_SHIFT)
+#define GC_DISASSEMBLER_SLAB_SIZE 256
+
+// Records are carved from slabs and only released all at once
+class DisassemblerArena
+{
+public:
+    DisassemblerArena();
+    ~DisassemblerArena();
+    GC_Disassembler_Record* Allocate();
+    void Clear();
+
+private:
+    std::vector<GC_Disassembler_Record*> m_Slabs;
+    int m_iSlabUsed;
+};
+
+// Two-level map keyed by 8 KB bank, second level pages are allocated on first use
+class DisassemblerMap
+{
+public:
+    DisassemblerMap();
+    ~DisassemblerMap();
+    void Init(DisassemblerArena* pArena, u32 size);
+    void Clear();
+    u32 GetSize() const;
+    GC_Disassembler_Record* Get(u32 offset) const;
+    GC_Disassembler_Record* GetOrCreate(u32 offset, u8 bank);
+
+private:
+    DisassemblerArena* m_pArena;
+    GC_Disassembler_Record*** m_pPages;
+    u32 m_iSize;
+    u32 m_iPageCount;
+};
+
+inline DisassemblerArena::DisassemblerArena()
+{
+    m_iSlabUsed = GC_DISASSEMBLER_SLAB_SIZE;
+}
+
+inline DisassemblerArena::~DisassemblerArena()
+{
+    Clear();
+}
+
+inline GC_Disassembler_Record* DisassemblerArena::Allocate()
+{
+    if (m_iSlabUsed == GC_DISASSEMBLER_SLAB_SIZE)
+    {
+        m_Slabs.push_back(new GC_Disassembler_Record[GC_DISASSEMBLER_SLAB_SIZE]());
+        m_iSlabUsed = 0;
+    }
+
+    return &m_Slabs.back()[m_iSlabUsed++];
+}
+
+inline void DisassemblerArena::Clear()
+{
+    for (size_t i = 0; i < m_Slabs.size(); i++)
+        delete [] m_Slabs[i];
+
+    m_Slabs.clear();
+    m_iSlabUsed = GC_DISASSEMBLER_SLAB_SIZE;
+}
+
+inline DisassemblerMap::DisassemblerMap()
+{
+    InitPointer(m_pArena);
+    InitPointer(m_pPages);
+    m_iSize = 0;
+    m_iPageCount = 0;
+}
+
+inline DisassemblerMap::~DisassemblerMap()
+{
+    Clear();
+    SafeDeleteArray(m_pPages);
+}
+
+inline void DisassemblerMap::Init(DisassemblerArena* pArena, u32 size)
+{
+    Clear();
+    SafeDeleteArray(m_pPages);
+
+    m_pArena = pArena;
+    m_iSize = size;
+    m_iPageCount = (size + GC_DISASSEMBLER_PAGE_SIZE - 1) >> GC_DISASSEMBLER_PAGE_SHIFT;
+
+    if (m_iPageCount > 0)
+        m_pPages = new GC_Disassembler_Record**[m_iPageCount]();
+}
+
+inline void DisassemblerMap::Clear()
+{
+    if (!IsValidPointer(m_pPages))
+        return;
+
+    for (u32 i = 0; i < m_iPageCount; i++)
+        SafeDeleteArray(m_pPages[i]);
+}
+
+inline u32 DisassemblerMap::GetSize() const
+{
+    return m_iSize;
+}
+
+inline GC_Disassembler_Record* DisassemblerMap::Get(u32 offset) const
+{
+    if (offset >= m_iSize)
+        return NULL;
+
+    GC_Disassembler_Record** page = m_pPages[offset >> GC_DISASSEMBLER_PAGE_SHIFT];
+
+    if (!IsValidPointer(page))
+        return NULL;
+
+    return page[offset & (GC_DISASSEMBLER_PAGE_SIZE - 1)];
+}
+
+inline GC_Disassembler_Record* DisassemblerMap::GetOrCreate(u32 offset, u8 bank)
+{
+    if (offset >= m_iSize)
+        return NULL;
+
+    u32 page_index = offset >> GC_DISASSEMBLER_PAGE_SHIFT;
+    GC_Disassembler_Record** page = m_pPages[page_index];
+
+    if (!IsValidPointer(page))
+    {
+        u32 page_size = MIN((u32)GC_DISASSEMBLER_PAGE_SIZE, m_iSize - (page_index << GC_DISASSEMBLER_PAGE_SHIFT));
+        page = new GC_Disassembler_Record*[page_size]();
+        m_pPages[page_index] = page;
+    }
+
+    GC_Disassembler_Record* record = page[offset & (GC_DISASSEMBLER_PAGE_SIZE - 1)];
+
+    if (!IsValidPointer(record))
+    {
+        record = m_pArena->Allocate();
+        record->address = offset;
+        record->bank = bank;
+        page[offset & (GC_DISASSEMBLER_PAGE_SIZE - 1)] = record;
+    }
+
+    return record;
+}
+
+#endif	/* DISASSEMBLERMAP_H */
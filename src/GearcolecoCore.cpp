@@ -19,6 +19,7 @@
 
 #include <iomanip>
 #include <string>
+#include <vector>
 #include <string.h>
 #include "GearcolecoCore.h"
 #include "Memory.h"
@@ -28,12 +29,14 @@
 #include "Input.h"
 #include "Cartridge.h"
 #include "ColecoVisionIOPorts.h"
+#include "Scheduler.h"
+#include "Profiler.h"
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
 #include "TraceLogger.h"
 #endif
 #include "no_bios.h"
 #include "common.h"
-#include "memory_stream.h"
+#include "state_serializer.h"
 #include "random.h"
 
 GearcolecoCore::GearcolecoCore()
@@ -45,8 +48,10 @@ GearcolecoCore::GearcolecoCore()
     InitPointer(m_pInput);
     InitPointer(m_pCartridge);
     InitPointer(m_pColecoVisionIOPorts);
+    InitPointer(m_pScheduler);
     InitPointer(m_pRandom);
     InitPointer(m_pTraceLogger);
+    InitPointer(m_pProfiler);
     InitPointer(m_pFrameBuffer);
     m_bPaused = true;
     m_pixelFormat = GC_PIXEL_RGBA8888;
@@ -56,6 +61,8 @@ GearcolecoCore::GearcolecoCore()
 GearcolecoCore::~GearcolecoCore()
 {
     SafeDelete(m_pColecoVisionIOPorts);
+    SafeDelete(m_pScheduler);
+    SafeDelete(m_pProfiler);
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
     SafeDelete(m_pTraceLogger);
 #endif
@@ -83,6 +90,8 @@ void GearcolecoCore::Init(GC_Color_Format pixelFormat)
     m_pVideo = new Video(m_pMemory, m_pProcessor);
     m_pInput = new Input(m_pProcessor);
     m_pColecoVisionIOPorts = new ColecoVisionIOPorts(m_pAudio, m_pVideo, m_pInput, m_pCartridge, m_pMemory, m_pProcessor);
+    m_pProfiler = new Profiler();
+    m_pScheduler = new Scheduler(m_pProcessor, m_pVideo, m_pAudio, m_pMemory, m_pProfiler, &m_MasterClockCycles);
 
     m_pMemory->Init();
     m_pProcessor->Init();
@@ -92,6 +101,9 @@ void GearcolecoCore::Init(GC_Color_Format pixelFormat)
     m_pCartridge->Init();
 
     m_pProcessor->SetIOPOrts(m_pColecoVisionIOPorts);
+    m_pColecoVisionIOPorts->SetScheduler(m_pScheduler);
+    m_pAudio->SetProfiler(m_pProfiler);
+    m_pVideo->SetProfiler(m_pProfiler);
 
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
     m_pTraceLogger = new TraceLogger(&m_MasterClockCycles);
@@ -116,82 +128,83 @@ bool GearcolecoCore::RunToVBlank(u8* pFrameBuffer, s16* pSampleBuffer, int* pSam
 
     if (!m_bPaused && m_pCartridge->IsReady())
     {
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+        GC_Profile_Section section = m_pProfiler->Enter(PROFILE_CPU);
+#endif
+        m_pScheduler->BeginFrame();
+        m_pVideo->BeginHostFrame((render && !m_pVideo->IsSkipRender()) ? pFrameBuffer : NULL, m_pixelFormat);
+
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
         bool debug_enable = false;
-        bool instruction_completed = false;
         if (IsValidPointer(debug))
         {
             debug_enable = true;
             m_pProcessor->EnableBreakpoints(debug->stop_on_breakpoint, debug->stop_on_irq);
         }
+        else
+            m_pProcessor->EnableBreakpoints(false, false);
+
+        // Trace entries are stamped with the master clock, so keep it exact per instruction while tracing
+        bool tracing = (m_pTraceLogger->GetEnabledFlags() != 0);
 
+        // Skip the disassembler bookkeeping unless a debugger or a trace is attached
+        m_pProcessor->EnableFastCore(!debug_enable && !tracing);
         bool vblank = false;
-        int totalClocks = 0;
 
         do
         {
-            unsigned int clockCycles = debug_enable && debug->step_debugger ? m_pProcessor->RunInstruction() : m_pProcessor->RunFor(1);
-            instruction_completed = true;
-            m_MasterClockCycles += clockCycles;
-            vblank = m_pVideo->Tick(clockCycles);
-            m_pAudio->Tick(clockCycles);
-            m_pMemory->Tick(clockCycles);
-            totalClocks += clockCycles;
+            if (debug_enable && debug->step_debugger)
+                m_pProcessor->RunInstruction();
+            else
+                m_pProcessor->RunFor(tracing ? 1 : m_pScheduler->GetCyclesToNextEvent());
+
+            vblank = m_pScheduler->Sync();
 
             if (debug_enable)
             {
                 if (debug->step_debugger)
-                    vblank = instruction_completed;
-
-                if (m_pProcessor->MemoryBreakpointHit())
                     vblank = true;
 
-                if (instruction_completed)
-                {
-                    if (m_pProcessor->BreakpointHit())
-                        vblank = true;
+                if (m_pProcessor->BreakpointHit())
+                    vblank = true;
 
-                    if (debug->stop_on_run_to_breakpoint && m_pProcessor->RunToBreakpointHit())
-                        vblank = true;
-                }
+                if (debug->stop_on_run_to_breakpoint && m_pProcessor->RunToBreakpointHit())
+                    vblank = true;
             }
-
-            if (totalClocks > 702240)
-                vblank = true;
         }
         while (!vblank);
 
         m_pAudio->EndFrame(pSampleBuffer, pSampleCount);
-        if (render)
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+        m_pProfiler->Enter(PROFILE_PIXELS);
+#endif
+        if (!m_pVideo->EndHostFrame(pFrameBuffer) && render && !m_pVideo->IsSkipRender())
             RenderFrameBuffer(pFrameBuffer);
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+        m_pProfiler->Leave(section);
+#endif
 
         return m_pProcessor->BreakpointHit() || m_pProcessor->RunToBreakpointHit();
 #else
         UNUSED(debug);
         bool vblank = false;
-        int totalClocks = 0;
 
         do
         {
-#ifdef PERFORMANCE
-            unsigned int clockCycles = m_pProcessor->RunFor(75);
-#else
-            unsigned int clockCycles = m_pProcessor->RunFor(1);
-#endif
-            m_MasterClockCycles += clockCycles;
-            vblank = m_pVideo->Tick(clockCycles);
-            m_pAudio->Tick(clockCycles);
-            m_pMemory->Tick(clockCycles);
-            totalClocks += clockCycles;
-
-            if (totalClocks > 702240)
-                vblank = true;
+            m_pProcessor->RunFor(m_pScheduler->GetCyclesToNextEvent());
+            vblank = m_pScheduler->Sync();
         }
         while (!vblank);
 
         m_pAudio->EndFrame(pSampleBuffer, pSampleCount);
-        if (render)
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+        m_pProfiler->Enter(PROFILE_PIXELS);
+#endif
+        if (!m_pVideo->EndHostFrame(pFrameBuffer) && render && !m_pVideo->IsSkipRender())
             RenderFrameBuffer(pFrameBuffer);
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+        m_pProfiler->Leave(section);
+#endif
 
         return false;
 #endif
@@ -240,10 +253,10 @@ bool GearcolecoCore::LoadROMFromBuffer(const u8* buffer, int size, Cartridge::Fo
 
 void GearcolecoCore::SaveDisassembledROM()
 {
-    GC_Disassembler_Record** biosMap = m_pMemory->GetDisassemblerBiosMap();
-    GC_Disassembler_Record** romMap = m_pMemory->GetDisassemblerRomMap();
+    DisassemblerMap* biosMap = m_pMemory->GetDisassemblerBiosMap();
+    DisassemblerMap* romMap = m_pMemory->GetDisassemblerRomMap();
 
-    if (m_pCartridge->IsReady() && (strlen(m_pCartridge->GetFilePath()) > 0) && IsValidPointer(romMap))
+    if (m_pCartridge->IsReady() && (strlen(m_pCartridge->GetFilePath()) > 0))
     {
         using namespace std;
 
@@ -259,19 +272,23 @@ void GearcolecoCore::SaveDisassembledROM()
             #define PAD_ADDR(digits) std::uppercase << std::hex << std::setw(digits) << std::setfill('0')
             #define PAD_MEM(chars) std::setw(chars) << std::setfill(' ')
 
-            for (int i = 0; i < 0x2000; i++)
+            for (u32 i = 0; i < biosMap->GetSize(); i++)
             {
-                if (IsValidPointer(biosMap[i]) && (biosMap[i]->name[0] != 0))
+                GC_Disassembler_Record* record = biosMap->Get(i);
+
+                if (IsValidPointer(record) && (record->name[0] != 0))
                 {
-                    myfile << "BIOS $" << PAD_ADDR(4) << i << "   " << PAD_MEM(25) << biosMap[i]->bytes << "  " << biosMap[i]->name << "\n";
+                    myfile << "BIOS $" << PAD_ADDR(4) << i << "   " << PAD_MEM(25) << record->bytes << "  " << record->name << "\n";
                 }
             }
 
-            for (int i = 0; i < MAX_ROM_SIZE; i++)
+            for (u32 i = 0; i < romMap->GetSize(); i++)
             {
-                if (IsValidPointer(romMap[i]) && (romMap[i]->name[0] != 0))
+                GC_Disassembler_Record* record = romMap->Get(i);
+
+                if (IsValidPointer(record) && (record->name[0] != 0))
                 {
-                    myfile << "ROM  $" << PAD_ADDR(4) << i + 0x8000 << "   " << PAD_MEM(25) << romMap[i]->bytes << "  " << romMap[i]->name << "\n";
+                    myfile << "ROM  $" << PAD_ADDR(4) << i + 0x8000 << "   " << PAD_MEM(25) << record->bytes << "  " << record->name << "\n";
                 }
             }
 
@@ -338,6 +355,11 @@ TraceLogger* GearcolecoCore::GetTraceLogger()
     return m_pTraceLogger;
 }
 
+Profiler* GearcolecoCore::GetProfiler()
+{
+    return m_pProfiler;
+}
+
 u64 GearcolecoCore::GetMasterClockCycles()
 {
     return m_MasterClockCycles;
@@ -433,6 +455,13 @@ void GearcolecoCore::ResetSound()
     m_pAudio->Reset(m_pCartridge->IsPAL());
 }
 
+// RAM power-on contents come from this generator, a fixed seed before
+// loading a ROM makes runs reproducible
+void GearcolecoCore::SeedRandom(u32 seed)
+{
+    m_pRandom->Seed(seed);
+}
+
 void GearcolecoCore::SaveRam()
 {
     SaveRam(NULL);
@@ -642,8 +671,6 @@ bool GearcolecoCore::SaveState(const char* path, int index, bool screenshot)
 
 bool GearcolecoCore::SaveState(u8* buffer, size_t& size, bool screenshot)
 {
-    using namespace std;
-
     Debug("Saving state to buffer [%d bytes]...", size);
 
     if (!m_pCartridge->IsReady())
@@ -654,36 +681,77 @@ bool GearcolecoCore::SaveState(u8* buffer, size_t& size, bool screenshot)
 
     if (!IsValidPointer(buffer))
     {
-        stringstream stream;
-        if (!SaveState(stream, size, screenshot))
-        {
-            Error("Failed to save state to stream to calculate size");
-            return false;
-        }
+        size = GetSaveStateSize(screenshot);
         return true;
     }
-    else
+
+    StateWriter writer(buffer, size);
+
+    if (!SaveState(writer, screenshot))
     {
-        memory_stream direct_stream(reinterpret_cast<char*>(buffer), size);
+        Error("Failed to save state to buffer");
+        return false;
+    }
 
-        if (!SaveState(direct_stream, size, screenshot))
-        {
-            Error("Failed to save state to buffer");
-            return false;
-        }
+    if (!writer.Good())
+    {
+        Error("Failed to save state to buffer: output buffer is too small");
+        return false;
+    }
 
-        if (!direct_stream.good())
-        {
-            Error("Failed to save state to buffer: output buffer is too small");
-            return false;
-        }
+    size = writer.Size();
+    return true;
+}
 
-        size = direct_stream.size();
-        return true;
+size_t GearcolecoCore::GetSaveStateSize(bool screenshot)
+{
+    if (!m_pCartridge->IsReady())
+        return 0;
+
+    size_t size = m_pMemory->GetStateSize() + m_pProcessor->GetStateSize() + m_pAudio->GetStateSize() +
+        m_pVideo->GetStateSize() + m_pInput->GetStateSize();
+
+#if defined(__LIBRETRO__)
+    UNUSED(screenshot);
+    size += sizeof(GC_SaveState_Header_Libretro);
+#else
+    size += sizeof(GC_SaveState_Header);
+
+    if (screenshot && IsValidPointer(m_pFrameBuffer))
+    {
+        GC_RuntimeInfo runtime_info;
+        GetRuntimeInfo(runtime_info);
+        int bytes_per_pixel = (m_pixelFormat == GC_PIXEL_RGBA8888 || m_pixelFormat == GC_PIXEL_BGRA8888) ? 4 : 2;
+        size += runtime_info.screen_width * runtime_info.screen_height * bytes_per_pixel;
     }
+#endif
+
+    return size;
 }
 
+// Serialises into a flat buffer and hands it to the stream in a single write
 bool GearcolecoCore::SaveState(std::ostream& stream, size_t& size, bool screenshot)
+{
+    size = GetSaveStateSize(screenshot);
+
+    if (size == 0)
+    {
+        Log("Invalid rom.");
+        return false;
+    }
+
+    std::vector<u8> buffer(size);
+    StateWriter writer(buffer.data(), size);
+
+    if (!SaveState(writer, screenshot) || !writer.Good())
+        return false;
+
+    size = writer.Size();
+    stream.write(reinterpret_cast<const char*>(buffer.data()), size);
+    return true;
+}
+
+bool GearcolecoCore::SaveState(StateWriter& stream, bool screenshot)
 {
     if (m_pCartridge->IsReady())
     {
@@ -724,7 +792,7 @@ bool GearcolecoCore::SaveState(std::ostream& stream, size_t& size, bool screensh
 
             int bytes_per_pixel = (m_pixelFormat == GC_PIXEL_RGBA8888 || m_pixelFormat == GC_PIXEL_BGRA8888) ? 4 : 2;
             header.screenshot_size = header.screenshot_width * header.screenshot_height * bytes_per_pixel;
-            stream.write(reinterpret_cast<const char*>(m_pFrameBuffer), header.screenshot_size);
+            stream.WriteBytes(m_pFrameBuffer, header.screenshot_size);
         }
         else
         {
@@ -732,17 +800,12 @@ bool GearcolecoCore::SaveState(std::ostream& stream, size_t& size, bool screensh
             header.screenshot_width = 0;
             header.screenshot_height = 0;
         }
-#endif
 
-        size = static_cast<size_t>(stream.tellp());
-        size += sizeof(header);
-
-#if !defined(__LIBRETRO__)
-        header.size = static_cast<u32>(size);
+        header.size = static_cast<u32>(stream.Size() + sizeof(header));
         Debug("Save state header size: %d", header.size);
 #endif
 
-        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.Write(header);
 
         return true;
     }
@@ -800,22 +863,41 @@ bool GearcolecoCore::LoadState(const u8* buffer, size_t size)
         return false;
     }
 
-    memory_input_stream direct_stream(reinterpret_cast<const char*>(buffer), size);
-    return LoadState(direct_stream);
+    StateReader reader(buffer, size);
+    return LoadState(reader);
 }
 
+// Reads the whole stream into a flat buffer before parsing it
 bool GearcolecoCore::LoadState(std::istream& stream)
 {
-    if (m_pCartridge->IsReady())
+    using namespace std;
+
+    stream.seekg(0, ios::end);
+    size_t size = static_cast<size_t>(stream.tellg());
+    stream.seekg(0, ios::beg);
+
+    std::vector<u8> buffer(size);
+    stream.read(reinterpret_cast<char*>(buffer.data()), size);
+
+    if (stream.fail())
     {
-        using namespace std;
+        Error("Failed to read save state stream");
+        return false;
+    }
 
-        stream.seekg(0, ios::end);
-        size_t size = static_cast<size_t>(stream.tellg());
+    StateReader reader(buffer.data(), size);
+    return LoadState(reader);
+}
+
+bool GearcolecoCore::LoadState(StateReader& stream)
+{
+    if (m_pCartridge->IsReady())
+    {
+        size_t size = stream.Size();
 
         Debug("Load state stream size: %d", size);
 
-        GC_SaveState_Header_Libretro header;
+        GC_SaveState_Header_Libretro header = {};
 #if !defined(__LIBRETRO__)
         bool is_desktop_savestate = false;
 #endif
@@ -824,8 +906,8 @@ bool GearcolecoCore::LoadState(std::istream& stream)
         GC_SaveState_Header desktop_header;
         if (size >= sizeof(desktop_header))
         {
-            stream.seekg(size - sizeof(desktop_header), ios::beg);
-            stream.read(reinterpret_cast<char*>(&desktop_header), sizeof(desktop_header));
+            stream.Seek(size - sizeof(desktop_header));
+            stream.Read(desktop_header);
 
             if (desktop_header.magic == GC_SAVESTATE_MAGIC)
             {
@@ -841,11 +923,11 @@ bool GearcolecoCore::LoadState(std::istream& stream)
         // Fallback to libretro header
         if ((header.magic != GC_SAVESTATE_MAGIC) && (size >= sizeof(header)))
         {
-            stream.seekg(size - sizeof(header), ios::beg);
-            stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+            stream.Seek(size - sizeof(header));
+            stream.Read(header);
         }
 
-        stream.seekg(0, ios::beg);
+        stream.Seek(0);
 
         Debug("Load state header magic: 0x%08x", header.magic);
         Debug("Load state header version: %d", header.version);
@@ -882,9 +964,15 @@ bool GearcolecoCore::LoadState(std::istream& stream)
             else
                 m_pAudio->LoadState(stream, header.version);
 
-            m_pVideo->LoadState(stream);
+            m_pVideo->LoadState(stream, header.version);
             m_pInput->LoadState(stream, header.version);
 
+            if (!stream.Good())
+            {
+                Error("Save state is truncated");
+                return false;
+            }
+
             return true;
         }
 
@@ -894,11 +982,10 @@ bool GearcolecoCore::LoadState(std::istream& stream)
             u32 v1_magic = 0;
             u32 v1_size = 0;
 
-            stream.clear();
-            stream.seekg(size - (2 * sizeof(u32)), ios::beg);
-            stream.read(reinterpret_cast<char*>(&v1_magic), sizeof(v1_magic));
-            stream.read(reinterpret_cast<char*>(&v1_size), sizeof(v1_size));
-            stream.seekg(0, ios::beg);
+            stream.Seek(size - (2 * sizeof(u32)));
+            stream.Read(v1_magic);
+            stream.Read(v1_size);
+            stream.Seek(0);
 
             Debug("Load state V1 magic: 0x%08x", v1_magic);
             Debug("Load state V1 size: %d", v1_size);
@@ -910,9 +997,15 @@ bool GearcolecoCore::LoadState(std::istream& stream)
                 m_pMemory->LoadState(stream);
                 m_pProcessor->LoadState(stream, GC_SAVESTATE_VERSION_V1);
                 m_pAudio->LoadStateV1(stream);
-                m_pVideo->LoadState(stream);
+                m_pVideo->LoadState(stream, GC_SAVESTATE_VERSION_V1);
                 m_pInput->LoadState(stream, GC_SAVESTATE_VERSION_V1);
 
+                if (!stream.Good())
+                {
+                    Error("Save state is truncated");
+                    return false;
+                }
+
                 return true;
             }
         }
@@ -1060,7 +1153,7 @@ void GearcolecoCore::Reset()
 void GearcolecoCore::RenderFrameBuffer(u8* finalFrameBuffer)
 {
     int size = m_pMemory->IsBiosLoaded() ? GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN : GC_RESOLUTION_WIDTH * GC_RESOLUTION_HEIGHT;
-    u16* srcBuffer = (m_pMemory->IsBiosLoaded() ? m_pVideo->GetFrameBuffer() : kNoBiosImage);
+    const u16* srcBuffer = (m_pMemory->IsBiosLoaded() ? m_pVideo->GetFrameBuffer() : kNoBiosImage);
 
     switch (m_pixelFormat)
     {
@@ -1080,3 +1173,19 @@ void GearcolecoCore::RenderFrameBuffer(u8* finalFrameBuffer)
         }
     }
 }
+
+// Packed 256x192 palette indices or luma, divided by scale, without the RGBA conversion
+bool GearcolecoCore::RenderObservation(u8* buffer, GC_Observation_Format format, int scale)
+{
+    if (!IsValidPointer(buffer) || ((scale != 1) && (scale != 2) && (scale != 4)))
+        return false;
+
+    const u16* srcBuffer = (m_pMemory->IsBiosLoaded() ? m_pVideo->GetFrameBuffer() : kNoBiosImage);
+
+    if (format == GC_OBSERVATION_GREYSCALE)
+        m_pVideo->RenderGreyscale(srcBuffer, buffer, scale);
+    else
+        m_pVideo->RenderIndexed(srcBuffer, buffer, scale);
+
+    return true;
+}
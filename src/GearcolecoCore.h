@@ -29,8 +29,12 @@ class Audio;
 class Video;
 class Input;
 class ColecoVisionIOPorts;
+class Scheduler;
 class Random;
 class TraceLogger;
+class Profiler;
+class StateWriter;
+class StateReader;
 
 class GearcolecoCore
 {
@@ -62,12 +66,14 @@ public:
     void ResetROM(Cartridge::ForceConfiguration* config = NULL);
     void ResetROMPreservingRAM(Cartridge::ForceConfiguration* config = NULL);
     void ResetSound();
+    void SeedRandom(u32 seed);
     void SaveRam();
     void SaveRam(const char* szPath, bool fullPath = false);
     void LoadRam();
     void LoadRam(const char* szPath, bool fullPath = false);
     bool SaveState(const char* path = NULL, int index = -1, bool screenshot = false);
     bool SaveState(u8* buffer, size_t& size, bool screenshot = false);
+    size_t GetSaveStateSize(bool screenshot = false);
     bool LoadState(const char* path = NULL, int index = -1);
     bool LoadState(const u8* buffer, size_t size);
     bool GetSaveStateHeader(int index, const char* path, GC_SaveState_Header* header);
@@ -79,13 +85,17 @@ public:
     Video* GetVideo();
     Input* GetInput();
     TraceLogger* GetTraceLogger();
+    Profiler* GetProfiler();
     u64 GetMasterClockCycles();
     void RenderFrameBuffer(u8* finalFrameBuffer);
+    bool RenderObservation(u8* buffer, GC_Observation_Format format, int scale = 1);
 
 private:
     void Reset();
     bool SaveState(std::ostream& stream, size_t& size, bool screenshot);
+    bool SaveState(StateWriter& stream, bool screenshot);
     bool LoadState(std::istream& stream);
+    bool LoadState(StateReader& stream);
     std::string GetSaveStatePath(const char* path, int index);
 
 private:
@@ -96,8 +106,10 @@ private:
     Input* m_pInput;
     Cartridge* m_pCartridge;
     ColecoVisionIOPorts* m_pColecoVisionIOPorts;
+    Scheduler* m_pScheduler;
     Random* m_pRandom;
     TraceLogger* m_pTraceLogger;
+    Profiler* m_pProfiler;
     bool m_bPaused;
     GC_Color_Format m_pixelFormat;
     u8* m_pFrameBuffer;
@@ -222,29 +222,34 @@ void Input::Spinner2(int movement)
     m_iSpinnerRel[1] = movement;
 }
 
-void Input::SaveState(std::ostream& stream)
+void Input::SaveState(StateWriter& stream)
 {
-    stream.write(reinterpret_cast<const char*> (m_Gamepad), sizeof(m_Gamepad));
-    stream.write(reinterpret_cast<const char*> (m_Keypad), sizeof(m_Keypad));
-    stream.write(reinterpret_cast<const char*> (m_KeypadState), sizeof(m_KeypadState));
-    stream.write(reinterpret_cast<const char*> (&m_Segment), sizeof(m_Segment));
-    stream.write(reinterpret_cast<const char*> (m_iSpinnerRel), sizeof(m_iSpinnerRel));
+    stream.Write(m_Gamepad);
+    stream.Write(m_Keypad);
+    stream.Write(m_KeypadState);
+    stream.Write(m_Segment);
+    stream.Write(m_iSpinnerRel);
 }
 
-void Input::LoadState(std::istream& stream, u32 version)
+size_t Input::GetStateSize()
 {
-    stream.read(reinterpret_cast<char*> (m_Gamepad), sizeof(m_Gamepad));
-    stream.read(reinterpret_cast<char*> (m_Keypad), sizeof(m_Keypad));
+    return sizeof(m_Gamepad) + sizeof(m_Keypad) + sizeof(m_KeypadState) + sizeof(m_Segment) + sizeof(m_iSpinnerRel);
+}
+
+void Input::LoadState(StateReader& stream, u32 version)
+{
+    stream.Read(m_Gamepad);
+    stream.Read(m_Keypad);
 
     if (version >= 102)
     {
-        stream.read(reinterpret_cast<char*> (m_KeypadState), sizeof(m_KeypadState));
+        stream.Read(m_KeypadState);
     }
     else
     {
         m_KeypadState[0] = m_KeypadState[1] = 0;
     }
 
-    stream.read(reinterpret_cast<char*> (&m_Segment), sizeof(m_Segment));
-    stream.read(reinterpret_cast<char*> (m_iSpinnerRel), sizeof(m_iSpinnerRel));
+    stream.Read(m_Segment);
+    stream.Read(m_iSpinnerRel);
 }
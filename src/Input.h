@@ -21,6 +21,7 @@
 #define	INPUT_H
 
 #include "definitions.h"
+#include "state_serializer.h"
 
 class Processor;
 class TraceLogger;
@@ -43,8 +44,9 @@ public:
     bool IsKeyPressed(GC_Controllers controller, GC_Keys key) const;
     void Spinner1(int movement);
     void Spinner2(int movement);
-    void SaveState(std::ostream& stream);
-    void LoadState(std::istream& stream, u32 version);
+    void SaveState(StateWriter& stream);
+    size_t GetStateSize();
+    void LoadState(StateReader& stream, u32 version);
     void SetTraceLogger(TraceLogger* pTraceLogger);
     void SetInputSegment(InputSegments segment);
     u8 ReadInput(u8 port);
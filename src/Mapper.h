@@ -21,23 +21,26 @@
 #define MAPPER_H
 
 #include "definitions.h"
-#include <iostream>
+#include "state_serializer.h"
 
 class Cartridge;
+class Memory;
 class TraceLogger;
 
 class Mapper
 {
 public:
-    Mapper(Cartridge* pCartridge) : m_pCartridge(pCartridge), m_pTraceLogger(NULL) { }
+    Mapper(Cartridge* pCartridge, Memory* pMemory) : m_pCartridge(pCartridge), m_pMemory(pMemory), m_pTraceLogger(NULL) { }
     virtual ~Mapper() { }
 
     virtual void Reset() = 0;
+    virtual void UpdatePages() = 0;
     virtual u8 Read(u16 address) = 0;
     virtual u8 Peek(u16 address) { return Read(address); }
     virtual void Write(u16 address, u8 value) = 0;
-    virtual void SaveState(std::ostream& stream) = 0;
-    virtual void LoadState(std::istream& stream) = 0;
+    virtual void SaveState(StateWriter& stream) = 0;
+    virtual size_t GetStateSize() = 0;
+    virtual void LoadState(StateReader& stream) = 0;
     virtual u8 GetRomBank() { return 0; }
     virtual u32 GetRomBankAddress() { return 0; }
     virtual u8 GetBankReg(int) { return 0; }
@@ -51,7 +54,12 @@ protected:
         u8 state = 0, u16 auxiliary = 0);
     void LogMapperEvent(u8 event, u16 address, u8 value,
         u8 state, u16 auxiliary);
+    static u8* GetRomPage(u8* pRom, u32 romSize, u32 offset)
+    {
+        return (IsValidPointer(pRom) && ((offset + 0x2000) <= romSize)) ? pRom + offset : NULL;
+    }
     Cartridge* m_pCartridge;
+    Memory* m_pMemory;
     TraceLogger* m_pTraceLogger;
 };
 
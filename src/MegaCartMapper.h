@@ -26,15 +26,17 @@
 class MegaCartMapper : public Mapper
 {
 public:
-    MegaCartMapper(Cartridge* pCartridge);
+    MegaCartMapper(Cartridge* pCartridge, Memory* pMemory);
     virtual ~MegaCartMapper();
 
     virtual void Reset();
+    virtual void UpdatePages();
     virtual u8 Read(u16 address);
     virtual u8 Peek(u16 address);
     virtual void Write(u16 address, u8 value);
-    virtual void SaveState(std::ostream& stream);
-    virtual void LoadState(std::istream& stream);
+    virtual void SaveState(StateWriter& stream);
+    virtual size_t GetStateSize();
+    virtual void LoadState(StateReader& stream);
     virtual u8 GetRomBank() { return m_RomBank; }
     virtual u32 GetRomBankAddress() { return m_RomBankAddress; }
 
@@ -43,7 +45,7 @@ private:
     u32 m_RomBankAddress;
 };
 
-inline MegaCartMapper::MegaCartMapper(Cartridge* pCartridge) : Mapper(pCartridge)
+inline MegaCartMapper::MegaCartMapper(Cartridge* pCartridge, Memory* pMemory) : Mapper(pCartridge, pMemory)
 {
     Reset();
 }
@@ -56,6 +58,20 @@ inline void MegaCartMapper::Reset()
 {
     m_RomBank = 0;
     m_RomBankAddress = 0;
+    UpdatePages();
+}
+
+inline void MegaCartMapper::UpdatePages()
+{
+    u8* pRom = m_pCartridge->GetROM();
+    u32 romSize = (u32)m_pCartridge->GetROMSize();
+    u32 lastBankAddress = romSize - 0x4000;
+
+    m_pMemory->MapPage(4, GetRomPage(pRom, romSize, lastBankAddress), NULL);
+    m_pMemory->MapPage(5, GetRomPage(pRom, romSize, lastBankAddress + 0x2000), NULL);
+    m_pMemory->MapPage(6, GetRomPage(pRom, romSize, m_RomBankAddress), NULL);
+    // FFC0-FFFF switches banks on reads, so the last page always needs the handler
+    m_pMemory->MapPage(7, NULL, NULL);
 }
 
 inline u8 MegaCartMapper::Read(u16 address)
@@ -75,8 +91,11 @@ inline u8 MegaCartMapper::Read(u16 address)
             m_RomBank = address & (m_pCartridge->GetROMBankCount() - 1);
             m_RomBankAddress = m_RomBank << 14;
             if (old_bank != m_RomBank)
+            {
+                UpdatePages();
                 TraceMapperEvent(TRACE_MAPPER_BANK, address, (u8)address,
                     0, old_bank);
+            }
         }
         return pRom[(address & 0x3FFF) + m_RomBankAddress];
     }
@@ -112,7 +131,10 @@ inline void MegaCartMapper::Write(u16 address, u8 value)
         m_RomBank = address & (m_pCartridge->GetROMBankCount() - 1);
         m_RomBankAddress = m_RomBank << 14;
         if (old_bank != m_RomBank)
+        {
+            UpdatePages();
             TraceMapperEvent(TRACE_MAPPER_BANK, address, value, 0, old_bank);
+        }
     }
     else
     {
@@ -120,16 +142,22 @@ inline void MegaCartMapper::Write(u16 address, u8 value)
     }
 }
 
-inline void MegaCartMapper::SaveState(std::ostream& stream)
+inline void MegaCartMapper::SaveState(StateWriter& stream)
+{
+    stream.Write(m_RomBank);
+    stream.Write(m_RomBankAddress);
+}
+
+inline size_t MegaCartMapper::GetStateSize()
 {
-    stream.write(reinterpret_cast<const char*> (&m_RomBank), sizeof(m_RomBank));
-    stream.write(reinterpret_cast<const char*> (&m_RomBankAddress), sizeof(m_RomBankAddress));
+    return sizeof(m_RomBank) + sizeof(m_RomBankAddress);
 }
 
-inline void MegaCartMapper::LoadState(std::istream& stream)
+inline void MegaCartMapper::LoadState(StateReader& stream)
 {
-    stream.read(reinterpret_cast<char*> (&m_RomBank), sizeof(m_RomBank));
-    stream.read(reinterpret_cast<char*> (&m_RomBankAddress), sizeof(m_RomBankAddress));
+    stream.Read(m_RomBank);
+    stream.Read(m_RomBankAddress);
+    UpdatePages();
 }
 
 #endif /* MEGACARTMAPPER_H */
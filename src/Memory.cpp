@@ -43,10 +43,6 @@ Memory::Memory(Cartridge* pCartridge, Random* pRandom)
     InitPointer(m_pMapper);
     InitPointer(m_pStandardMapper);
     InitPointer(m_pTraceLogger);
-    InitPointer(m_pDisassembledRomMap);
-    InitPointer(m_pDisassembledRamMap);
-    InitPointer(m_pDisassembledBiosMap);
-    InitPointer(m_pDisassembledSGMRamMap);
     InitPointer(m_pBios);
     InitPointer(m_pRam);
     InitPointer(m_pSGMRam);
@@ -54,6 +50,10 @@ Memory::Memory(Cartridge* pCartridge, Random* pRandom)
     m_bSGMUpper = false;
     m_bSGMLower = false;
     m_iTotalCycles = 0;
+    m_UnmappedByte = 0xFF;
+
+    for (int i = 0; i < 8; i++)
+        MapPage(i, NULL, NULL);
 }
 
 Memory::~Memory()
@@ -62,42 +62,6 @@ Memory::~Memory()
     SafeDeleteArray(m_pBios);
     SafeDeleteArray(m_pRam);
     SafeDeleteArray(m_pSGMRam);
-
-    if (IsValidPointer(m_pDisassembledRomMap))
-    {
-        for (int i = 0; i < MAX_ROM_SIZE; i++)
-        {
-            SafeDelete(m_pDisassembledRomMap[i]);
-        }
-        SafeDeleteArray(m_pDisassembledRomMap);
-    }
-
-    if (IsValidPointer(m_pDisassembledRamMap))
-    {
-        for (int i = 0; i < 0x400; i++)
-        {
-            SafeDelete(m_pDisassembledRamMap[i]);
-        }
-        SafeDeleteArray(m_pDisassembledRamMap);
-    }
-
-    if (IsValidPointer(m_pDisassembledBiosMap))
-    {
-        for (int i = 0; i < 0x2000; i++)
-        {
-            SafeDelete(m_pDisassembledBiosMap[i]);
-        }
-        SafeDeleteArray(m_pDisassembledBiosMap);
-    }
-
-    if (IsValidPointer(m_pDisassembledSGMRamMap))
-    {
-        for (int i = 0; i < 0x8000; i++)
-        {
-            SafeDelete(m_pDisassembledSGMRamMap[i]);
-        }
-        SafeDeleteArray(m_pDisassembledSGMRamMap);
-    }
 }
 
 void Memory::SetProcessor(Processor* pProcessor)
@@ -123,29 +87,9 @@ void Memory::Init()
     m_pSGMRam = new u8[0x8000];
 
 #ifndef GEARCOLECO_DISABLE_DISASSEMBLER
-    m_pDisassembledRomMap = new GC_Disassembler_Record*[MAX_ROM_SIZE];
-    for (int i = 0; i < MAX_ROM_SIZE; i++)
-    {
-        InitPointer(m_pDisassembledRomMap[i]);
-    }
-
-    m_pDisassembledRamMap = new GC_Disassembler_Record*[0x400];
-    for (int i = 0; i < 0x400; i++)
-    {
-        InitPointer(m_pDisassembledRamMap[i]);
-    }
-
-    m_pDisassembledBiosMap = new GC_Disassembler_Record*[0x2000];
-    for (int i = 0; i < 0x2000; i++)
-    {
-        InitPointer(m_pDisassembledBiosMap[i]);
-    }
-
-    m_pDisassembledSGMRamMap = new GC_Disassembler_Record*[0x8000];
-    for (int i = 0; i < 0x8000; i++)
-    {
-        InitPointer(m_pDisassembledSGMRamMap[i]);
-    }
+    m_DisassembledRamMap.Init(&m_DisassemblerArena, 0x400);
+    m_DisassembledBiosMap.Init(&m_DisassemblerArena, 0x2000);
+    m_DisassembledSGMRamMap.Init(&m_DisassemblerArena, 0x8000);
 #endif
 
     Reset();
@@ -159,16 +103,16 @@ void Memory::SetupMapper()
     switch (m_pCartridge->GetType())
     {
         case Cartridge::CartridgeMegaCart:
-            m_pMapper = new MegaCartMapper(m_pCartridge);
+            m_pMapper = new MegaCartMapper(m_pCartridge, this);
             break;
         case Cartridge::CartridgeActivisionCart:
-            m_pMapper = new ActivisionMapper(m_pCartridge);
+            m_pMapper = new ActivisionMapper(m_pCartridge, this);
             break;
         case Cartridge::CartridgeOCM:
             m_pMapper = new OCMMapper(m_pCartridge, this);
             break;
         default:
-            m_pStandardMapper = new StandardMapper(m_pCartridge);
+            m_pStandardMapper = new StandardMapper(m_pCartridge, this);
             m_pMapper = m_pStandardMapper;
             break;
     }
@@ -184,6 +128,7 @@ void Memory::Reset()
     m_iTotalCycles = 0;
     m_bSGMUpper = (m_pCartridge->GetType() == Cartridge::CartridgeOCM);
     m_bSGMLower = false;
+    UpdateSGMPages();
 
     for (int i = 0; i < 0x400; i += 4)
     {
@@ -209,21 +154,27 @@ void Memory::Reset()
         m_pBios[0x69] = 0x3C;
 }
 
-void Memory::SaveState(std::ostream& stream)
+void Memory::SaveState(StateWriter& stream)
 {
-    stream.write(reinterpret_cast<const char*> (m_pRam), 0x400);
-    stream.write(reinterpret_cast<const char*> (m_pSGMRam), 0x8000);
-    stream.write(reinterpret_cast<const char*> (&m_bSGMUpper), sizeof(m_bSGMUpper));
-    stream.write(reinterpret_cast<const char*> (&m_bSGMLower), sizeof(m_bSGMLower));
+    stream.WriteBytes(m_pRam, 0x400);
+    stream.WriteBytes(m_pSGMRam, 0x8000);
+    stream.Write(m_bSGMUpper);
+    stream.Write(m_bSGMLower);
     m_pMapper->SaveState(stream);
 }
 
-void Memory::LoadState(std::istream& stream)
+size_t Memory::GetStateSize()
+{
+    return 0x400 + 0x8000 + sizeof(m_bSGMUpper) + sizeof(m_bSGMLower) + m_pMapper->GetStateSize();
+}
+
+void Memory::LoadState(StateReader& stream)
 {
-    stream.read(reinterpret_cast<char*> (m_pRam), 0x400);
-    stream.read(reinterpret_cast<char*> (m_pSGMRam), 0x8000);
-    stream.read(reinterpret_cast<char*> (&m_bSGMUpper), sizeof(m_bSGMUpper));
-    stream.read(reinterpret_cast<char*> (&m_bSGMLower), sizeof(m_bSGMLower));
+    stream.ReadBytes(m_pRam, 0x400);
+    stream.ReadBytes(m_pSGMRam, 0x8000);
+    stream.Read(m_bSGMUpper);
+    stream.Read(m_bSGMLower);
+    UpdateSGMPages();
     m_pMapper->LoadState(stream);
 }
 
@@ -314,12 +265,44 @@ bool Memory::IsBiosLoaded()
 
 void Memory::EnableSGMUpper(bool enable)
 {
-    m_bSGMUpper = enable;
+    if (m_bSGMUpper != enable)
+    {
+        m_bSGMUpper = enable;
+        UpdateSGMPages();
+    }
 }
 
 void Memory::EnableSGMLower(bool enable)
 {
-    m_bSGMLower = enable;
+    if (m_bSGMLower != enable)
+    {
+        m_bSGMLower = enable;
+        UpdateSGMPages();
+    }
+}
+
+void Memory::UpdateSGMPages()
+{
+    // 0000-1FFF: BIOS or SGM RAM
+    if (m_bSGMLower)
+        MapPage(0, m_pSGMRam, m_pSGMRam);
+    else
+        MapPage(0, m_pBios, NULL);
+
+    // 2000-5FFF: SGM RAM or open bus
+    for (int i = 1; i < 3; i++)
+    {
+        if (m_bSGMUpper)
+            MapPage(i, m_pSGMRam + (i * 0x2000), m_pSGMRam + (i * 0x2000));
+        else
+            MapPage(i, &m_UnmappedByte, NULL, 0x0000);
+    }
+
+    // 6000-7FFF: SGM RAM or 1KB RAM mirrored
+    if (m_bSGMUpper)
+        MapPage(3, m_pSGMRam + 0x6000, m_pSGMRam + 0x6000);
+    else
+        MapPage(3, m_pRam, m_pRam, 0x03FF);
 }
 
 Mapper* Memory::GetMapper()
@@ -331,37 +314,15 @@ void Memory::ResetRomDisassembledMemory()
 {
     #ifndef GEARCOLECO_DISABLE_DISASSEMBLER
 
-    if (IsValidPointer(m_pDisassembledRomMap))
-    {
-        for (int i = 0; i < MAX_ROM_SIZE; i++)
-        {
-            SafeDelete(m_pDisassembledRomMap[i]);
-        }
-    }
+    m_DisassembledRamMap.Clear();
+    m_DisassembledBiosMap.Clear();
+    m_DisassembledSGMRamMap.Clear();
+    m_DisassemblerArena.Clear();
 
-    if (IsValidPointer(m_pDisassembledRamMap))
-    {
-        for (int i = 0; i < 0x400; i++)
-        {
-            SafeDelete(m_pDisassembledRamMap[i]);
-        }
-    }
-
-    if (IsValidPointer(m_pDisassembledBiosMap))
-    {
-        for (int i = 0; i < 0x2000; i++)
-        {
-            SafeDelete(m_pDisassembledBiosMap[i]);
-        }
-    }
-
-    if (IsValidPointer(m_pDisassembledSGMRamMap))
-    {
-        for (int i = 0; i < 0x8000; i++)
-        {
-            SafeDelete(m_pDisassembledSGMRamMap[i]);
-        }
-    }
+    // Standard carts can execute up to FFFF even when the ROM is smaller
+    u32 rom_size = (u32)m_pCartridge->GetROMSize();
+    rom_size = (rom_size + 0x1FFF) & ~0x1FFF;
+    m_DisassembledRomMap.Init(&m_DisassemblerArena, MAX(rom_size, (u32)0x8000));
 
     #endif
 }
@@ -370,7 +331,7 @@ GC_Disassembler_Record* Memory::GetOrCreateDisassemblerRecord(u16 address)
 {
 #ifndef GEARCOLECO_DISABLE_DISASSEMBLER
 
-    GC_Disassembler_Record** map = NULL;
+    DisassemblerMap* map = NULL;
     int offset = address;
     int bank = 0;
 
@@ -379,25 +340,25 @@ GC_Disassembler_Record* Memory::GetOrCreateDisassemblerRecord(u16 address)
         case 0x0000:
         {
             offset = address;
-            map = m_bSGMLower ? m_pDisassembledSGMRamMap : m_pDisassembledBiosMap;
+            map = m_bSGMLower ? &m_DisassembledSGMRamMap : &m_DisassembledBiosMap;
             break;
         }
         case 0x2000:
         case 0x4000:
         {
             offset = address;
-            map = m_pDisassembledSGMRamMap;
+            map = &m_DisassembledSGMRamMap;
             break;
         }
         case 0x6000:
         {
             offset = m_bSGMUpper ? address : address & 0x03FF;
-            map = m_bSGMUpper ? m_pDisassembledSGMRamMap : m_pDisassembledRamMap;
+            map = m_bSGMUpper ? &m_DisassembledSGMRamMap : &m_DisassembledRamMap;
             break;
         }
         default:
         {
-            map = m_pDisassembledRomMap;
+            map = &m_DisassembledRomMap;
 
             switch (m_pCartridge->GetType())
             {
@@ -463,34 +424,7 @@ GC_Disassembler_Record* Memory::GetOrCreateDisassemblerRecord(u16 address)
         }
     }
 
-    GC_Disassembler_Record* record = map[offset];
-
-    if (!IsValidPointer(record))
-    {
-        record = new GC_Disassembler_Record();
-        record->address = offset;
-        record->bank = (u8)bank;
-        record->segment[0] = 0;
-        record->name[0] = 0;
-        record->bytes[0] = 0;
-        record->size = 0;
-        for (int i = 0; i < 7; i++)
-            record->opcodes[i] = 0;
-        record->jump = false;
-        record->jump_address = 0;
-        record->jump_bank = 0;
-        record->subroutine = false;
-        record->irq = 0;
-        record->has_operand_address = false;
-        record->operand_address = 0;
-        record->operand_is_zp = false;
-        record->operand_offset = 0;
-        record->operand_length = 0;
-        record->auto_symbol[0] = 0;
-        map[offset] = record;
-    }
-
-    return record;
+    return map->GetOrCreate((u32)offset, (u8)bank);
 
 #else
     UNUSED(address);
@@ -502,7 +436,7 @@ GC_Disassembler_Record* Memory::GetDisassemblerRecord(u16 address)
 {
 #ifndef GEARCOLECO_DISABLE_DISASSEMBLER
 
-    GC_Disassembler_Record** map = NULL;
+    DisassemblerMap* map = NULL;
     int offset = address;
 
     switch (address & 0xE000)
@@ -510,25 +444,25 @@ GC_Disassembler_Record* Memory::GetDisassemblerRecord(u16 address)
         case 0x0000:
         {
             offset = address;
-            map = m_bSGMLower ? m_pDisassembledSGMRamMap : m_pDisassembledBiosMap;
+            map = m_bSGMLower ? &m_DisassembledSGMRamMap : &m_DisassembledBiosMap;
             break;
         }
         case 0x2000:
         case 0x4000:
         {
             offset = address;
-            map = m_pDisassembledSGMRamMap;
+            map = &m_DisassembledSGMRamMap;
             break;
         }
         case 0x6000:
         {
             offset = m_bSGMUpper ? address : address & 0x03FF;
-            map = m_bSGMUpper ? m_pDisassembledSGMRamMap : m_pDisassembledRamMap;
+            map = m_bSGMUpper ? &m_DisassembledSGMRamMap : &m_DisassembledRamMap;
             break;
         }
         default:
         {
-            map = m_pDisassembledRomMap;
+            map = &m_DisassembledRomMap;
 
             switch (m_pCartridge->GetType())
             {
@@ -577,7 +511,7 @@ GC_Disassembler_Record* Memory::GetDisassemblerRecord(u16 address)
         }
     }
 
-    return map[offset];
+    return map->Get((u32)offset);
 
 #else
     UNUSED(address);
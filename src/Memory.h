@@ -22,6 +22,8 @@
 
 #include "definitions.h"
 #include "log.h"
+#include "DisassemblerMap.h"
+#include "state_serializer.h"
 #include <vector>
 
 class Processor;
@@ -52,27 +54,32 @@ public:
     bool LoadBiosFromBuffer(const u8* buffer, int size);
     void UnloadBios();
     bool IsBiosLoaded();
-    void SaveState(std::ostream& stream);
-    void LoadState(std::istream& stream);
+    void SaveState(StateWriter& stream);
+    size_t GetStateSize();
+    void LoadState(StateReader& stream);
     void ResetRomDisassembledMemory();
     u8 DebugRetrieve(u16 address);
     GC_Disassembler_Record* GetOrCreateDisassemblerRecord(u16 address);
     GC_Disassembler_Record* GetDisassemblerRecord(u16 address);
     GC_Disassembler_Record* GetDisassemblerRecord(u16 address, u8 bank);
     u32 GetTracePhysicalAddress(u16 address, u8 bank);
-    GC_Disassembler_Record** GetDisassemblerRomMap();
-    GC_Disassembler_Record** GetDisassemblerRamMap();
-    GC_Disassembler_Record** GetDisassemblerBiosMap();
-    GC_Disassembler_Record** GetDisassemblerSGMRamMap();
+    DisassemblerMap* GetDisassemblerRomMap();
+    DisassemblerMap* GetDisassemblerRamMap();
+    DisassemblerMap* GetDisassemblerBiosMap();
+    DisassemblerMap* GetDisassemblerSGMRamMap();
     u32 GetPhysicalAddress(u16 address);
     u8 GetBank(u16 address);
     bool IsSGMUpperEnabled() { return m_bSGMUpper; }
     bool IsSGMLowerEnabled() { return m_bSGMLower; }
     void EnableSGMUpper(bool enable);
     void EnableSGMLower(bool enable);
+    void MapPage(int page, u8* pRead, u8* pWrite, u16 mask = 0x1FFF);
     Mapper* GetMapper();
     void Tick(unsigned int cycles) { m_iTotalCycles += cycles; }
-    u64 GetTotalCycles() const { return m_iTotalCycles; }
+    u64 GetTotalCycles() const;
+
+private:
+    void UpdateSGMPages();
 
 private:
     Processor* m_pProcessor;
@@ -81,10 +88,11 @@ private:
     Mapper* m_pMapper;
     StandardMapper* m_pStandardMapper;
     TraceLogger* m_pTraceLogger;
-    GC_Disassembler_Record** m_pDisassembledRomMap;
-    GC_Disassembler_Record** m_pDisassembledRamMap;
-    GC_Disassembler_Record** m_pDisassembledBiosMap;
-    GC_Disassembler_Record** m_pDisassembledSGMRamMap;
+    DisassemblerArena m_DisassemblerArena;
+    DisassemblerMap m_DisassembledRomMap;
+    DisassemblerMap m_DisassembledRamMap;
+    DisassemblerMap m_DisassembledBiosMap;
+    DisassemblerMap m_DisassembledSGMRamMap;
     bool m_bBiosLoaded;
     bool m_bSGMUpper;
     bool m_bSGMLower;
@@ -92,6 +100,10 @@ private:
     u8* m_pRam;
     u8* m_pSGMRam;
     u64 m_iTotalCycles;
+    u8* m_pReadPage[8];
+    u8* m_pWritePage[8];
+    u16 m_PageMask[8];
+    u8 m_UnmappedByte;
 };
 
 #include "Memory_inline.h"
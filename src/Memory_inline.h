@@ -31,33 +31,16 @@ inline u8 Memory::Read(u16 address)
     m_pProcessor->CheckMemoryBreakpoints(Processor::GC_BREAKPOINT_TYPE_ROMRAM, address, true);
     #endif
 
-    switch (address & 0xE000)
-    {
-        case 0x0000:
-        {
-            return m_bSGMLower ? m_pSGMRam[address] : m_pBios[address];
-        }
-        case 0x2000:
-        case 0x4000:
-        {
-            return m_bSGMUpper ? m_pSGMRam[address] : 0xFF;
-        }
-        case 0x6000:
-        {
-            return m_bSGMUpper ? m_pSGMRam[address] : m_pRam[address & 0x03FF];
-        }
-        case 0x8000:
-        case 0xA000:
-        case 0xC000:
-        case 0xE000:
-        {
-            if (IsValidPointer(m_pStandardMapper))
-                return m_pStandardMapper->ReadDirect(address);
-            return m_pMapper->Read(address);
-        }
-        default:
-            return 0xFF;
-    }
+    int page = address >> 13;
+    u8* pointer = m_pReadPage[page];
+
+    if (likely(IsValidPointer(pointer)))
+        return pointer[address & m_PageMask[page]];
+
+    // Only cartridge pages fall back to the mapper
+    if (IsValidPointer(m_pStandardMapper))
+        return m_pStandardMapper->ReadDirect(address);
+    return m_pMapper->Read(address);
 }
 
 inline u8 Memory::DebugRetrieve(u16 address)
@@ -87,61 +70,55 @@ inline void Memory::Write(u16 address, u8 value)
     m_pProcessor->CheckMemoryBreakpoints(Processor::GC_BREAKPOINT_TYPE_ROMRAM, address, false);
     #endif
 
-    switch (address & 0xE000)
+    int page = address >> 13;
+    u8* pointer = m_pWritePage[page];
+
+    if (likely(IsValidPointer(pointer)))
     {
-        case 0x0000:
-        {
-            if (m_bSGMLower)
-                m_pSGMRam[address] = value;
-            break;
-        }
-        case 0x2000:
-        case 0x4000:
-        {
-            if (m_bSGMUpper)
-                m_pSGMRam[address] = value;
-            break;
-        }
-        case 0x6000:
-        {
-            if (m_bSGMUpper)
-                m_pSGMRam[address] = value;
-            else
-                m_pRam[address & 0x03FF] = value;
-            break;
-        }
-        case 0x8000:
-        case 0xA000:
-        case 0xC000:
-        case 0xE000:
-        {
-            if (IsValidPointer(m_pStandardMapper))
-                m_pStandardMapper->WriteDirect(address, value);
-            else
-                m_pMapper->Write(address, value);
-            break;
-        }
+        pointer[address & m_PageMask[page]] = value;
+        return;
     }
+
+    // Writes to the BIOS or to unmapped SGM memory are ignored
+    if (address < 0x8000)
+        return;
+
+    if (IsValidPointer(m_pStandardMapper))
+        m_pStandardMapper->WriteDirect(address, value);
+    else
+        m_pMapper->Write(address, value);
 }
 
-inline GC_Disassembler_Record** Memory::GetDisassemblerRomMap()
+inline void Memory::MapPage(int page, u8* pRead, u8* pWrite, u16 mask)
 {
-    return m_pDisassembledRomMap;
+    m_pReadPage[page] = pRead;
+    m_pWritePage[page] = pWrite;
+    m_PageMask[page] = mask;
 }
 
-inline GC_Disassembler_Record** Memory::GetDisassemblerRamMap()
+inline u64 Memory::GetTotalCycles() const
 {
-    return m_pDisassembledRamMap;
+    return m_iTotalCycles + m_pProcessor->GetPendingTStates();
 }
 
-inline GC_Disassembler_Record** Memory::GetDisassemblerBiosMap()
+inline DisassemblerMap* Memory::GetDisassemblerRomMap()
 {
-    return m_pDisassembledBiosMap;
+    return &m_DisassembledRomMap;
 }
 
-inline GC_Disassembler_Record** Memory::GetDisassemblerSGMRamMap()
+inline DisassemblerMap* Memory::GetDisassemblerRamMap()
 {
-    return m_pDisassembledSGMRamMap;
+    return &m_DisassembledRamMap;
+}
+
+inline DisassemblerMap* Memory::GetDisassemblerBiosMap()
+{
+    return &m_DisassembledBiosMap;
+}
+
+inline DisassemblerMap* Memory::GetDisassemblerSGMRamMap()
+{
+    return &m_DisassembledSGMRamMap;
 }
 
 inline GC_Disassembler_Record* Memory::GetDisassemblerRecord(u16 address, u8 bank)
@@ -151,11 +128,7 @@ inline GC_Disassembler_Record* Memory::GetDisassemblerRecord(u16 address, u8 ban
     if (address < 0x8000)
         return GetDisassemblerRecord(address);
 
-    u32 physical_address = GetTracePhysicalAddress(address, bank);
-    if (physical_address >= MAX_ROM_SIZE)
-        return NULL;
-
-    return m_pDisassembledRomMap[physical_address];
+    return m_DisassembledRomMap.Get(GetTracePhysicalAddress(address, bank));
 
 #else
     UNUSED(address);
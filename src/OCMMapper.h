@@ -32,11 +32,13 @@ public:
     virtual ~OCMMapper();
 
     virtual void Reset();
+    virtual void UpdatePages();
     virtual u8 Read(u16 address);
     virtual u8 Peek(u16 address);
     virtual void Write(u16 address, u8 value);
-    virtual void SaveState(std::ostream& stream);
-    virtual void LoadState(std::istream& stream);
+    virtual void SaveState(StateWriter& stream);
+    virtual size_t GetStateSize();
+    virtual void LoadState(StateReader& stream);
     virtual u8 GetBankReg(int index) { return (index >= 0 && index < 4) ? m_BankReg[index] : 0; }
     virtual u8 GetLastBank() { return m_LastBank; }
     virtual u8* GetSaveData();
@@ -88,7 +90,6 @@ private:
     }
 
 private:
-    Memory* m_pMemory;
     u8* m_pROM;
     u8* m_pEEPROM;
     u32 m_ROMSize;
@@ -101,9 +102,8 @@ private:
 };
 
 inline OCMMapper::OCMMapper(Cartridge* pCartridge, Memory* pMemory)
-: Mapper(pCartridge)
+: Mapper(pCartridge, pMemory)
 {
-    m_pMemory = pMemory;
     Reset();
 }
 
@@ -126,6 +126,16 @@ inline void OCMMapper::Reset()
     m_EepromCmdPos = 0;
     m_EepromState = EEP_NONE;
     m_EepromReadExpireCycles = 0;
+    UpdatePages();
+}
+
+inline void OCMMapper::UpdatePages()
+{
+    m_pMemory->MapPage(4, GetRomPage(m_pROM, m_ROMSize, (u32)m_BankReg[3] * 0x2000), NULL);
+    m_pMemory->MapPage(5, GetRomPage(m_pROM, m_ROMSize, (u32)m_BankReg[0] * 0x2000), NULL);
+    m_pMemory->MapPage(6, GetRomPage(m_pROM, m_ROMSize, (u32)m_BankReg[1] * 0x2000), NULL);
+    // E000-FFFF overlays the EEPROM and its status register
+    m_pMemory->MapPage(7, NULL, NULL);
 }
 
 inline u8 OCMMapper::Read(u16 address)
@@ -275,6 +285,9 @@ inline void OCMMapper::Write(u16 address, u8 value)
 
         m_BankReg[bank_index] = NormalizeBank(value);
 
+        if (old_bank != m_BankReg[bank_index])
+            UpdatePages();
+
         if (address == 0xFFFE)
         {
             TraceMapperEvent(TRACE_MAPPER_EEPROM, address, value, m_BankReg[bank_index], m_EepromState);
@@ -288,12 +301,12 @@ inline void OCMMapper::Write(u16 address, u8 value)
     }
 }
 
-inline void OCMMapper::SaveState(std::ostream& stream)
+inline void OCMMapper::SaveState(StateWriter& stream)
 {
 
-    stream.write(reinterpret_cast<const char*>(m_BankReg), sizeof(m_BankReg));
-    stream.write(reinterpret_cast<const char*>(&m_EepromCmdPos), sizeof(m_EepromCmdPos));
-    stream.write(reinterpret_cast<const char*>(&m_EepromState),   sizeof(m_EepromState));
+    stream.Write(m_BankReg);
+    stream.Write(m_EepromCmdPos);
+    stream.Write(m_EepromState);
 
     // Persist “frames remaining” instead of raw cycle deadline
     u64 now = m_pMemory->GetTotalCycles();
@@ -306,21 +319,27 @@ inline void OCMMapper::SaveState(std::ostream& stream)
         if (framesLeft > 3)
             framesLeft = 3;
     }
-    stream.write(reinterpret_cast<const char*>(&framesLeft), sizeof(framesLeft));
+    stream.Write(framesLeft);
 
-    stream.write(reinterpret_cast<const char*>(m_pEEPROM), 0x400);
+    stream.WriteBytes(m_pEEPROM, 0x400);
 }
 
-inline void OCMMapper::LoadState(std::istream& stream)
+inline size_t OCMMapper::GetStateSize()
 {
-    stream.read(reinterpret_cast<char*>(m_BankReg), sizeof(m_BankReg));
+    // The EEPROM read window is stored as one byte of frames left
+    return sizeof(m_BankReg) + sizeof(m_EepromCmdPos) + sizeof(m_EepromState) + sizeof(u8) + 0x400;
+}
+
+inline void OCMMapper::LoadState(StateReader& stream)
+{
+    stream.Read(m_BankReg);
     for (int i = 0; i < 4; i++)
         m_BankReg[i] = NormalizeBank(m_BankReg[i]);
-    stream.read(reinterpret_cast<char*>(&m_EepromCmdPos), sizeof(m_EepromCmdPos));
-    stream.read(reinterpret_cast<char*>(&m_EepromState),   sizeof(m_EepromState));
+    stream.Read(m_EepromCmdPos);
+    stream.Read(m_EepromState);
 
     u8 framesLeft = 0;
-    stream.read(reinterpret_cast<char*>(&framesLeft), sizeof(framesLeft));
+    stream.Read(framesLeft);
     if (framesLeft > 0)
     {
         u64 now = m_pMemory->GetTotalCycles();
@@ -331,7 +350,9 @@ inline void OCMMapper::LoadState(std::istream& stream)
         m_EepromReadExpireCycles = 0;
     }
 
-    stream.read(reinterpret_cast<char*>(m_pEEPROM), 0x400);
+    stream.ReadBytes(m_pEEPROM, 0x400);
+
+    UpdatePages();
 }
 
 inline u8* OCMMapper::GetSaveData()
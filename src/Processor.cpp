@@ -40,6 +40,8 @@ Processor::Processor(Memory* pMemory)
     m_bBranchTaken = false;
     m_iTStates = 0;
     m_iInjectedTStates = 0;
+    m_iPendingTStates = 0;
+    m_bFastCore = false;
     m_bAfterEI = false;
     m_Q = 0;
     m_QTemp = 0;
@@ -56,6 +58,7 @@ Processor::Processor(Memory* pMemory)
     m_memory_breakpoint_hit = false;
     m_run_to_breakpoint_hit = false;
     m_run_to_breakpoint_requested = false;
+    m_breakpoint_map_dirty = true;
     m_disassembler_syntax = GC_Disassembler_Syntax_Gearcoleco;
     m_debug_next_irq = 0;
 
@@ -112,6 +115,7 @@ void Processor::Reset()
     m_bBranchTaken = false;
     m_iTStates = 0;
     m_iInjectedTStates = 0;
+    m_iPendingTStates = 0;
     m_bAfterEI = false;
     m_iInterruptMode = 0;
     PC.SetValue(0x0000);
@@ -158,6 +162,16 @@ IOPorts* Processor::GetIOPOrts()
 }
 
 unsigned int Processor::RunFor(unsigned int tstates)
+{
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+    if (!m_bFastCore)
+        return RunBatch<true>(tstates);
+#endif
+    return RunBatch<false>(tstates);
+}
+
+template <bool debugger>
+unsigned int Processor::RunBatch(unsigned int tstates)
 {
     unsigned int executed = 0;
 
@@ -165,10 +179,14 @@ unsigned int Processor::RunFor(unsigned int tstates)
     {
         m_iTStates = 0;
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
-        m_cpu_breakpoint_hit = false;
-        m_memory_breakpoint_hit = false;
-        m_run_to_breakpoint_hit = false;
+        if (debugger)
+        {
+            m_cpu_breakpoint_hit = false;
+            m_memory_breakpoint_hit = false;
+            m_run_to_breakpoint_hit = false;
+        }
 #endif
+        bool interrupt_taken = false;
 
         if (!m_bInputLastCycle)
         {
@@ -186,12 +204,14 @@ unsigned int Processor::RunFor(unsigned int tstates)
                 IncreaseR();
                 WZ.SetValue(PC.GetValue());
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
-                m_debug_next_irq = 2;
-                PushCallStack(pc, 0x0066, pc, 0);
-                TraceIRQEvent(pc, 0x0066, 2);
+                if (debugger)
+                {
+                    m_debug_next_irq = 2;
+                    PushCallStack(pc, 0x0066, pc, 0);
+                    TraceIRQEvent(pc, 0x0066, 2);
+                }
 #endif
-                DisassembleNextOPCode();
-                return m_iTStates;
+                interrupt_taken = true;
             }
             else if (m_bIFF1 && m_bINTRequested && !m_bAfterEI)
             {
@@ -221,38 +241,98 @@ unsigned int Processor::RunFor(unsigned int tstates)
                 IncreaseR();
                 WZ.SetValue(PC.GetValue());
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
-                m_debug_next_irq = 3;
-                PushCallStack(pc, interrupt_vector, pc, m_pMemory->GetBank(interrupt_vector));
-                TraceIRQEvent(pc, interrupt_vector, 3);
+                if (debugger)
+                {
+                    m_debug_next_irq = 3;
+                    PushCallStack(pc, interrupt_vector, pc, m_pMemory->GetBank(interrupt_vector));
+                    TraceIRQEvent(pc, interrupt_vector, 3);
+                }
 #endif
-                DisassembleNextOPCode();
-                return m_iTStates;
+                interrupt_taken = true;
             }
+            else
+                m_bAfterEI = false;
+        }
 
-            m_bAfterEI = false;
+        if (!interrupt_taken)
+        {
+            if (debugger && !m_bInputLastCycle && !m_bHalt)
+                TraceInstructionEvent(PC.GetValue());
+
+            if (m_bInputLastCycle)
+                ExecuteInputLastCycle();
+            else
+                ExecuteOPCode();
         }
 
-        if (!m_bInputLastCycle && !m_bHalt)
-            TraceInstructionEvent(PC.GetValue());
+        if (debugger)
+            DisassembleNextOPCode();
 
-        if (m_bInputLastCycle)
-            ExecuteInputLastCycle();
-        else
-            ExecuteOPCode();
-        DisassembleNextOPCode();
+        unsigned int step = m_iTStates + m_iInjectedTStates;
+        m_iInjectedTStates = 0;
+        executed += step;
+        m_iPendingTStates += step;
 
-        executed += m_iTStates;
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+        if (debugger && (m_cpu_breakpoint_hit || m_memory_breakpoint_hit || m_run_to_breakpoint_hit))
+            break;
+#endif
 
-        if (m_iInjectedTStates > 0)
-        {
-            executed += m_iInjectedTStates;
-            m_iInjectedTStates = 0;
-        }
+        unsigned int remaining = (executed < tstates) ? (tstates - executed) : 0;
+
+        if (m_bHalt)
+            executed += FastForwardHalt(remaining);
     }
 
     return executed;
 }
 
+void Processor::EnableFastCore(bool enable)
+{
+    if (m_bFastCore == enable)
+        return;
+
+    // Calls and returns made while running fast are not tracked
+    m_bFastCore = enable;
+    m_cpu_breakpoint_hit = false;
+    m_memory_breakpoint_hit = false;
+    m_run_to_breakpoint_hit = false;
+    ClearDisassemblerCallStack();
+}
+
+bool Processor::IsFastCoreEnabled() const
+{
+    return m_bFastCore;
+}
+
+unsigned int Processor::FastForwardHalt(unsigned int tstates)
+{
+    // Interrupts are only requested between batches, so every remaining
+    // HALT step in this batch is identical to the one just executed
+    if ((tstates == 0) || m_bNMIRequested || (m_bIFF1 && m_bINTRequested) || (m_iTStates == 0))
+        return 0;
+
+    unsigned int count = (tstates + m_iTStates - 1) / m_iTStates;
+    unsigned int skipped = count * m_iTStates;
+
+    R = ((R + count) & 0x7F) | (R & 0x80);
+    m_iPendingTStates += skipped;
+
+    return skipped;
+}
+
+unsigned int Processor::GetPendingTStates() const
+{
+    return m_iPendingTStates;
+}
+
+unsigned int Processor::TakePendingTStates()
+{
+    unsigned int pending = m_iPendingTStates;
+    m_iPendingTStates = 0;
+    return pending;
+}
+
 void Processor::LogInstructionEvent(u16 pc)
 {
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
@@ -382,7 +462,11 @@ void Processor::ExecuteOPCode()
 
             opcode = FetchOPCode();
 
+#if defined(PERFORMANCE)
+            DispatchOPCodeCB(opcode);
+#else
             m_OPCodesCB[opcode](this);
+#endif
 
             if (IsPrefixedInstruction())
             {
@@ -404,7 +488,11 @@ void Processor::ExecuteOPCode()
             m_CurrentPrefix = 0x00;
             opcode = FetchOPCode();
 
+#if defined(PERFORMANCE)
+            DispatchOPCodeED(opcode);
+#else
             m_OPCodesED[opcode](this);
+#endif
 
             m_iTStates += kOPCodeEDTStates[opcode];
             break;
@@ -414,7 +502,11 @@ void Processor::ExecuteOPCode()
             if (!m_bInputLastCycle)
                 IncreaseR();
 
+#if defined(PERFORMANCE)
+            DispatchOPCode(opcode);
+#else
             m_OPCodes[opcode](this);
+#endif
 
             if (IsPrefixedInstruction())
                 m_iTStates += kOPCodeXYTStates[opcode];
@@ -981,7 +1073,7 @@ void Processor::RequestMemoryBreakpoint()
     m_memory_breakpoint_hit = true;
 }
 
-void Processor::SaveState(std::ostream& stream)
+void Processor::SaveState(StateWriter& stream)
 {
     using namespace std;
 
@@ -1001,62 +1093,76 @@ void Processor::SaveState(std::ostream& stream)
     u8 i = I;
     u8 r = R;
 
-    stream.write(reinterpret_cast<const char*> (&af), sizeof(af));
-    stream.write(reinterpret_cast<const char*> (&bc), sizeof(bc));
-    stream.write(reinterpret_cast<const char*> (&de), sizeof(de));
-    stream.write(reinterpret_cast<const char*> (&hl), sizeof(hl));
-    stream.write(reinterpret_cast<const char*> (&af2), sizeof(af2));
-    stream.write(reinterpret_cast<const char*> (&bc2), sizeof(bc2));
-    stream.write(reinterpret_cast<const char*> (&de2), sizeof(de2));
-    stream.write(reinterpret_cast<const char*> (&hl2), sizeof(hl2));
-    stream.write(reinterpret_cast<const char*> (&sp), sizeof(sp));
-    stream.write(reinterpret_cast<const char*> (&pc), sizeof(pc));
-    stream.write(reinterpret_cast<const char*> (&ix), sizeof(ix));
-    stream.write(reinterpret_cast<const char*> (&iy), sizeof(iy));
-    stream.write(reinterpret_cast<const char*> (&wz), sizeof(wz));
-    stream.write(reinterpret_cast<const char*> (&i), sizeof(i));
-    stream.write(reinterpret_cast<const char*> (&r), sizeof(r));
-
-    stream.write(reinterpret_cast<const char*> (&m_bIFF1), sizeof(m_bIFF1));
-    stream.write(reinterpret_cast<const char*> (&m_bIFF2), sizeof(m_bIFF2));
-    stream.write(reinterpret_cast<const char*> (&m_bHalt), sizeof(m_bHalt));
-    stream.write(reinterpret_cast<const char*> (&m_bBranchTaken), sizeof(m_bBranchTaken));
-    stream.write(reinterpret_cast<const char*> (&m_iTStates), sizeof(m_iTStates));
-    stream.write(reinterpret_cast<const char*> (&m_iInjectedTStates), sizeof(m_iInjectedTStates));
-    stream.write(reinterpret_cast<const char*> (&m_bAfterEI), sizeof(m_bAfterEI));
-    stream.write(reinterpret_cast<const char*> (&m_iInterruptMode), sizeof(m_iInterruptMode));
-    stream.write(reinterpret_cast<const char*> (&m_CurrentPrefix), sizeof(m_CurrentPrefix));
-    stream.write(reinterpret_cast<const char*> (&m_bINTRequested), sizeof(m_bINTRequested));
-    stream.write(reinterpret_cast<const char*> (&m_bNMIRequested), sizeof(m_bNMIRequested));
-    stream.write(reinterpret_cast<const char*> (&m_bPrefixedCBOpcode), sizeof(m_bPrefixedCBOpcode));
-    stream.write(reinterpret_cast<const char*> (&m_PrefixedCBValue), sizeof(m_PrefixedCBValue));
-    stream.write(reinterpret_cast<const char*> (&m_bInputLastCycle), sizeof(m_bInputLastCycle));
-    stream.write(reinterpret_cast<const char*> (&m_Q), sizeof(m_Q));
-    stream.write(reinterpret_cast<const char*> (&m_QTemp), sizeof(m_QTemp));
+    stream.Write(af);
+    stream.Write(bc);
+    stream.Write(de);
+    stream.Write(hl);
+    stream.Write(af2);
+    stream.Write(bc2);
+    stream.Write(de2);
+    stream.Write(hl2);
+    stream.Write(sp);
+    stream.Write(pc);
+    stream.Write(ix);
+    stream.Write(iy);
+    stream.Write(wz);
+    stream.Write(i);
+    stream.Write(r);
+
+    stream.Write(m_bIFF1);
+    stream.Write(m_bIFF2);
+    stream.Write(m_bHalt);
+    stream.Write(m_bBranchTaken);
+    stream.Write(m_iTStates);
+    stream.Write(m_iInjectedTStates);
+    stream.Write(m_bAfterEI);
+    stream.Write(m_iInterruptMode);
+    stream.Write(m_CurrentPrefix);
+    stream.Write(m_bINTRequested);
+    stream.Write(m_bNMIRequested);
+    stream.Write(m_bPrefixedCBOpcode);
+    stream.Write(m_PrefixedCBValue);
+    stream.Write(m_bInputLastCycle);
+    stream.Write(m_Q);
+    stream.Write(m_QTemp);
+}
+
+size_t Processor::GetStateSize()
+{
+    // 13 register pairs plus I and R
+    size_t size = (13 * sizeof(u16)) + (2 * sizeof(u8));
+
+    size += sizeof(m_bIFF1) + sizeof(m_bIFF2) + sizeof(m_bHalt) + sizeof(m_bBranchTaken);
+    size += sizeof(m_iTStates) + sizeof(m_iInjectedTStates) + sizeof(m_bAfterEI) + sizeof(m_iInterruptMode);
+    size += sizeof(m_CurrentPrefix) + sizeof(m_bINTRequested) + sizeof(m_bNMIRequested);
+    size += sizeof(m_bPrefixedCBOpcode) + sizeof(m_PrefixedCBValue) + sizeof(m_bInputLastCycle);
+    size += sizeof(m_Q) + sizeof(m_QTemp);
+
+    return size;
 }
 
-void Processor::LoadState(std::istream& stream, int version)
+void Processor::LoadState(StateReader& stream, int version)
 {
     using namespace std;
 
     u16 af, bc, de, hl, af2, bc2, de2, hl2, sp, pc, ix, iy, wz;
     u8 i, r;
 
-    stream.read(reinterpret_cast<char*> (&af), sizeof(af));
-    stream.read(reinterpret_cast<char*> (&bc), sizeof(bc));
-    stream.read(reinterpret_cast<char*> (&de), sizeof(de));
-    stream.read(reinterpret_cast<char*> (&hl), sizeof(hl));
-    stream.read(reinterpret_cast<char*> (&af2), sizeof(af2));
-    stream.read(reinterpret_cast<char*> (&bc2), sizeof(bc2));
-    stream.read(reinterpret_cast<char*> (&de2), sizeof(de2));
-    stream.read(reinterpret_cast<char*> (&hl2), sizeof(hl2));
-    stream.read(reinterpret_cast<char*> (&sp), sizeof(sp));
-    stream.read(reinterpret_cast<char*> (&pc), sizeof(pc));
-    stream.read(reinterpret_cast<char*> (&ix), sizeof(ix));
-    stream.read(reinterpret_cast<char*> (&iy), sizeof(iy));
-    stream.read(reinterpret_cast<char*> (&wz), sizeof(wz));
-    stream.read(reinterpret_cast<char*> (&i), sizeof(i));
-    stream.read(reinterpret_cast<char*> (&r), sizeof(r));
+    stream.Read(af);
+    stream.Read(bc);
+    stream.Read(de);
+    stream.Read(hl);
+    stream.Read(af2);
+    stream.Read(bc2);
+    stream.Read(de2);
+    stream.Read(hl2);
+    stream.Read(sp);
+    stream.Read(pc);
+    stream.Read(ix);
+    stream.Read(iy);
+    stream.Read(wz);
+    stream.Read(i);
+    stream.Read(r);
 
     AF.SetValue(af);
     BC.SetValue(bc);
@@ -1074,25 +1180,25 @@ void Processor::LoadState(std::istream& stream, int version)
     I = i;
     R = r;
 
-    stream.read(reinterpret_cast<char*> (&m_bIFF1), sizeof(m_bIFF1));
-    stream.read(reinterpret_cast<char*> (&m_bIFF2), sizeof(m_bIFF2));
-    stream.read(reinterpret_cast<char*> (&m_bHalt), sizeof(m_bHalt));
-    stream.read(reinterpret_cast<char*> (&m_bBranchTaken), sizeof(m_bBranchTaken));
-    stream.read(reinterpret_cast<char*> (&m_iTStates), sizeof(m_iTStates));
-    stream.read(reinterpret_cast<char*> (&m_iInjectedTStates), sizeof(m_iInjectedTStates));
-    stream.read(reinterpret_cast<char*> (&m_bAfterEI), sizeof(m_bAfterEI));
-    stream.read(reinterpret_cast<char*> (&m_iInterruptMode), sizeof(m_iInterruptMode));
-    stream.read(reinterpret_cast<char*> (&m_CurrentPrefix), sizeof(m_CurrentPrefix));
-    stream.read(reinterpret_cast<char*> (&m_bINTRequested), sizeof(m_bINTRequested));
-    stream.read(reinterpret_cast<char*> (&m_bNMIRequested), sizeof(m_bNMIRequested));
-    stream.read(reinterpret_cast<char*> (&m_bPrefixedCBOpcode), sizeof(m_bPrefixedCBOpcode));
-    stream.read(reinterpret_cast<char*> (&m_PrefixedCBValue), sizeof(m_PrefixedCBValue));
-    stream.read(reinterpret_cast<char*> (&m_bInputLastCycle), sizeof(m_bInputLastCycle));
+    stream.Read(m_bIFF1);
+    stream.Read(m_bIFF2);
+    stream.Read(m_bHalt);
+    stream.Read(m_bBranchTaken);
+    stream.Read(m_iTStates);
+    stream.Read(m_iInjectedTStates);
+    stream.Read(m_bAfterEI);
+    stream.Read(m_iInterruptMode);
+    stream.Read(m_CurrentPrefix);
+    stream.Read(m_bINTRequested);
+    stream.Read(m_bNMIRequested);
+    stream.Read(m_bPrefixedCBOpcode);
+    stream.Read(m_PrefixedCBValue);
+    stream.Read(m_bInputLastCycle);
 
     if (version >= 105)
     {
-        stream.read(reinterpret_cast<char*> (&m_Q), sizeof(m_Q));
-        stream.read(reinterpret_cast<char*> (&m_QTemp), sizeof(m_QTemp));
+        stream.Read(m_Q);
+        stream.Read(m_QTemp);
     }
     else
     {
@@ -1126,35 +1232,13 @@ void Processor::CheckBreakpoints()
     if (!m_breakpoints_enabled)
         return;
 
-    for (int i = 0; i < (int)m_breakpoints.size(); i++)
-    {
-        GC_Breakpoint* brk = &m_breakpoints[i];
-
-        if (!brk->enabled)
-            continue;
-        if (!brk->execute)
-            continue;
-        if (brk->type != GC_BREAKPOINT_TYPE_ROMRAM)
-            continue;
+    if (m_breakpoint_map_dirty)
+        UpdateBreakpointMap();
 
-        if (brk->range)
-        {
-            if (PC.GetValue() >= brk->address1 && PC.GetValue() <= brk->address2)
-            {
-                m_cpu_breakpoint_hit = true;
-                m_run_to_breakpoint_requested = false;
-                return;
-            }
-        }
-        else
-        {
-            if (PC.GetValue() == brk->address1)
-            {
-                m_cpu_breakpoint_hit = true;
-                m_run_to_breakpoint_requested = false;
-                return;
-            }
-        }
+    if (m_breakpoint_map[GC_BREAKPOINT_TYPE_ROMRAM][PC.GetValue()] & GC_BREAKPOINT_FLAG_EXECUTE)
+    {
+        m_cpu_breakpoint_hit = true;
+        m_run_to_breakpoint_requested = false;
     }
 
 #endif
@@ -1166,9 +1250,38 @@ void Processor::EnableBreakpoints(bool enable, bool irqs)
     m_breakpoints_irq_enabled = irqs;
 }
 
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+void Processor::UpdateBreakpointMap()
+{
+    memset(m_breakpoint_map, 0, sizeof(m_breakpoint_map));
+
+    for (int i = 0; i < (int)m_breakpoints.size(); i++)
+    {
+        GC_Breakpoint* brk = &m_breakpoints[i];
+
+        if (!brk->enabled)
+            continue;
+        if ((brk->type < 0) || (brk->type >= GC_BREAKPOINT_TYPE_COUNT))
+            continue;
+
+        u8 flags = (brk->read ? GC_BREAKPOINT_FLAG_READ : 0) |
+                   (brk->write ? GC_BREAKPOINT_FLAG_WRITE : 0) |
+                   (brk->execute ? GC_BREAKPOINT_FLAG_EXECUTE : 0);
+
+        int last = brk->range ? brk->address2 : brk->address1;
+
+        for (int address = brk->address1; address <= last; address++)
+            m_breakpoint_map[brk->type][address] |= flags;
+    }
+
+    m_breakpoint_map_dirty = false;
+}
+#endif
+
 void Processor::ResetBreakpoints()
 {
     m_breakpoints.clear();
+    m_breakpoint_map_dirty = true;
 }
 
 bool Processor::AddBreakpoint(int type, char* text, bool read, bool write, bool execute)
@@ -1250,7 +1363,10 @@ bool Processor::AddBreakpoint(int type, char* text, bool read, bool write, bool
     }
 
     if (!found)
+    {
         m_breakpoints.push_back(brk);
+        m_breakpoint_map_dirty = true;
+    }
 
     return true;
 }
@@ -1284,6 +1400,7 @@ void Processor::RemoveBreakpoint(int type, u16 address)
         if (!item->range && (item->address1 == address) && (item->type == type))
         {
             m_breakpoints.erase(m_breakpoints.begin() + b);
+            m_breakpoint_map_dirty = true;
             break;
         }
     }
@@ -1315,56 +1432,12 @@ void Processor::SetTraceLogger(TraceLogger* pTraceLogger)
     m_pTraceLogger = pTraceLogger;
 }
 
-void Processor::CheckMemoryBreakpoints(int type, u16 address, bool read)
-{
-#ifndef GEARCOLECO_DISABLE_DISASSEMBLER
-
-    if (!m_breakpoints_enabled)
-        return;
-
-    for (int i = 0; i < (int)m_breakpoints.size(); i++)
-    {
-        GC_Breakpoint* brk = &m_breakpoints[i];
-
-        if (!brk->enabled)
-            continue;
-        if (brk->type != type)
-            continue;
-        if (read && !brk->read)
-            continue;
-        if (!read && !brk->write)
-            continue;
-
-        if (brk->range)
-        {
-            if (address >= brk->address1 && address <= brk->address2)
-            {
-                m_memory_breakpoint_hit = true;
-                m_run_to_breakpoint_requested = false;
-                return;
-            }
-        }
-        else
-        {
-            if (address == brk->address1)
-            {
-                m_memory_breakpoint_hit = true;
-                m_run_to_breakpoint_requested = false;
-                return;
-            }
-        }
-    }
-
-#else
-    UNUSED(type);
-    UNUSED(address);
-    UNUSED(read);
-#endif
-}
-
 void Processor::PushCallStack(u16 src, u16 dest, u16 back, u8 bank)
 {
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+    if (m_bFastCore)
+        return;
+
     GC_CallStackEntry entry;
     entry.src = src;
     entry.dest = dest;
@@ -1383,7 +1456,7 @@ void Processor::PushCallStack(u16 src, u16 dest, u16 back, u8 bank)
 void Processor::PopCallStack()
 {
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
-    if (!m_disassembler_call_stack.empty())
+    if (!m_bFastCore && !m_disassembler_call_stack.empty())
         m_disassembler_call_stack.pop();
 #endif
 }
@@ -25,6 +25,7 @@
 #include <stack>
 #include "definitions.h"
 #include "SixteenBitRegister.h"
+#include "state_serializer.h"
 
 class Memory;
 class IOPorts;
@@ -41,6 +42,13 @@ public:
         GC_BREAKPOINT_TYPE_COUNT
     };
 
+    enum GC_Breakpoint_Flag
+    {
+        GC_BREAKPOINT_FLAG_READ = 0x01,
+        GC_BREAKPOINT_FLAG_WRITE = 0x02,
+        GC_BREAKPOINT_FLAG_EXECUTE = 0x04
+    };
+
     struct GC_Breakpoint
     {
         bool enabled;
@@ -92,13 +100,18 @@ public:
     void Init();
     void Reset();
     unsigned int RunFor(unsigned int tstates);
+    unsigned int GetPendingTStates() const;
+    unsigned int TakePendingTStates();
+    void EnableFastCore(bool enable);
+    bool IsFastCoreEnabled() const;
     void InjectTStates(unsigned int tstates);
     void RequestINT(bool assert);
     void RequestNMI();
     void SetIOPOrts(IOPorts* pIOPorts);
     IOPorts* GetIOPOrts();
-    void SaveState(std::ostream& stream);
-    void LoadState(std::istream& stream, int version);
+    void SaveState(StateWriter& stream);
+    size_t GetStateSize();
+    void LoadState(StateReader& stream, int version);
     ProcessorState* GetState();
     void SetDisassemblerSyntax(GC_Disassembler_Syntax syntax);
     GC_Disassembler_Syntax GetDisassemblerSyntax() const;
@@ -121,7 +134,8 @@ public:
     void AddRunToBreakpoint(u16 address);
     void RemoveBreakpoint(int type, u16 address);
     bool IsBreakpoint(int type, u16 address);
-    std::vector<GC_Breakpoint>* GetBreakpoints();
+    const std::vector<GC_Breakpoint>* GetBreakpoints() const;
+    std::vector<GC_Breakpoint>* EditBreakpoints();
     void ClearDisassemblerCallStack();
     std::stack<GC_CallStackEntry>* GetDisassemblerCallStack();
     void CheckMemoryBreakpoints(int type, u16 address, bool read);
@@ -165,6 +179,8 @@ private:
     bool m_bBranchTaken;
     unsigned int m_iTStates;
     unsigned int m_iInjectedTStates;
+    unsigned int m_iPendingTStates;
+    bool m_bFastCore;
     bool m_bAfterEI;
     int m_iInterruptMode;
     IOPorts* m_pIOPorts;
@@ -180,6 +196,10 @@ private:
     bool m_memory_breakpoint_hit;
     bool m_run_to_breakpoint_hit;
     std::vector<GC_Breakpoint> m_breakpoints;
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+    u8 m_breakpoint_map[GC_BREAKPOINT_TYPE_COUNT][0x10000];
+#endif
+    bool m_breakpoint_map_dirty;
     GC_Breakpoint m_run_to_breakpoint;
     bool m_run_to_breakpoint_requested;
     std::stack<GC_CallStackEntry> m_disassembler_call_stack;
@@ -188,11 +208,13 @@ private:
     ProcessorState m_ProcessorState;
 
 private:
+    template <bool debugger> unsigned int RunBatch(unsigned int tstates);
     u8 FetchOPCode();
     u16 FetchArg16();
     void ExecuteOPCode();
     void ExecuteInputLastCycle();
     void LeaveHalt();
+    unsigned int FastForwardHalt(unsigned int tstates);
     void ClearAllFlags();
     void ToggleZeroFlagFromResult(u16 result);
     void ToggleSignFlagFromResult(u8 result);
@@ -211,6 +233,9 @@ private:
     void InvalidOPCode();
     void UndocumentedOPCode();
     void CheckBreakpoints();
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+    void UpdateBreakpointMap();
+#endif
     void PushCallStack(u16 src, u16 dest, u16 back, u8 bank);
     void PopCallStack();
     void FormatDisassemblerDataBytes(char* text, size_t text_size, const u8* bytes, int size);
@@ -287,6 +312,11 @@ private:
     void OPCodes_RES(u8* reg, int bit);
     void OPCodes_RES_HL(int bit);
     void InitOPCodeTable();
+#if defined(PERFORMANCE)
+    void DispatchOPCode(u8 opcode);
+    void DispatchOPCodeCB(u8 opcode);
+    void DispatchOPCodeED(u8 opcode);
+#endif
 
     void OPCode0x00();
     void OPCode0x01();
@@ -1317,11 +1317,43 @@ inline void Processor::OPCodes_RES_HL(int bit)
     m_pMemory->Write(address, result);
 }
 
-inline std::vector<Processor::GC_Breakpoint>* Processor::GetBreakpoints()
+inline const std::vector<Processor::GC_Breakpoint>* Processor::GetBreakpoints() const
 {
     return &m_breakpoints;
 }
 
+inline std::vector<Processor::GC_Breakpoint>* Processor::EditBreakpoints()
+{
+    // Callers edit the list in place
+    m_breakpoint_map_dirty = true;
+    return &m_breakpoints;
+}
+
+inline void Processor::CheckMemoryBreakpoints(int type, u16 address, bool read)
+{
+#ifndef GEARCOLECO_DISABLE_DISASSEMBLER
+
+    if (!m_breakpoints_enabled)
+        return;
+
+    if (m_breakpoint_map_dirty)
+        UpdateBreakpointMap();
+
+    u8 flag = read ? GC_BREAKPOINT_FLAG_READ : GC_BREAKPOINT_FLAG_WRITE;
+
+    if (m_breakpoint_map[type][address] & flag)
+    {
+        m_memory_breakpoint_hit = true;
+        m_run_to_breakpoint_requested = false;
+    }
+
+#else
+    UNUSED(type);
+    UNUSED(address);
+    UNUSED(read);
+#endif
+}
+
 inline std::stack<Processor::GC_CallStackEntry>* Processor::GetDisassemblerCallStack()
 {
     return &m_disassembler_call_stack;
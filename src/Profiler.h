@@ -0,0 +1,118 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef PROFILER_H
+#define	PROFILER_H
+
+#include <chrono>
+#include "definitions.h"
+
+enum GC_Profile_Section
+{
+    PROFILE_OTHER = 0,
+    PROFILE_CPU,
+    PROFILE_VDP,
+    PROFILE_PSG,
+    PROFILE_AY8910,
+    PROFILE_PIXELS,
+    PROFILE_SECTION_COUNT
+};
+
+// Splits wall time between subsystems. Sections nest and time is exclusive:
+// entering a section pauses the running one until the nested one is left.
+class Profiler
+{
+public:
+    Profiler();
+    void Enable(bool enable);
+    bool IsEnabled() const;
+    void Reset();
+    u64 GetNanoseconds(GC_Profile_Section section) const;
+    INLINE GC_Profile_Section Enter(GC_Profile_Section section);
+    INLINE void Leave(GC_Profile_Section previous);
+
+private:
+    INLINE u64 Now() const;
+
+private:
+    bool m_bEnabled;
+    GC_Profile_Section m_Current;
+    u64 m_LastTime;
+    u64 m_Time[PROFILE_SECTION_COUNT];
+};
+
+inline Profiler::Profiler()
+{
+    m_bEnabled = false;
+    Reset();
+}
+
+inline void Profiler::Enable(bool enable)
+{
+    m_bEnabled = enable;
+    m_Current = PROFILE_OTHER;
+    m_LastTime = Now();
+}
+
+inline bool Profiler::IsEnabled() const
+{
+    return m_bEnabled;
+}
+
+inline void Profiler::Reset()
+{
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++)
+        m_Time[i] = 0;
+
+    m_Current = PROFILE_OTHER;
+    m_LastTime = Now();
+}
+
+inline u64 Profiler::GetNanoseconds(GC_Profile_Section section) const
+{
+    return m_Time[section];
+}
+
+INLINE GC_Profile_Section Profiler::Enter(GC_Profile_Section section)
+{
+    GC_Profile_Section previous = m_Current;
+
+    if (!m_bEnabled)
+        return previous;
+
+    u64 now = Now();
+    m_Time[m_Current] += now - m_LastTime;
+    m_LastTime = now;
+    m_Current = section;
+
+    return previous;
+}
+
+INLINE void Profiler::Leave(GC_Profile_Section previous)
+{
+    Enter(previous);
+}
+
+INLINE u64 Profiler::Now() const
+{
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif	/* PROFILER_H */
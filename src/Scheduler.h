@@ -0,0 +1,105 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef SCHEDULER_H
+#define	SCHEDULER_H
+
+#include "definitions.h"
+#include "Processor.h"
+#include "Video.h"
+#include "Audio.h"
+#include "Memory.h"
+#include "Profiler.h"
+
+#define GC_MAX_FRAME_CYCLES 702240
+
+// The CPU runs in batches up to the next scheduled event (VDP line events,
+// VINT/NMI and the frame limit). Devices are only ticked when a batch ends
+// or when the CPU touches a port and they need to be caught up.
+class Scheduler
+{
+public:
+    Scheduler(Processor* pProcessor, Video* pVideo, Audio* pAudio, Memory* pMemory, Profiler* pProfiler, u64* pMasterClockCycles);
+    void BeginFrame();
+    unsigned int GetCyclesToNextEvent();
+    bool Sync();
+    void CatchUp();
+
+private:
+    Processor* m_pProcessor;
+    Video* m_pVideo;
+    Audio* m_pAudio;
+    Memory* m_pMemory;
+    Profiler* m_pProfiler;
+    u64* m_pMasterClockCycles;
+    unsigned int m_iFrameCycles;
+};
+
+inline Scheduler::Scheduler(Processor* pProcessor, Video* pVideo, Audio* pAudio, Memory* pMemory, Profiler* pProfiler, u64* pMasterClockCycles)
+{
+    m_pProcessor = pProcessor;
+    m_pVideo = pVideo;
+    m_pAudio = pAudio;
+    m_pMemory = pMemory;
+    m_pProfiler = pProfiler;
+    m_pMasterClockCycles = pMasterClockCycles;
+    m_iFrameCycles = 0;
+}
+
+inline void Scheduler::BeginFrame()
+{
+    m_iFrameCycles = 0;
+}
+
+inline unsigned int Scheduler::GetCyclesToNextEvent()
+{
+    unsigned int next = m_pVideo->GetCyclesToNextEvent();
+    unsigned int frame_limit = GC_MAX_FRAME_CYCLES + 1 - MIN(m_iFrameCycles, (unsigned int)GC_MAX_FRAME_CYCLES);
+    return MIN(next, frame_limit);
+}
+
+inline bool Scheduler::Sync()
+{
+    unsigned int cycles = m_pProcessor->TakePendingTStates();
+
+    if (cycles == 0)
+        return false;
+
+    *m_pMasterClockCycles += cycles;
+    m_iFrameCycles += cycles;
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+    GC_Profile_Section section = m_pProfiler->Enter(PROFILE_VDP);
+    bool vblank = m_pVideo->Tick(cycles);
+    m_pProfiler->Leave(section);
+#else
+    bool vblank = m_pVideo->Tick(cycles);
+#endif
+    m_pAudio->Tick(cycles);
+    m_pMemory->Tick(cycles);
+
+    return vblank || (m_iFrameCycles > GC_MAX_FRAME_CYCLES);
+}
+
+inline void Scheduler::CatchUp()
+{
+    // Pending cycles never reach the next event, so no event can fire here
+    Sync();
+}
+
+#endif	/* SCHEDULER_H */
@@ -27,14 +27,16 @@
 class StandardMapper final : public Mapper
 {
 public:
-    StandardMapper(Cartridge* pCartridge);
+    StandardMapper(Cartridge* pCartridge, Memory* pMemory);
     virtual ~StandardMapper();
     
     virtual void Reset();
+    virtual void UpdatePages();
     virtual u8 Read(u16 address);
     virtual void Write(u16 address, u8 value);
-    virtual void SaveState(std::ostream& stream);
-    virtual void LoadState(std::istream& stream);
+    virtual void SaveState(StateWriter& stream);
+    virtual size_t GetStateSize();
+    virtual void LoadState(StateReader& stream);
     virtual u8* GetSaveData();
     virtual int GetSaveDataSize();
     NO_INLINE u8 ReadDirect(u16 address)
@@ -50,7 +52,7 @@ private:
     u8 m_SRAM[0x800];
 };
 
-inline StandardMapper::StandardMapper(Cartridge* pCartridge) : Mapper(pCartridge)
+inline StandardMapper::StandardMapper(Cartridge* pCartridge, Memory* pMemory) : Mapper(pCartridge, pMemory)
 {
     memset(m_SRAM, 0, sizeof(m_SRAM));
 }
@@ -62,6 +64,20 @@ inline StandardMapper::~StandardMapper()
 inline void StandardMapper::Reset()
 {
     memset(m_SRAM, 0, sizeof(m_SRAM));
+    UpdatePages();
+}
+
+inline void StandardMapper::UpdatePages()
+{
+    u8* pRom = m_pCartridge->GetROM();
+    u32 romSize = (u32)m_pCartridge->GetROMSize();
+
+    for (int i = 0; i < 4; i++)
+        m_pMemory->MapPage(4 + i, GetRomPage(pRom, romSize, i * 0x2000), NULL);
+
+    // SRAM writes go through the handler so they can be traced
+    if (m_pCartridge->HasSRAM())
+        m_pMemory->MapPage(7, m_SRAM, NULL, 0x07FF);
 }
 
 inline u8 StandardMapper::Read(u16 address)
@@ -96,19 +112,24 @@ inline void StandardMapper::Write(u16 address, u8 value)
     }
 }
 
-inline void StandardMapper::SaveState(std::ostream& stream)
+inline void StandardMapper::SaveState(StateWriter& stream)
 {
     if (m_pCartridge->HasSRAM())
     {
-        stream.write(reinterpret_cast<const char*>(m_SRAM), sizeof(m_SRAM));
+        stream.Write(m_SRAM);
     }
 }
 
-inline void StandardMapper::LoadState(std::istream& stream)
+inline size_t StandardMapper::GetStateSize()
+{
+    return m_pCartridge->HasSRAM() ? sizeof(m_SRAM) : 0;
+}
+
+inline void StandardMapper::LoadState(StateReader& stream)
 {
     if (m_pCartridge->HasSRAM())
     {
-        stream.read(reinterpret_cast<char*>(m_SRAM), sizeof(m_SRAM));
+        stream.Read(m_SRAM);
     }
 }
 
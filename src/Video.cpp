@@ -21,13 +21,15 @@
 #include "Memory.h"
 #include "Processor.h"
 #include "TraceLogger.h"
+#include "Profiler.h"
+#include <algorithm>
 
 Video::Video(Memory* pMemory, Processor* pProcessor)
 {
     m_pMemory = pMemory;
     m_pProcessor = pProcessor;
     InitPointer(m_pTraceLogger);
-    InitPointer(m_pInfoBuffer);
+    InitPointer(m_pProfiler);
     InitPointer(m_pFrameBuffer);
     InitPointer(m_pVdpVRAM);
     m_bFirstByteInSequence = true;
@@ -47,16 +49,39 @@ Video::Video(Memory* pMemory, Processor* pProcessor)
     m_bDisplayEnabled = false;
     m_bSpriteOvrRequest = false;
     m_bNoSpriteLimit = false;
+    m_bSkipRender = false;
+    m_iLineCacheHits = 0;
+    m_iLineCacheMisses = 0;
+    InvalidateLineCache();
+    InvalidateDebugVRAM();
     m_Overscan = OverscanDisabled;
+    m_bSpriteLinesDirty = true;
+    m_SpriteLinesReg1 = 0;
+    m_SpriteLinesReg6 = 0;
+    memset(m_SpriteLineMask, 0, sizeof(m_SpriteLineMask));
+    InitPointer(m_pHostFrameBuffer);
+    m_HostPixelFormat = GC_PIXEL_RGBA8888;
+    InitPointer(m_pHostPalette16);
+    InitPointer(m_pHostPalette32);
+    m_iHostLines = 0;
+    m_iHostWidth = GC_RESOLUTION_WIDTH;
+    m_iHostHeight = GC_RESOLUTION_HEIGHT;
+    m_iHostOverscanH = 0;
+    m_iHostOverscanV = 0;
 
     for (int i = 0; i < 48; i++)
         m_CustomPalette[i] = 0;
     m_pCurrentPalette = const_cast<u8*>(kPalette_888_coleco);
+
+    for (int pattern = 0; pattern < 256; pattern++)
+    {
+        for (int pixel = 0; pixel < 8; pixel++)
+            m_PatternMask[pattern][pixel] = IsSetBit(pattern, 7 - pixel) ? 0xFFFF : 0x0000;
+    }
 }
 
 Video::~Video()
 {
-    SafeDeleteArray(m_pInfoBuffer);
     SafeDeleteArray(m_pFrameBuffer);
     SafeDeleteArray(m_pVdpVRAM);
 }
@@ -64,7 +89,6 @@ Video::~Video()
 void Video::Init()
 {
     m_pFrameBuffer = new u16[GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN];
-    m_pInfoBuffer = new u8[GC_RESOLUTION_WIDTH * GC_LINES_PER_FRAME_PAL];
     m_pVdpVRAM = new u8[0x4000];
     InitPalettes();
     Reset(false);
@@ -75,6 +99,11 @@ void Video::SetTraceLogger(TraceLogger* pTraceLogger)
     m_pTraceLogger = pTraceLogger;
 }
 
+void Video::SetProfiler(Profiler* pProfiler)
+{
+    m_pProfiler = pProfiler;
+}
+
 void Video::LogVDPEvent(u8 event, u8 reg, u8 raw, int sprite, int auxiliary)
 {
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
@@ -167,8 +196,6 @@ void Video::Reset(bool bPAL)
 
     for (int i = 0; i < (GC_RESOLUTION_WIDTH_WITH_OVERSCAN * GC_RESOLUTION_HEIGHT_WITH_OVERSCAN); i++)
         m_pFrameBuffer[i] = 1;
-    for (int i = 0; i < (GC_RESOLUTION_WIDTH * GC_LINES_PER_FRAME_PAL); i++)
-        m_pInfoBuffer[i] = 0;
     for (int i = 0; i < 0x4000; i++)
         m_pVdpVRAM[i] = 0;
     for (int i = 0; i < 8; i++)
@@ -188,6 +215,11 @@ void Video::Reset(bool bPAL)
     for (int i = 0; i < (GC_MAX_SPRITES * 4); i++)
         m_SpriteAttribLatch[i] = 0;
 
+    m_bSpriteLinesDirty = true;
+    InitPointer(m_pHostFrameBuffer);
+    InvalidateLineCache();
+    InvalidateDebugVRAM();
+
     m_Timing[TIMING_VINT] = 220;
     m_Timing[TIMING_RENDER] = 195;
     m_Timing[TIMING_DISPLAY] = 37;
@@ -196,6 +228,61 @@ void Video::Reset(bool bPAL)
 void Video::SetNoSpriteLimit(bool noSpriteLimit)
 {
     m_bNoSpriteLimit = noSpriteLimit;
+    InvalidateLineCache();
+}
+
+// Frames that are never shown only need the sprite status bits
+void Video::SetSkipRender(bool skip)
+{
+    m_bSkipRender = skip;
+}
+
+bool Video::IsSkipRender()
+{
+    return m_bSkipRender;
+}
+
+void Video::InvalidateLineCache()
+{
+    m_LineDirty[0] = m_LineDirty[1] = m_LineDirty[2] = ~0ULL;
+}
+
+u64 Video::GetLineCacheHits()
+{
+    return m_iLineCacheHits;
+}
+
+u64 Video::GetLineCacheMisses()
+{
+    return m_iLineCacheMisses;
+}
+
+void Video::ResetLineCacheCounters()
+{
+    m_iLineCacheHits = 0;
+    m_iLineCacheMisses = 0;
+}
+
+void Video::InvalidateDebugVRAM()
+{
+    memset(m_DebugVRAMDirty, 0, sizeof(m_DebugVRAMDirty));
+    m_bDebugVRAMRefresh = true;
+}
+
+// Adds the blocks written since the last call and reports whether everything must be redrawn
+bool Video::TakeDebugVRAMChanges(u32* dirtyBlocks)
+{
+    for (int i = 0; i < 64; i++)
+    {
+        dirtyBlocks[i] |= m_DebugVRAMDirty[i];
+        m_DebugVRAMDirty[i] = 0;
+    }
+
+    bool refresh = m_bDebugVRAMRefresh;
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+    m_bDebugVRAMRefresh = false;
+#endif
+    return refresh;
 }
 
 bool Video::Tick(unsigned int clockCycles)
@@ -284,7 +371,16 @@ void Video::WriteData(u8 data)
     m_bFirstByteInSequence = true;
     TraceVDPEvent(TRACE_VDP_DATA_WRITE, 0xFF, data);
     m_VdpBuffer = data;
-    m_pVdpVRAM[m_VdpAddress] = data;
+
+    // Games often upload the same tables every frame, only real changes invalidate lines
+    if (m_pVdpVRAM[m_VdpAddress] != data)
+    {
+        m_pVdpVRAM[m_VdpAddress] = data;
+        MarkVRAMWrite(m_VdpAddress);
+#if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
+        m_DebugVRAMDirty[m_VdpAddress >> 8] |= 1u << ((m_VdpAddress >> 3) & 0x1F);
+#endif
+    }
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
     m_pProcessor->CheckMemoryBreakpoints(Processor::GC_BREAKPOINT_TYPE_VRAM, m_VdpAddress, false);
 #endif
@@ -316,8 +412,16 @@ void Video::WriteControl(u8 control)
             {
                 bool old_nmi = IsSetBit(m_VdpRegister[1], 5);
                 u8 masks[8] = { 0x03, 0xFB, 0x0F, 0xFF, 0x07, 0x7F, 0x07, 0xFF };
+                // Bits that change the rendered image, the rest leave cached lines valid
+                u8 render_masks[8] = { 0x02, 0x5B, 0x0F, 0xFF, 0x07, 0x7F, 0x07, 0xFF };
                 u8 reg = control & 0x07;
+                u8 old_value = m_VdpRegister[reg];
                 m_VdpRegister[reg] = m_VdpBuffer & masks[reg];
+                if ((old_value ^ m_VdpRegister[reg]) & render_masks[reg])
+                {
+                    InvalidateLineCache();
+                    InvalidateDebugVRAM();
+                }
                 if (reg < 2)
                 {
                     m_iMode = ((m_VdpRegister[1] & 0x08) >> 1) | (m_VdpRegister[0] & 0x02) |
@@ -377,14 +481,38 @@ bool Video::GetLatch()
 
 void Video::ScanLine(int line)
 {
+    // Skipped frames only keep the sprite status bits, the frame buffer holds the last drawn image
+    if (m_bSkipRender)
+    {
+        if (m_bDisplayEnabled && (line < GC_RESOLUTION_HEIGHT) && (m_iMode != 0x01))
+            EvaluateSprites(line);
+        return;
+    }
+
     if (m_bDisplayEnabled)
     {
         if (line < GC_RESOLUTION_HEIGHT)
         {
-            RenderBackground(line);
+            u64 line_bit = (u64)1 << (line & 63);
 
-            if (m_iMode != 0x01)
-                RenderSprites(line);
+            if (m_LineDirty[line >> 6] & line_bit)
+            {
+                m_iLineCacheMisses++;
+                m_LineDirty[line >> 6] &= ~line_bit;
+
+                RenderBackground(line);
+
+                if (m_iMode != 0x01)
+                    RenderSprites(line);
+            }
+            else
+            {
+                // Nothing this line depends on has changed, the frame buffer still holds it
+                m_iLineCacheHits++;
+
+                if (m_iMode != 0x01)
+                    EvaluateSprites(line);
+            }
         }
     }
     else
@@ -396,188 +524,480 @@ void Video::ScanLine(int line)
 
             for (int scx = 0; scx < GC_RESOLUTION_WIDTH; scx++)
             {
-                int pixel = line_width + scx;
-                m_pFrameBuffer[pixel] = color;
-                m_pInfoBuffer[pixel] = 0;
+                m_pFrameBuffer[line_width + scx] = color;
             }
+
+            MarkLinesDirty(line, 1);
         }
     }
+
+    if (IsValidPointer(m_pHostFrameBuffer) && (line < GC_RESOLUTION_HEIGHT))
+    {
+#if !defined(GEARCOLECO_DISABLE_PROFILER)
+        GC_Profile_Section section = m_pProfiler->Enter(PROFILE_PIXELS);
+        RenderHostLine(line);
+        m_pProfiler->Leave(section);
+#else
+        RenderHostLine(line);
+#endif
+    }
 }
 
-void Video::LatchSpriteAttributes()
+void Video::RenderHostLine(int line)
 {
-    u16 sprite_attribute_addr = (m_VdpRegister[5] & 0x7F) << 7;
+    const u16* src = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+    int offset = ((m_iHostOverscanV + line) * m_iHostWidth) + m_iHostOverscanH;
 
-    for (int i = 0; i < (GC_MAX_SPRITES * 4); i++)
-        m_SpriteAttribLatch[i] = m_pVdpVRAM[sprite_attribute_addr + i];
+    if (IsValidPointer(m_pHostPalette32))
+    {
+        u32* dst = reinterpret_cast<u32*>(m_pHostFrameBuffer) + offset;
+
+        for (int x = 0; x < GC_RESOLUTION_WIDTH; x++)
+            dst[x] = m_pHostPalette32[src[x]];
+    }
+    else
+    {
+        u16* dst = reinterpret_cast<u16*>(m_pHostFrameBuffer) + offset;
+
+        for (int x = 0; x < GC_RESOLUTION_WIDTH; x++)
+            dst[x] = m_pHostPalette16[src[x]];
+    }
+
+    m_iHostLines++;
 }
 
-void Video::RenderBackground(int line)
+void Video::BeginHostFrame(u8* pFrameBuffer, GC_Color_Format pixelFormat)
 {
-    int line_offset = line * GC_RESOLUTION_WIDTH;
+    m_pHostFrameBuffer = pFrameBuffer;
+    m_HostPixelFormat = pixelFormat;
+    m_iHostLines = 0;
 
-    int name_table_addr = m_VdpRegister[2] << 10;
-    int color_table_addr = m_VdpRegister[3] << 6;
-    int pattern_table_addr = m_VdpRegister[4] << 11;
-    int region_mask = ((m_VdpRegister[4] & 0x03) << 8) | 0xFF;
-    int color_mask = ((m_VdpRegister[3] & 0x7F) << 3) | 0x07;
-    int backdrop_color = m_VdpRegister[7] & 0x0F;
-    backdrop_color = (backdrop_color > 0) ? backdrop_color : 1;
+    if (!IsValidPointer(pFrameBuffer))
+        return;
 
-    int tile_y = line >> 3;
-    int tile_y_offset = line & 7;
-    int region = 0;
+    InitPointer(m_pHostPalette16);
+    InitPointer(m_pHostPalette32);
 
-    switch (m_iMode)
+    switch (pixelFormat)
     {
-        case 1:
-        {
-            int fg_color = (m_VdpRegister[7] >> 4) & 0x0F;
-            int bg_color = backdrop_color;
-            fg_color = (fg_color > 0) ? fg_color : backdrop_color;
+        case GC_PIXEL_RGB565:
+            m_pHostPalette16 = m_palette_565_rgb;
+            break;
+        case GC_PIXEL_RGB555:
+            m_pHostPalette16 = m_palette_555_rgb;
+            break;
+        case GC_PIXEL_BGR565:
+            m_pHostPalette16 = m_palette_565_bgr;
+            break;
+        case GC_PIXEL_BGR555:
+            m_pHostPalette16 = m_palette_555_bgr;
+            break;
+        case GC_PIXEL_BGRA8888:
+            m_pHostPalette32 = m_palette_8888_bgra;
+            break;
+        default:
+            m_pHostPalette32 = m_palette_8888_rgba;
+            break;
+    }
 
-            for (int i = 0; i < 8; i++)
-            {
-                int pixel = line_offset + i;
-                m_pFrameBuffer[pixel] = bg_color;
-                m_pFrameBuffer[pixel + 248] = bg_color;
-                m_pInfoBuffer[pixel] = 0x00;
-                m_pInfoBuffer[pixel + 248] = 0x00;
-            }
+    m_iHostOverscanH = 0;
+    m_iHostOverscanV = 0;
+    m_iHostWidth = GC_RESOLUTION_WIDTH;
 
-            for (int tile_x = 0; tile_x < 40; tile_x++)
-            {
-                int tile_number = (tile_y * 40) + tile_x;
-                int name_tile_addr = name_table_addr + tile_number;
-                int name_tile = m_pVdpVRAM[name_tile_addr];
-                u8 pattern_line = m_pVdpVRAM[pattern_table_addr + (name_tile << 3) + tile_y_offset];
+    if (m_Overscan != OverscanDisabled)
+        m_iHostOverscanV = m_bPAL ? GC_RESOLUTION_OVERSCAN_V_PAL : GC_RESOLUTION_OVERSCAN_V;
 
-                int screen_offset = line_offset + (tile_x * 6) + 8;
+    if (m_Overscan == OverscanFull320)
+    {
+        m_iHostOverscanH = GC_RESOLUTION_SMS_OVERSCAN_H_320_L;
+        m_iHostWidth = GC_RESOLUTION_WIDTH + GC_RESOLUTION_SMS_OVERSCAN_H_320_L + GC_RESOLUTION_SMS_OVERSCAN_H_320_R;
+    }
+    else if (m_Overscan == OverscanFull284)
+    {
+        m_iHostOverscanH = GC_RESOLUTION_SMS_OVERSCAN_H_284_L;
+        m_iHostWidth = GC_RESOLUTION_WIDTH + GC_RESOLUTION_SMS_OVERSCAN_H_284_L + GC_RESOLUTION_SMS_OVERSCAN_H_284_R;
+    }
 
-                for (int tile_pixel = 0; tile_pixel < 6; tile_pixel++)
-                {
-                    int pixel = screen_offset + tile_pixel;
-                    m_pFrameBuffer[pixel] = IsSetBit(pattern_line, 7 - tile_pixel) ? fg_color : bg_color;
-                    m_pInfoBuffer[pixel] = 0x00;
-                }
-            }
-            return;
-        }
-        case 2:
+    m_iHostHeight = GC_RESOLUTION_HEIGHT + (m_iHostOverscanV * 2);
+}
+
+bool Video::EndHostFrame(u8* pFrameBuffer)
+{
+    bool complete = IsValidPointer(m_pHostFrameBuffer) && (m_pHostFrameBuffer == pFrameBuffer) &&
+                    (m_iHostLines == GC_RESOLUTION_HEIGHT);
+
+    InitPointer(m_pHostFrameBuffer);
+
+    // A partial frame (debugger break, palette or overscan change) needs a full conversion
+    if (!complete)
+        return false;
+
+    if ((m_iHostOverscanH == 0) && (m_iHostOverscanV == 0))
+        return true;
+
+    int color = m_VdpRegister[7] & 0x0F;
+    int right_start = m_iHostOverscanH + GC_RESOLUTION_WIDTH;
+    int right_width = m_iHostWidth - right_start;
+    int bottom_start = m_iHostOverscanV + GC_RESOLUTION_HEIGHT;
+
+    if (IsValidPointer(m_pHostPalette32))
+    {
+        u32* dst = reinterpret_cast<u32*>(pFrameBuffer);
+        u32 fill = m_pHostPalette32[color];
+
+        std::fill(dst, dst + (m_iHostOverscanV * m_iHostWidth), fill);
+        std::fill(dst + (bottom_start * m_iHostWidth), dst + (m_iHostHeight * m_iHostWidth), fill);
+
+        for (int y = m_iHostOverscanV; y < bottom_start; y++)
         {
-            pattern_table_addr &= 0x2000;
-            color_table_addr &= 0x2000;
-            region = (tile_y & 0x18) << 5;
-            break;
+            u32* row = dst + (y * m_iHostWidth);
+            std::fill(row, row + m_iHostOverscanH, fill);
+            std::fill(row + right_start, row + right_start + right_width, fill);
         }
-        case 4:
+    }
+    else
+    {
+        u16* dst = reinterpret_cast<u16*>(pFrameBuffer);
+        u16 fill = m_pHostPalette16[color];
+
+        std::fill(dst, dst + (m_iHostOverscanV * m_iHostWidth), fill);
+        std::fill(dst + (bottom_start * m_iHostWidth), dst + (m_iHostHeight * m_iHostWidth), fill);
+
+        for (int y = m_iHostOverscanV; y < bottom_start; y++)
         {
-            pattern_table_addr &= 0x2000;
-            break;
+            u16* row = dst + (y * m_iHostWidth);
+            std::fill(row, row + m_iHostOverscanH, fill);
+            std::fill(row + right_start, row + right_start + right_width, fill);
         }
     }
 
-    for (int tile_x = 0; tile_x < 32; tile_x++)
+    return true;
+}
+
+void Video::LatchSpriteAttributes()
+{
+    u16 sprite_attribute_addr = (m_VdpRegister[5] & 0x7F) << 7;
+    u8* sprite_attributes = &m_pVdpVRAM[sprite_attribute_addr];
+
+    // The line lists only need rebuilding when the latched table changes
+    if (memcmp(m_SpriteAttribLatch, sprite_attributes, sizeof(m_SpriteAttribLatch)) != 0)
     {
-        int tile_number = (tile_y << 5) + tile_x;
-        int name_tile_addr = name_table_addr + tile_number;
-        int name_tile = m_pVdpVRAM[name_tile_addr];
-        u8 pattern_line = 0;
-        u8 color_line = 0;
+        MarkSpriteChanges(sprite_attributes);
+        memcpy(m_SpriteAttribLatch, sprite_attributes, sizeof(m_SpriteAttribLatch));
+        m_bSpriteLinesDirty = true;
+    }
+}
 
-        if (m_iMode == 4)
-        {
-            int offset_color = pattern_table_addr + (name_tile << 3) + ((tile_y & 0x03) << 1) + (line & 0x04 ? 1 : 0);
-            color_line = m_pVdpVRAM[offset_color];
+// Lines covered by a changed sprite before or after the change have to be drawn again
+void Video::MarkSpriteChanges(const u8* sprite_attributes)
+{
+    int sprite_size = IsSetBit(m_VdpRegister[1], 1) ? 16 : 8;
 
-            int left_color = color_line >> 4;
-            int right_color = color_line & 0x0F;
-            left_color = (left_color > 0) ? left_color : backdrop_color;
-            right_color = (right_color > 0) ? right_color : backdrop_color;
+    if (IsSetBit(m_VdpRegister[1], 0))
+        sprite_size *= 2;
 
-            int screen_offset = line_offset + (tile_x << 3);
+    bool old_done = false;
+    bool new_done = false;
 
-            for (int tile_pixel = 0; tile_pixel < 4; tile_pixel++)
-            {
-                int pixel = screen_offset + tile_pixel;
-                m_pFrameBuffer[pixel] = left_color;
-                m_pInfoBuffer[pixel] = 0x00;
-            }
+    for (int sprite = 0; sprite < GC_MAX_SPRITES; sprite++)
+    {
+        const u8* old_attributes = &m_SpriteAttribLatch[sprite << 2];
+        const u8* new_attributes = &sprite_attributes[sprite << 2];
 
-            for (int tile_pixel = 4; tile_pixel < 8; tile_pixel++)
-            {
-                int pixel = screen_offset + tile_pixel;
-                m_pFrameBuffer[pixel] = right_color;
-                m_pInfoBuffer[pixel] = 0x00;
-            }
+        old_done = old_done || (old_attributes[0] == 0xD0);
+        new_done = new_done || (new_attributes[0] == 0xD0);
 
+        if (old_done && new_done)
+            break;
+
+        if ((old_done == new_done) && (memcmp(old_attributes, new_attributes, 4) == 0))
             continue;
-        }
-        else if (m_iMode == 0)
-        {
-            pattern_line = m_pVdpVRAM[pattern_table_addr + (name_tile << 3) + tile_y_offset];
-            color_line = m_pVdpVRAM[color_table_addr + (name_tile >> 3)];
-        }
-        else if (m_iMode == 2)
-        {
-            name_tile += region;
-            pattern_line = m_pVdpVRAM[pattern_table_addr + ((name_tile & region_mask) << 3) + tile_y_offset];
-            color_line = m_pVdpVRAM[color_table_addr + ((name_tile & color_mask) << 3) + tile_y_offset];
-        }
 
-        int fg_color = color_line >> 4;
-        int bg_color = color_line & 0x0F;
-        fg_color = (fg_color > 0) ? fg_color : backdrop_color;
-        bg_color = (bg_color > 0) ? bg_color : backdrop_color;
+        if (!old_done)
+            MarkSpriteRangeDirty(old_attributes[0], sprite_size);
+        if (!new_done)
+            MarkSpriteRangeDirty(new_attributes[0], sprite_size);
+    }
+}
 
-        int screen_offset = line_offset + (tile_x << 3);
+void Video::MarkSpriteRangeDirty(u8 attribute_y, int sprite_size)
+{
+    int sprite_y = (attribute_y + 1) & 0xFF;
 
-        for (int tile_pixel = 0; tile_pixel < 8; tile_pixel++)
-        {
-            int pixel = screen_offset + tile_pixel;
-            m_pFrameBuffer[pixel] = IsSetBit(pattern_line, 7 - tile_pixel) ? fg_color : bg_color;
-            m_pInfoBuffer[pixel] = 0x00;
-        }
+    if (sprite_y >= 0xE0)
+        sprite_y = -(0x100 - sprite_y);
+
+    int first_line = MAX(sprite_y, 0);
+    int last_line = MIN(sprite_y + sprite_size, GC_RESOLUTION_HEIGHT);
+
+    if (last_line > first_line)
+        MarkLinesDirty(first_line, last_line - first_line);
+}
+
+void Video::MarkSpriteLinesDirty()
+{
+    if (m_bSpriteLinesDirty || (m_SpriteLinesReg1 != (m_VdpRegister[1] & 0x03)) || (m_SpriteLinesReg6 != m_VdpRegister[6]))
+        UpdateSpriteLines();
+
+    m_LineDirty[0] |= m_SpriteLineMask[0];
+    m_LineDirty[1] |= m_SpriteLineMask[1];
+    m_LineDirty[2] |= m_SpriteLineMask[2];
+}
+
+void Video::MarkVRAMWrite(u16 address)
+{
+    int name_offset = address - (m_VdpRegister[2] << 10);
+    int pattern_offset = address - (m_VdpRegister[4] << 11);
+    int pattern_offset_g2 = address - ((m_VdpRegister[4] << 11) & 0x2000);
+    int color_offset = address - (m_VdpRegister[3] << 6);
+    int color_offset_g2 = address - ((m_VdpRegister[3] << 6) & 0x2000);
+
+    switch (m_iMode)
+    {
+        case 0:
+            if ((name_offset >= 0) && (name_offset < 768))
+                MarkLinesDirty((name_offset >> 5) << 3, 8);
+            if ((pattern_offset >= 0) && (pattern_offset < 0x800))
+                MarkTileLinesDirty(pattern_offset & 7);
+            if ((color_offset >= 0) && (color_offset < 32))
+                InvalidateLineCache();
+            break;
+        case 1:
+            if ((name_offset >= 0) && (name_offset < 960))
+                MarkLinesDirty((name_offset / 40) << 3, 8);
+            if ((pattern_offset >= 0) && (pattern_offset < 0x800))
+                MarkTileLinesDirty(pattern_offset & 7);
+            break;
+        case 2:
+            if ((name_offset >= 0) && (name_offset < 768))
+                MarkLinesDirty((name_offset >> 5) << 3, 8);
+            if ((pattern_offset_g2 >= 0) && (pattern_offset_g2 < 0x1800))
+                MarkTileLinesDirty(pattern_offset_g2 & 7);
+            if ((color_offset_g2 >= 0) && (color_offset_g2 < 0x1800))
+                MarkTileLinesDirty(color_offset_g2 & 7);
+            break;
+        case 4:
+            if ((name_offset >= 0) && (name_offset < 768))
+                MarkLinesDirty((name_offset >> 5) << 3, 8);
+            if ((pattern_offset_g2 >= 0) && (pattern_offset_g2 < 0x800))
+                InvalidateLineCache();
+            break;
+        default:
+            break;
     }
+
+    int sprite_pattern_offset = address - ((m_VdpRegister[6] & 0x07) << 11);
+
+    if ((m_iMode != 0x01) && (sprite_pattern_offset >= 0) && (sprite_pattern_offset < 0x800))
+        MarkSpriteLinesDirty();
 }
 
-void Video::RenderSprites(int line)
+void Video::UpdateSpriteLines()
 {
-    int sprite_count = 0;
-    int line_width = line * GC_RESOLUTION_WIDTH;
-    int sprite_size = IsSetBit(m_VdpRegister[1], 1) ? 16 : 8;
-    bool sprite_zoom = IsSetBit(m_VdpRegister[1], 0);
+    m_bSpriteLinesDirty = false;
+    m_SpriteLinesReg1 = m_VdpRegister[1] & 0x03;
+    m_SpriteLinesReg6 = m_VdpRegister[6];
 
-    if (sprite_zoom)
+    bool sprite_16 = IsSetBit(m_VdpRegister[1], 1);
+    int sprite_size = sprite_16 ? 16 : 8;
+
+    if (IsSetBit(m_VdpRegister[1], 0))
         sprite_size *= 2;
 
     u16 sprite_pattern_addr = (m_VdpRegister[6] & 0x07) << 11;
 
-    int max_sprite = GC_MAX_SPRITES - 1;
+    memset(m_SpriteLineCount, 0, sizeof(m_SpriteLineCount));
+    memset(m_SpriteLineMask, 0, sizeof(m_SpriteLineMask));
 
-    for (int sprite = 0; sprite <= max_sprite; sprite++)
+    for (int sprite = 0; sprite < GC_MAX_SPRITES; sprite++)
     {
-        int o = sprite << 2;
+        int attrib_i = sprite << 2;
+
+        if (m_SpriteAttribLatch[attrib_i] == 0xD0)
+            break;
+
+        int sprite_y = (m_SpriteAttribLatch[attrib_i] + 1) & 0xFF;
+
+        if (sprite_y >= 0xE0)
+            sprite_y = -(0x100 - sprite_y);
+
+        int sprite_shift = (m_SpriteAttribLatch[attrib_i + 3] & 0x80) ? 32 : 0;
+        int sprite_tile = m_SpriteAttribLatch[attrib_i + 2];
+        sprite_tile &= sprite_16 ? 0xFC : 0xFF;
+
+        SpriteEntry* entry = &m_Sprites[sprite];
+        entry->x = m_SpriteAttribLatch[attrib_i + 1] - sprite_shift;
+        entry->y = sprite_y;
+        entry->pattern_addr = sprite_pattern_addr + (sprite_tile << 3);
+        entry->color = m_SpriteAttribLatch[attrib_i + 3] & 0x0F;
+
+        int first_line = MAX(sprite_y, 0);
+        int last_line = MIN(sprite_y + sprite_size, GC_RESOLUTION_HEIGHT);
 
-        if (m_SpriteAttribLatch[o] == 0xD0)
+        for (int line = first_line; line < last_line; line++)
+        {
+            m_SpriteLines[line][m_SpriteLineCount[line]++] = (u8)sprite;
+            m_SpriteLineMask[line >> 6] |= (u64)1 << (line & 63);
+        }
+    }
+}
+
+void Video::RenderBackground(int line)
+{
+    switch (m_iMode)
+    {
+        case 0:
+            RenderBackgroundGraphics1(line);
+            break;
+        case 1:
+            RenderBackgroundText(line);
+            break;
+        case 2:
+            RenderBackgroundGraphics2(line);
+            break;
+        case 4:
+            RenderBackgroundMulticolor(line);
+            break;
+        default:
         {
-            max_sprite = sprite - 1;
+            // Undefined mode combinations show the backdrop
+            u16 backdrop_color = GetBackdropColor();
+            u16* frame_buffer = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+
+            for (int tile_x = 0; tile_x < 32; tile_x++)
+                RenderPattern(frame_buffer + (tile_x << 3), 0x00, backdrop_color, backdrop_color);
             break;
         }
     }
+}
 
-    for (int sprite = 0; sprite <= max_sprite; sprite++)
+void Video::RenderBackgroundGraphics1(int line)
+{
+    u16* frame_buffer = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+    int name_table_addr = (m_VdpRegister[2] << 10) + ((line >> 3) << 5);
+    int color_table_addr = m_VdpRegister[3] << 6;
+    int pattern_table_addr = (m_VdpRegister[4] << 11) + (line & 7);
+    u16 backdrop_color = GetBackdropColor();
+
+    for (int tile_x = 0; tile_x < 32; tile_x++)
     {
-        int attrib_i = sprite << 2;
-        int sprite_y = (m_SpriteAttribLatch[attrib_i] + 1) & 0xFF;
+        int name_tile = m_pVdpVRAM[name_table_addr + tile_x];
+        u8 pattern_line = m_pVdpVRAM[pattern_table_addr + (name_tile << 3)];
+        u8 color_line = m_pVdpVRAM[color_table_addr + (name_tile >> 3)];
+        u16 fg_color = color_line >> 4;
+        u16 bg_color = color_line & 0x0F;
+        fg_color = (fg_color > 0) ? fg_color : backdrop_color;
+        bg_color = (bg_color > 0) ? bg_color : backdrop_color;
 
-        if (sprite_y >= 0xE0)
-            sprite_y = -(0x100 - sprite_y);
+        RenderPattern(frame_buffer + (tile_x << 3), pattern_line, fg_color, bg_color);
+    }
+}
 
-        if ((sprite_y > line) || ((sprite_y + sprite_size) <= line))
-            continue;
+void Video::RenderBackgroundGraphics2(int line)
+{
+    u16* frame_buffer = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+    int tile_y = line >> 3;
+    int tile_y_offset = line & 7;
+    int name_table_addr = (m_VdpRegister[2] << 10) + (tile_y << 5);
+    int color_table_addr = ((m_VdpRegister[3] << 6) & 0x2000) + tile_y_offset;
+    int pattern_table_addr = ((m_VdpRegister[4] << 11) & 0x2000) + tile_y_offset;
+    int region_mask = ((m_VdpRegister[4] & 0x03) << 8) | 0xFF;
+    int color_mask = ((m_VdpRegister[3] & 0x7F) << 3) | 0x07;
+    int region = (tile_y & 0x18) << 5;
+    u16 backdrop_color = GetBackdropColor();
+
+    for (int tile_x = 0; tile_x < 32; tile_x++)
+    {
+        int name_tile = m_pVdpVRAM[name_table_addr + tile_x] + region;
+        u8 pattern_line = m_pVdpVRAM[pattern_table_addr + ((name_tile & region_mask) << 3)];
+        u8 color_line = m_pVdpVRAM[color_table_addr + ((name_tile & color_mask) << 3)];
+        u16 fg_color = color_line >> 4;
+        u16 bg_color = color_line & 0x0F;
+        fg_color = (fg_color > 0) ? fg_color : backdrop_color;
+        bg_color = (bg_color > 0) ? bg_color : backdrop_color;
+
+        RenderPattern(frame_buffer + (tile_x << 3), pattern_line, fg_color, bg_color);
+    }
+}
+
+void Video::RenderBackgroundText(int line)
+{
+    u16* frame_buffer = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+    int name_table_addr = (m_VdpRegister[2] << 10) + ((line >> 3) * 40);
+    int pattern_table_addr = (m_VdpRegister[4] << 11) + (line & 7);
+    u16 bg_color = GetBackdropColor();
+    u16 fg_color = (m_VdpRegister[7] >> 4) & 0x0F;
+    fg_color = (fg_color > 0) ? fg_color : bg_color;
+
+    // Tiles are 6 pixels wide, each 8 pixel store spills into the next
+    // tile or the right border, which are both written afterwards
+    for (int tile_x = 0; tile_x < 40; tile_x++)
+    {
+        int name_tile = m_pVdpVRAM[name_table_addr + tile_x];
+        u8 pattern_line = m_pVdpVRAM[pattern_table_addr + (name_tile << 3)];
+
+        RenderPattern(frame_buffer + (tile_x * 6) + 8, pattern_line, fg_color, bg_color);
+    }
+
+    RenderPattern(frame_buffer, 0x00, fg_color, bg_color);
+    RenderPattern(frame_buffer + 248, 0x00, fg_color, bg_color);
+}
+
+void Video::RenderBackgroundMulticolor(int line)
+{
+    u16* frame_buffer = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+    int tile_y = line >> 3;
+    int name_table_addr = (m_VdpRegister[2] << 10) + (tile_y << 5);
+    int pattern_table_addr = ((m_VdpRegister[4] << 11) & 0x2000) + ((tile_y & 0x03) << 1) + ((line & 0x04) ? 1 : 0);
+    u16 backdrop_color = GetBackdropColor();
+
+    for (int tile_x = 0; tile_x < 32; tile_x++)
+    {
+        int name_tile = m_pVdpVRAM[name_table_addr + tile_x];
+        u8 color_line = m_pVdpVRAM[pattern_table_addr + (name_tile << 3)];
+        u16 left_color = color_line >> 4;
+        u16 right_color = color_line & 0x0F;
+        left_color = (left_color > 0) ? left_color : backdrop_color;
+        right_color = (right_color > 0) ? right_color : backdrop_color;
+
+        RenderPattern(frame_buffer + (tile_x << 3), 0xF0, left_color, right_color);
+    }
+}
+
+void Video::RenderSprites(int line)
+{
+    ProcessSprites<true>(line);
+}
+
+void Video::EvaluateSprites(int line)
+{
+    ProcessSprites<false>(line);
+}
+
+// Priority and collisions are resolved with one occupancy bit per pixel, leftmost pixel in the MSB
+template <bool render>
+void Video::ProcessSprites(int line)
+{
+    if (m_bSpriteLinesDirty || (m_SpriteLinesReg1 != (m_VdpRegister[1] & 0x03)) || (m_SpriteLinesReg6 != m_VdpRegister[6]))
+        UpdateSpriteLines();
+
+    int line_count = m_SpriteLineCount[line];
 
-        sprite_count++;
+    if (line_count == 0)
+        return;
+
+    u16* frame_buffer = &m_pFrameBuffer[line * GC_RESOLUTION_WIDTH];
+    bool sprite_large = IsSetBit(m_VdpRegister[1], 1);
+    bool sprite_zoom = IsSetBit(m_VdpRegister[1], 0);
+
+    // The last word stays clear so reads past the right edge see no sprites
+    u64 line_mask[5] = { 0, 0, 0, 0, 0 };
+
+    for (int i = 0; i < line_count; i++)
+    {
+        int sprite = m_SpriteLines[line][i];
+        const SpriteEntry* entry = &m_Sprites[sprite];
+        int sprite_count = i + 1;
 
         if (!IsSetBit(m_VdpStatus, 6) && (sprite_count > 4))
         {
@@ -586,71 +1006,90 @@ void Video::RenderSprites(int line)
             m_VdpStatus = (m_VdpStatus & 0xE0) | sprite;
         }
 
-        int sprite_color = m_SpriteAttribLatch[attrib_i + 3] & 0x0F;
+        // Past the fifth sprite nothing else is drawn or collides
+        if ((sprite_count > 4) && !m_bNoSpriteLimit)
+            break;
+
+        u16 sprite_color = entry->color;
 
         if (sprite_color == 0)
             continue;
 
-        int sprite_shift = (m_SpriteAttribLatch[attrib_i + 3] & 0x80) ? 32 : 0;
-        int sprite_x = m_SpriteAttribLatch[attrib_i + 1] - sprite_shift;
+        int sprite_line_addr = entry->pattern_addr + ((line - entry->y) >> (sprite_zoom ? 1 : 0));
+        u32 row = m_pVdpVRAM[sprite_line_addr] << 8;
 
-        if (sprite_x >= GC_RESOLUTION_WIDTH)
-            continue;
+        if (sprite_large)
+            row |= m_pVdpVRAM[sprite_line_addr + 16];
 
-        int sprite_tile = m_SpriteAttribLatch[attrib_i + 2];
-        sprite_tile &= IsSetBit(m_VdpRegister[1], 1) ? 0xFC : 0xFF;
+        if (sprite_zoom)
+        {
+            // Double every bit, 16 pattern bits become 32 pixels
+            row = (row | (row << 8)) & 0x00FF00FF;
+            row = (row | (row << 4)) & 0x0F0F0F0F;
+            row = (row | (row << 2)) & 0x33333333;
+            row = (row | (row << 1)) & 0x55555555;
+            row |= row << 1;
+        }
+        else
+            row <<= 16;
 
-        int sprite_line_addr = sprite_pattern_addr + (sprite_tile << 3) +
-                               ((line - sprite_y) >> (sprite_zoom ? 1 : 0));
+        u64 mask = static_cast<u64>(row) << 32;
+        int x = entry->x;
 
-        for (int tile_x = 0; tile_x < sprite_size; tile_x++)
+        if (x < 0)
         {
-            int sprite_pixel_x = sprite_x + tile_x;
+            mask <<= -x;
+            x = 0;
+        }
 
-            if (sprite_pixel_x >= GC_RESOLUTION_WIDTH)
-                break;
-            if (sprite_pixel_x < 0)
-                continue;
+        if ((mask == 0) || (x >= GC_RESOLUTION_WIDTH))
+            continue;
 
-            int pixel = line_width + sprite_pixel_x;
+        int word = x >> 6;
+        int shift = x & 63;
+        u64 occupied = line_mask[word] << shift;
 
-            bool sprite_pixel = false;
+        if (shift > 0)
+            occupied |= line_mask[word + 1] >> (64 - shift);
 
-            int tile_x_adjusted = tile_x >> (sprite_zoom ? 1 : 0);
+        u64 hit = mask & occupied;
 
-            if (tile_x_adjusted < 8)
-                sprite_pixel = IsSetBit(m_pVdpVRAM[sprite_line_addr], 7 - tile_x_adjusted);
-            else
-                sprite_pixel = IsSetBit(m_pVdpVRAM[sprite_line_addr + 16], 15 - tile_x_adjusted);
+        if ((hit != 0) && !IsSetBit(m_VdpStatus, 5))
+        {
+            int hit_x = x;
 
-            if (sprite_pixel && ((sprite_count < 5) || m_bNoSpriteLimit))
+            while (!(hit & 0x8000000000000000ULL))
             {
-                if (!IsSetBit(m_pInfoBuffer[pixel], 0) && (sprite_color > 0))
-                {
-                    m_pFrameBuffer[pixel] = sprite_color;
-                    m_pInfoBuffer[pixel] = SetBit(m_pInfoBuffer[pixel], 0);
-                }
+                hit <<= 1;
+                hit_x++;
+            }
 
-                if (IsSetBit(m_pInfoBuffer[pixel], 1))
-                {
-                    if (!IsSetBit(m_VdpStatus, 5))
-                    {
-                        TraceVDPEvent(TRACE_VDP_SPRITE_COLLISION, 0xFF, 0,
-                            sprite, sprite_pixel_x);
-                        m_VdpStatus = SetBit(m_VdpStatus, 5);
-                    }
-                }
-                else
-                {
-                    m_pInfoBuffer[pixel] = SetBit(m_pInfoBuffer[pixel], 1);
-                }
+            TraceVDPEvent(TRACE_VDP_SPRITE_COLLISION, 0xFF, 0, sprite, hit_x);
+            m_VdpStatus = SetBit(m_VdpStatus, 5);
+        }
+
+        if (render)
+        {
+            // Earlier sprites have priority over the pixels they already own
+            u64 visible = mask & ~occupied;
+            u16* dst = frame_buffer + x;
+            int width = GC_RESOLUTION_WIDTH - x;
+
+            for (int pixel = 0; (visible != 0) && (pixel < width); pixel++, visible <<= 1)
+            {
+                if (visible & 0x8000000000000000ULL)
+                    dst[pixel] = sprite_color;
             }
         }
+
+        line_mask[word] |= mask >> shift;
+
+        if ((shift > 0) && (word < 3))
+            line_mask[word + 1] |= mask << (64 - shift);
     }
 }
 
-
-void Video::Render32bit(u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan)
+void Video::Render32bit(const u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan)
 {
     int x = 0;
     int y = 0;
@@ -719,7 +1158,7 @@ void Video::Render32bit(u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format
     }
 }
 
-void Video::Render16bit(u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan)
+void Video::Render16bit(const u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan)
 {
     int x = 0;
     int y = 0;
@@ -792,6 +1231,123 @@ void Video::Render16bit(u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format
     }
 }
 
+void Video::RenderIndexed(const u16* srcFrameBuffer, u8* dstFrameBuffer, int scale)
+{
+    if (scale == 1)
+    {
+        int size = GC_RESOLUTION_WIDTH * GC_RESOLUTION_HEIGHT;
+        int i = 0;
+
+        // Indices never go past 15, narrowing them to bytes cannot saturate
+#if defined(GC_VIDEO_SSE2)
+        for (; i <= (size - 16); i += 16)
+        {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcFrameBuffer + i));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcFrameBuffer + i + 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dstFrameBuffer + i), _mm_packus_epi16(lo, hi));
+        }
+#elif defined(GC_VIDEO_NEON)
+        for (; i <= (size - 16); i += 16)
+        {
+            uint8x8_t lo = vmovn_u16(vld1q_u16(srcFrameBuffer + i));
+            uint8x8_t hi = vmovn_u16(vld1q_u16(srcFrameBuffer + i + 8));
+            vst1q_u8(dstFrameBuffer + i, vcombine_u8(lo, hi));
+        }
+#endif
+        for (; i < size; i++)
+            dstFrameBuffer[i] = (u8)srcFrameBuffer[i];
+
+        return;
+    }
+
+    int width = GC_RESOLUTION_WIDTH / scale;
+    int height = GC_RESOLUTION_HEIGHT / scale;
+
+    // Indices cannot be blended, keep the top left pixel of every block
+    for (int y = 0; y < height; y++)
+    {
+        const u16* src = srcFrameBuffer + (y * scale * GC_RESOLUTION_WIDTH);
+        u8* dst = dstFrameBuffer + (y * width);
+
+#if defined(GC_VIDEO_SSE2)
+        if (scale == 2)
+        {
+            __m128i even = _mm_set1_epi32(0xFFFF);
+
+            for (int x = 0; x < width; x += 16)
+            {
+                const __m128i* s = reinterpret_cast<const __m128i*>(src + (x * 2));
+                __m128i a = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(s + 0), even), _mm_and_si128(_mm_loadu_si128(s + 1), even));
+                __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(s + 2), even), _mm_and_si128(_mm_loadu_si128(s + 3), even));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+            }
+            continue;
+        }
+#elif defined(GC_VIDEO_NEON)
+        if (scale == 2)
+        {
+            for (int x = 0; x < width; x += 16)
+            {
+                uint16x8x2_t a = vld2q_u16(src + (x * 2));
+                uint16x8x2_t b = vld2q_u16(src + (x * 2) + 16);
+                vst1q_u8(dst + x, vcombine_u8(vmovn_u16(a.val[0]), vmovn_u16(b.val[0])));
+            }
+            continue;
+        }
+#endif
+        for (int x = 0; x < width; x++)
+            dst[x] = (u8)src[x * scale];
+    }
+}
+
+void Video::RenderGreyscale(const u16* srcFrameBuffer, u8* dstFrameBuffer, int scale)
+{
+    int width = GC_RESOLUTION_WIDTH / scale;
+    int height = GC_RESOLUTION_HEIGHT / scale;
+    int shift = (scale == 4) ? 4 : ((scale == 2) ? 2 : 0);
+    int round = (1 << shift) >> 1;
+    u16 columns[GC_RESOLUTION_WIDTH];
+
+    // Box filter: the block rows are summed per column first, then across
+    for (int y = 0; y < height; y++)
+    {
+        const u16* src = srcFrameBuffer + (y * scale * GC_RESOLUTION_WIDTH);
+        u8* dst = dstFrameBuffer + (y * width);
+
+        if (scale == 1)
+        {
+            for (int x = 0; x < GC_RESOLUTION_WIDTH; x++)
+                dst[x] = m_palette_luma[src[x]];
+            continue;
+        }
+
+        for (int x = 0; x < GC_RESOLUTION_WIDTH; x++)
+            columns[x] = m_palette_luma[src[x]];
+
+        for (int row = 1; row < scale; row++)
+        {
+            const u16* next = src + (row * GC_RESOLUTION_WIDTH);
+
+            for (int x = 0; x < GC_RESOLUTION_WIDTH; x++)
+                columns[x] += m_palette_luma[next[x]];
+        }
+
+        if (scale == 2)
+        {
+            for (int x = 0; x < width; x++)
+                dst[x] = (u8)((columns[x * 2] + columns[(x * 2) + 1] + round) >> shift);
+        }
+        else
+        {
+            for (int x = 0; x < width; x++)
+            {
+                const u16* c = &columns[x * 4];
+                dst[x] = (u8)((c[0] + c[1] + c[2] + c[3] + round) >> shift);
+            }
+        }
+    }
+}
+
 void Video::SetCustomPalette(GC_Color* palette)
 {
     for (int i = 0; i < 16; i++)
@@ -846,12 +1402,23 @@ void Video::InitPalettes()
         m_palette_555_rgb[i] = red_5 << 10 | green_5 << 5 | blue_5;
         m_palette_565_bgr[i] = blue_5 << 11 | green_6 << 5 | red_5;
         m_palette_555_bgr[i] = blue_5 << 10 | green_5 << 5 | red_5;
+
+        u8 rgba[4] = { red, green, blue, 0xFF };
+        u8 bgra[4] = { blue, green, red, 0xFF };
+        memcpy(&m_palette_8888_rgba[i], rgba, 4);
+        memcpy(&m_palette_8888_bgra[i], bgra, 4);
+
+        m_palette_luma[i] = (u8)(((red * 77) + (green * 150) + (blue * 29)) >> 8);
     }
+
+    InitPointer(m_pHostFrameBuffer);
+    InvalidateDebugVRAM();
 }
 
 void Video::SetOverscan(Overscan overscan)
 {
     m_Overscan = overscan;
+    InitPointer(m_pHostFrameBuffer);
 }
 
 Video::Overscan Video::GetOverscan()
@@ -859,42 +1426,78 @@ Video::Overscan Video::GetOverscan()
     return m_Overscan;
 }
 
-void Video::SaveState(std::ostream& stream)
-{
-    stream.write(reinterpret_cast<const char*> (m_pInfoBuffer), GC_RESOLUTION_WIDTH * GC_LINES_PER_FRAME_PAL);
-    stream.write(reinterpret_cast<const char*> (m_pVdpVRAM), 0x4000);
-    stream.write(reinterpret_cast<const char*> (&m_bFirstByteInSequence), sizeof(m_bFirstByteInSequence));
-    stream.write(reinterpret_cast<const char*> (m_VdpRegister), sizeof(m_VdpRegister));
-    stream.write(reinterpret_cast<const char*> (&m_VdpBuffer), sizeof(m_VdpBuffer));
-    stream.write(reinterpret_cast<const char*> (&m_VdpAddress), sizeof(m_VdpAddress));
-    stream.write(reinterpret_cast<const char*> (&m_iCycleCounter), sizeof(m_iCycleCounter));
-    stream.write(reinterpret_cast<const char*> (&m_VdpStatus), sizeof(m_VdpStatus));
-    stream.write(reinterpret_cast<const char*> (&m_iLinesPerFrame), sizeof(m_iLinesPerFrame));
-    stream.write(reinterpret_cast<const char*> (&m_LineEvents), sizeof(m_LineEvents));
-    stream.write(reinterpret_cast<const char*> (&m_iRenderLine), sizeof(m_iRenderLine));
-    stream.write(reinterpret_cast<const char*> (&m_bPAL), sizeof(m_bPAL));
-    stream.write(reinterpret_cast<const char*> (&m_iMode), sizeof(m_iMode));
-    stream.write(reinterpret_cast<const char*> (&m_Timing), sizeof(m_Timing));
-    stream.write(reinterpret_cast<const char*> (&m_bDisplayEnabled), sizeof(m_bDisplayEnabled));
-    stream.write(reinterpret_cast<const char*> (&m_bSpriteOvrRequest), sizeof(m_bSpriteOvrRequest));
-}
-
-void Video::LoadState(std::istream& stream)
-{
-    stream.read(reinterpret_cast<char*> (m_pInfoBuffer), GC_RESOLUTION_WIDTH * GC_LINES_PER_FRAME_PAL);
-    stream.read(reinterpret_cast<char*> (m_pVdpVRAM), 0x4000);
-    stream.read(reinterpret_cast<char*> (&m_bFirstByteInSequence), sizeof(m_bFirstByteInSequence));
-    stream.read(reinterpret_cast<char*> (m_VdpRegister), sizeof(m_VdpRegister));
-    stream.read(reinterpret_cast<char*> (&m_VdpBuffer), sizeof(m_VdpBuffer));
-    stream.read(reinterpret_cast<char*> (&m_VdpAddress), sizeof(m_VdpAddress));
-    stream.read(reinterpret_cast<char*> (&m_iCycleCounter), sizeof(m_iCycleCounter));
-    stream.read(reinterpret_cast<char*> (&m_VdpStatus), sizeof(m_VdpStatus));
-    stream.read(reinterpret_cast<char*> (&m_iLinesPerFrame), sizeof(m_iLinesPerFrame));
-    stream.read(reinterpret_cast<char*> (&m_LineEvents), sizeof(m_LineEvents));
-    stream.read(reinterpret_cast<char*> (&m_iRenderLine), sizeof(m_iRenderLine));
-    stream.read(reinterpret_cast<char*> (&m_bPAL), sizeof(m_bPAL));
-    stream.read(reinterpret_cast<char*> (&m_iMode), sizeof(m_iMode));
-    stream.read(reinterpret_cast<char*> (&m_Timing), sizeof(m_Timing));
-    stream.read(reinterpret_cast<char*> (&m_bDisplayEnabled), sizeof(m_bDisplayEnabled));
-    stream.read(reinterpret_cast<char*> (&m_bSpriteOvrRequest), sizeof(m_bSpriteOvrRequest));
+// Mirrors the host settings that live outside savestates, touching the
+// palettes and line cache only when something actually changed
+void Video::CopySettings(Video* pSource)
+{
+    if (m_Overscan != pSource->m_Overscan)
+        SetOverscan(pSource->m_Overscan);
+
+    if (m_bNoSpriteLimit != pSource->m_bNoSpriteLimit)
+        SetNoSpriteLimit(pSource->m_bNoSpriteLimit);
+
+    bool custom = (pSource->m_pCurrentPalette == pSource->m_CustomPalette);
+    u8* palette = custom ? m_CustomPalette : pSource->m_pCurrentPalette;
+
+    if ((m_pCurrentPalette != palette) || (custom && (memcmp(m_CustomPalette, pSource->m_CustomPalette, sizeof(m_CustomPalette)) != 0)))
+    {
+        memcpy(m_CustomPalette, pSource->m_CustomPalette, sizeof(m_CustomPalette));
+        m_pCurrentPalette = palette;
+        InitPalettes();
+    }
+}
+
+void Video::SaveState(StateWriter& stream)
+{
+    stream.WriteBytes(m_pVdpVRAM, 0x4000);
+    stream.Write(m_bFirstByteInSequence);
+    stream.Write(m_VdpRegister);
+    stream.Write(m_VdpBuffer);
+    stream.Write(m_VdpAddress);
+    stream.Write(m_iCycleCounter);
+    stream.Write(m_VdpStatus);
+    stream.Write(m_iLinesPerFrame);
+    stream.Write(m_LineEvents);
+    stream.Write(m_iRenderLine);
+    stream.Write(m_bPAL);
+    stream.Write(m_iMode);
+    stream.Write(m_Timing);
+    stream.Write(m_bDisplayEnabled);
+    stream.Write(m_bSpriteOvrRequest);
+}
+
+size_t Video::GetStateSize()
+{
+    size_t size = 0x4000 + sizeof(m_bFirstByteInSequence) + sizeof(m_VdpRegister) + sizeof(m_VdpBuffer);
+    size += sizeof(m_VdpAddress) + sizeof(m_iCycleCounter) + sizeof(m_VdpStatus) + sizeof(m_iLinesPerFrame);
+    size += sizeof(m_LineEvents) + sizeof(m_iRenderLine) + sizeof(m_bPAL) + sizeof(m_iMode);
+    size += sizeof(m_Timing) + sizeof(m_bDisplayEnabled) + sizeof(m_bSpriteOvrRequest);
+    return size;
+}
+
+void Video::LoadState(StateReader& stream, int version)
+{
+    // Older states carry the per-pixel sprite info buffer
+    if (version < 107)
+        stream.Skip(GC_RESOLUTION_WIDTH * GC_LINES_PER_FRAME_PAL);
+
+    stream.ReadBytes(m_pVdpVRAM, 0x4000);
+    stream.Read(m_bFirstByteInSequence);
+    stream.Read(m_VdpRegister);
+    stream.Read(m_VdpBuffer);
+    stream.Read(m_VdpAddress);
+    stream.Read(m_iCycleCounter);
+    stream.Read(m_VdpStatus);
+    stream.Read(m_iLinesPerFrame);
+    stream.Read(m_LineEvents);
+    stream.Read(m_iRenderLine);
+    stream.Read(m_bPAL);
+    stream.Read(m_iMode);
+    stream.Read(m_Timing);
+    stream.Read(m_bDisplayEnabled);
+    stream.Read(m_bSpriteOvrRequest);
+
+    InitPointer(m_pHostFrameBuffer);
+    InvalidateLineCache();
+    InvalidateDebugVRAM();
 }
@@ -21,10 +21,22 @@
 #define	VIDEO_H
 
 #include "definitions.h"
+#include "state_serializer.h"
+
+#if !defined(GEARCOLECO_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define GC_VIDEO_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GC_VIDEO_NEON
+#endif
+#endif
 
 class Memory;
 class Processor;
 class TraceLogger;
+class Profiler;
 
 class Video
 {
@@ -43,23 +55,38 @@ public:
     void Init();
     void Reset(bool bPAL);
     bool Tick(unsigned int clockCycles);
+    unsigned int GetCyclesToNextEvent();
     u8 GetDataPort();
     u8 GetStatusFlags();
     void WriteData(u8 data);
     void WriteControl(u8 control);
-    void SaveState(std::ostream& stream);
-    void LoadState(std::istream& stream);
+    void SaveState(StateWriter& stream);
+    size_t GetStateSize();
+    void LoadState(StateReader& stream, int version);
     u8* GetVRAM();
     u8* GetRegisters();
     u16* GetFrameBuffer();
     int GetMode();
-    void Render32bit(u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan = false);
-    void Render16bit(u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan = false);
+    void Render32bit(const u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan = false);
+    void Render16bit(const u16* srcFrameBuffer, u8* dstFrameBuffer, GC_Color_Format pixelFormat, int size, bool overscan = false);
+    void RenderIndexed(const u16* srcFrameBuffer, u8* dstFrameBuffer, int scale = 1);
+    void RenderGreyscale(const u16* srcFrameBuffer, u8* dstFrameBuffer, int scale = 1);
+    void BeginHostFrame(u8* pFrameBuffer, GC_Color_Format pixelFormat);
+    bool EndHostFrame(u8* pFrameBuffer);
     void SetOverscan(Overscan overscan);
     Overscan GetOverscan();
     void SetCustomPalette(GC_Color* palette);
     void SetPredefinedPalette(int palette);
     void SetNoSpriteLimit(bool noSpriteLimit);
+    void CopySettings(Video* pSource);
+    void SetSkipRender(bool skip);
+    bool IsSkipRender();
+    void InvalidateLineCache();
+    u64 GetLineCacheHits();
+    u64 GetLineCacheMisses();
+    void ResetLineCacheCounters();
+    void InvalidateDebugVRAM();
+    bool TakeDebugVRAMChanges(u32* dirtyBlocks);
     bool IsPAL();
     u8 GetBufferReg();
     u16 GetAddressReg();
@@ -68,22 +95,39 @@ public:
     int GetCycleCounter();
     bool GetLatch();
     void SetTraceLogger(TraceLogger* pTraceLogger);
+    void SetProfiler(Profiler* pProfiler);
 
 private:
     INLINE void TraceVDPEvent(u8 event, u8 reg = 0xFF, u8 raw = 0,
         int sprite = 0xFF, int auxiliary = 0);
     void LogVDPEvent(u8 event, u8 reg, u8 raw, int sprite, int auxiliary);
     void ScanLine(int line);
+    void RenderHostLine(int line);
     void LatchSpriteAttributes();
+    void UpdateSpriteLines();
+    void EvaluateSprites(int line);
+    void MarkVRAMWrite(u16 address);
+    void MarkSpriteLinesDirty();
+    void MarkSpriteChanges(const u8* sprite_attributes);
+    void MarkSpriteRangeDirty(u8 attribute_y, int sprite_size);
+    INLINE void MarkLinesDirty(int first, int count);
+    INLINE void MarkTileLinesDirty(int tile_line);
     void RenderBackground(int line);
+    void RenderBackgroundGraphics1(int line);
+    void RenderBackgroundGraphics2(int line);
+    void RenderBackgroundText(int line);
+    void RenderBackgroundMulticolor(int line);
+    INLINE void RenderPattern(u16* dst, u8 pattern, u16 fg_color, u16 bg_color);
+    INLINE u16 GetBackdropColor();
     void RenderSprites(int line);
+    template <bool render> void ProcessSprites(int line);
     void InitPalettes();
 
 private:
     Memory* m_pMemory;
     Processor* m_pProcessor;
     TraceLogger* m_pTraceLogger;
-    u8* m_pInfoBuffer;
+    Profiler* m_pProfiler;
     u16* m_pFrameBuffer;
     u8* m_pVdpVRAM;
     bool m_bFirstByteInSequence;
@@ -99,6 +143,21 @@ private:
     u8 m_SpriteAttribLatch[GC_MAX_SPRITES * 4];
     Overscan m_Overscan;
 
+    struct SpriteEntry
+    {
+        int x;
+        int y;
+        u16 pattern_addr;
+        u8 color;
+    };
+
+    SpriteEntry m_Sprites[GC_MAX_SPRITES];
+    u8 m_SpriteLines[GC_RESOLUTION_HEIGHT][GC_MAX_SPRITES];
+    u8 m_SpriteLineCount[GC_RESOLUTION_HEIGHT];
+    bool m_bSpriteLinesDirty;
+    u8 m_SpriteLinesReg1;
+    u8 m_SpriteLinesReg6;
+
     struct LineEvents 
     {
         bool vint;
@@ -119,14 +178,38 @@ private:
     bool m_bDisplayEnabled;
     bool m_bSpriteOvrRequest;
     bool m_bNoSpriteLimit;
+    bool m_bSkipRender;
+    u64 m_LineDirty[3];
+    u64 m_SpriteLineMask[3];
+    u64 m_iLineCacheHits;
+    u64 m_iLineCacheMisses;
+    // One bit per 8 byte block of VRAM written since the debug viewers last looked
+    u32 m_DebugVRAMDirty[64];
+    bool m_bDebugVRAMRefresh;
 
     u16 m_palette_565_rgb[16];
     u16 m_palette_555_rgb[16];
     u16 m_palette_565_bgr[16];
     u16 m_palette_555_bgr[16];
+    u32 m_palette_8888_rgba[16];
+    u32 m_palette_8888_bgra[16];
+    u8 m_palette_luma[16];
+
+    u8* m_pHostFrameBuffer;
+    GC_Color_Format m_HostPixelFormat;
+    const u16* m_pHostPalette16;
+    const u32* m_pHostPalette32;
+    int m_iHostLines;
+    int m_iHostWidth;
+    int m_iHostHeight;
+    int m_iHostOverscanH;
+    int m_iHostOverscanV;
 
     u8 m_CustomPalette[48];
     u8* m_pCurrentPalette;
+
+    // One 0xFFFF lane per set bit, most significant bit first
+    u16 m_PatternMask[256][8];
 };
 
 #include "TraceLogger.h"
@@ -137,6 +220,52 @@ INLINE void Video::TraceVDPEvent(u8 event, u8 reg, u8 raw, int sprite, int auxil
         LogVDPEvent(event, reg, raw, sprite, auxiliary);
 }
 
+INLINE void Video::MarkLinesDirty(int first, int count)
+{
+    for (int line = first; line < (first + count); line++)
+        m_LineDirty[line >> 6] |= (u64)1 << (line & 63);
+}
+
+// Marks every line that fetches the given row of its 8x8 tiles
+INLINE void Video::MarkTileLinesDirty(int tile_line)
+{
+    u64 mask = 0x0101010101010101ULL << tile_line;
+    m_LineDirty[0] |= mask;
+    m_LineDirty[1] |= mask;
+    m_LineDirty[2] |= mask;
+}
+
+// Expands 8 pattern bits into 8 pixels, fg where the bit is set and bg elsewhere
+INLINE void Video::RenderPattern(u16* dst, u8 pattern, u16 fg_color, u16 bg_color)
+{
+    const u16* mask = m_PatternMask[pattern];
+
+#if defined(GC_VIDEO_SSE2)
+    __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+    __m128i bg = _mm_set1_epi16((short)bg_color);
+    __m128i diff = _mm_set1_epi16((short)(fg_color ^ bg_color));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(bg, _mm_and_si128(diff, m)));
+#elif defined(GC_VIDEO_NEON)
+    uint16x8_t m = vld1q_u16(mask);
+    vst1q_u16(dst, vbslq_u16(m, vdupq_n_u16(fg_color), vdupq_n_u16(bg_color)));
+#else
+    u64 bg = bg_color * 0x0001000100010001ULL;
+    u64 diff = (fg_color ^ bg_color) * 0x0001000100010001ULL;
+    u64 m[2];
+    memcpy(m, mask, sizeof(m));
+    u64 pixels[2];
+    pixels[0] = bg ^ (diff & m[0]);
+    pixels[1] = bg ^ (diff & m[1]);
+    memcpy(dst, pixels, sizeof(pixels));
+#endif
+}
+
+INLINE u16 Video::GetBackdropColor()
+{
+    u16 backdrop_color = m_VdpRegister[7] & 0x0F;
+    return (backdrop_color > 0) ? backdrop_color : 1;
+}
+
 inline u8* Video::GetVRAM()
 {
     return m_pVdpVRAM;
@@ -157,6 +286,20 @@ inline u16* Video::GetFrameBuffer()
     return m_pFrameBuffer;
 }
 
+inline unsigned int Video::GetCyclesToNextEvent()
+{
+    int next = GC_CYCLES_PER_LINE;
+
+    if (!m_LineEvents.display && (m_Timing[TIMING_DISPLAY] < next))
+        next = m_Timing[TIMING_DISPLAY];
+    if (!m_LineEvents.render && (m_Timing[TIMING_RENDER] < next))
+        next = m_Timing[TIMING_RENDER];
+    if ((m_iRenderLine == GC_RESOLUTION_HEIGHT) && !m_LineEvents.vint && (m_Timing[TIMING_VINT] < next))
+        next = m_Timing[TIMING_VINT];
+
+    return (next > m_iCycleCounter) ? (unsigned int)(next - m_iCycleCounter) : 1;
+}
+
 const u8 kPalette_888_coleco[48] = {0,0,0, 0,0,0, 33,200,66, 94,220,120, 84,85,237, 125,118,252, 212,82,77, 66,235,245, 252,85,84, 255,121,120, 212,193,84, 230,206,128, 33,176,59, 201,91,186, 204,204,204, 255,255,255};
 const u8 kPalette_888_tms9918[48] = {0,0,0, 0,8,0, 0,241,1, 50,251,65, 67,76,255, 112,110,255, 238,75,28, 9,255,255, 255,78,31, 255,112,65, 211,213,0, 228,221,52, 0,209,0, 219,79,211, 193,212,190, 244,255,241};
 
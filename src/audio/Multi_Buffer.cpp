@@ -1,8 +1,7 @@
 // Blip_Buffer 0.4.1. http://www.slack.net/~ant/
 
 #include "Multi_Buffer.h"
-#include <istream>
-#include <ostream>
+#include "../state_serializer.h"
 
 /* Copyright (C) 2003-2007 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -124,20 +123,25 @@ long Tracked_Blip_Buffer::read_samples( blip_sample_t* out, long count )
 	return count;
 }
 
-void Tracked_Blip_Buffer::SaveState( std::ostream& stream )
+void Tracked_Blip_Buffer::SaveState( StateWriter& stream )
 {
 	blip_buffer_state_t state;
 	save_state( &state );
-	stream.write( reinterpret_cast<const char*>( &state ), sizeof( state ) );
-	stream.write( reinterpret_cast<const char*>( &last_non_silence ), sizeof( last_non_silence ) );
+	stream.Write( state );
+	stream.Write( last_non_silence );
 }
 
-void Tracked_Blip_Buffer::LoadState( std::istream& stream )
+size_t Tracked_Blip_Buffer::GetStateSize() const
+{
+	return sizeof( blip_buffer_state_t ) + sizeof( last_non_silence );
+}
+
+void Tracked_Blip_Buffer::LoadState( StateReader& stream )
 {
 	blip_buffer_state_t state;
-	stream.read( reinterpret_cast<char*>( &state ), sizeof( state ) );
+	stream.Read( state );
 	load_state( state );
-	stream.read( reinterpret_cast<char*>( &last_non_silence ), sizeof( last_non_silence ) );
+	stream.Read( last_non_silence );
 }
 
 // Stereo_Buffer
@@ -214,20 +218,25 @@ long Stereo_Buffer::read_samples( blip_sample_t* out, long out_size )
 	return out_size;
 }
 
-void Stereo_Buffer::SaveState( std::ostream& stream )
+void Stereo_Buffer::SaveState( StateWriter& stream )
 {
 	for ( int i = 0; i < bufs_size; i++ )
 		bufs [i].SaveState( stream );
 
-	stream.write( reinterpret_cast<const char*>( &mixer.samples_read ), sizeof( mixer.samples_read ) );
+	stream.Write( mixer.samples_read );
+}
+
+size_t Stereo_Buffer::GetStateSize() const
+{
+	return bufs_size * bufs [0].GetStateSize() + sizeof( mixer.samples_read );
 }
 
-void Stereo_Buffer::LoadState( std::istream& stream )
+void Stereo_Buffer::LoadState( StateReader& stream )
 {
 	for ( int i = 0; i < bufs_size; i++ )
 		bufs [i].LoadState( stream );
 
-	stream.read( reinterpret_cast<char*>( &mixer.samples_read ), sizeof( mixer.samples_read ) );
+	stream.Read( mixer.samples_read );
 }
 
 
@@ -6,7 +6,9 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
-#include <iosfwd>
+
+class StateWriter;
+class StateReader;
 
 // Interface to one or more Blip_Buffers mapped to one or more channels
 // consisting of left, center, and right buffers.
@@ -114,8 +116,9 @@ public:
 		Tracked_Blip_Buffer();
 		void clear();
 		void end_frame( blip_time_t );
-		void SaveState( std::ostream& stream );
-		void LoadState( std::istream& stream );
+		void SaveState( StateWriter& stream );
+		size_t GetStateSize() const;
+		void LoadState( StateReader& stream );
 	private:
 		blip_long last_non_silence;
 		void remove_( long );
@@ -151,8 +154,9 @@ public:
 	void clear();
 	channel_t channel( int ) { return chan; }
 	void end_frame( blip_time_t );
-	void SaveState( std::ostream& stream );
-	void LoadState( std::istream& stream );
+	void SaveState( StateWriter& stream );
+	size_t GetStateSize() const;
+	void LoadState( StateReader& stream );
 
 	long samples_avail() const { return (bufs [0].samples_avail() - mixer.samples_read) * 2; }
 	long read_samples( blip_sample_t*, long );
@@ -1,8 +1,7 @@
 // Sms_Snd_Emu 0.1.4. http://www.slack.net/~ant/
 
 #include "Sms_Apu.h"
-#include <istream>
-#include <ostream>
+#include "../state_serializer.h"
 
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -346,24 +345,24 @@ static int noise_period_index( const Sms_Noise& noise, const Sms_Square* squares
 	return 0;
 }
 
-static void save_osc_state( std::ostream& stream, const Sms_Osc& osc )
+static void save_osc_state( StateWriter& stream, const Sms_Osc& osc )
 {
-	stream.write( reinterpret_cast<const char*>( &osc.output_select ), sizeof( osc.output_select ) );
-	stream.write( reinterpret_cast<const char*>( &osc.delay ), sizeof( osc.delay ) );
-	stream.write( reinterpret_cast<const char*>( &osc.last_amp ), sizeof( osc.last_amp ) );
-	stream.write( reinterpret_cast<const char*>( &osc.volume ), sizeof( osc.volume ) );
-	stream.write( reinterpret_cast<const char*>( &osc.volume_reg ), sizeof( osc.volume_reg ) );
-	stream.write( reinterpret_cast<const char*>( &osc.debug_last_amp ), sizeof( osc.debug_last_amp ) );
+	stream.Write( osc.output_select );
+	stream.Write( osc.delay );
+	stream.Write( osc.last_amp );
+	stream.Write( osc.volume );
+	stream.Write( osc.volume_reg );
+	stream.Write( osc.debug_last_amp );
 }
 
-static void load_osc_state( std::istream& stream, Sms_Osc& osc )
+static void load_osc_state( StateReader& stream, Sms_Osc& osc )
 {
-	stream.read( reinterpret_cast<char*>( &osc.output_select ), sizeof( osc.output_select ) );
-	stream.read( reinterpret_cast<char*>( &osc.delay ), sizeof( osc.delay ) );
-	stream.read( reinterpret_cast<char*>( &osc.last_amp ), sizeof( osc.last_amp ) );
-	stream.read( reinterpret_cast<char*>( &osc.volume ), sizeof( osc.volume ) );
-	stream.read( reinterpret_cast<char*>( &osc.volume_reg ), sizeof( osc.volume_reg ) );
-	stream.read( reinterpret_cast<char*>( &osc.debug_last_amp ), sizeof( osc.debug_last_amp ) );
+	stream.Read( osc.output_select );
+	stream.Read( osc.delay );
+	stream.Read( osc.last_amp );
+	stream.Read( osc.volume );
+	stream.Read( osc.volume_reg );
+	stream.Read( osc.debug_last_amp );
 
 	if ( osc.output_select < 0 || osc.output_select > 3 )
 		osc.output_select = 3;
@@ -407,48 +406,60 @@ void Sms_Apu::write_data( blip_time_t time, int data )
 	}
 }
 
-void Sms_Apu::SaveState( std::ostream& stream )
+void Sms_Apu::SaveState( StateWriter& stream )
 {
-	stream.write( reinterpret_cast<const char*>( &last_time ), sizeof( last_time ) );
-	stream.write( reinterpret_cast<const char*>( &latch ), sizeof( latch ) );
-	stream.write( reinterpret_cast<const char*>( &noise_feedback ), sizeof( noise_feedback ) );
-	stream.write( reinterpret_cast<const char*>( &looped_feedback ), sizeof( looped_feedback ) );
-	stream.write( reinterpret_cast<const char*>( &ggstereo_save ), sizeof( ggstereo_save ) );
+	stream.Write( last_time );
+	stream.Write( latch );
+	stream.Write( noise_feedback );
+	stream.Write( looped_feedback );
+	stream.Write( ggstereo_save );
 
 	for ( int i = 0; i < 3; i++ )
 	{
 		save_osc_state( stream, squares [i] );
-		stream.write( reinterpret_cast<const char*>( &squares [i].period ), sizeof( squares [i].period ) );
-		stream.write( reinterpret_cast<const char*>( &squares [i].phase ), sizeof( squares [i].phase ) );
+		stream.Write( squares [i].period );
+		stream.Write( squares [i].phase );
 	}
 
 	save_osc_state( stream, noise );
 	int period_index = noise_period_index( noise, squares, noise_periods );
-	stream.write( reinterpret_cast<const char*>( &period_index ), sizeof( period_index ) );
-	stream.write( reinterpret_cast<const char*>( &noise.shifter ), sizeof( noise.shifter ) );
-	stream.write( reinterpret_cast<const char*>( &noise.feedback ), sizeof( noise.feedback ) );
+	stream.Write( period_index );
+	stream.Write( noise.shifter );
+	stream.Write( noise.feedback );
 }
 
-void Sms_Apu::LoadState( std::istream& stream )
+size_t Sms_Apu::GetStateSize() const
 {
-	stream.read( reinterpret_cast<char*>( &last_time ), sizeof( last_time ) );
-	stream.read( reinterpret_cast<char*>( &latch ), sizeof( latch ) );
-	stream.read( reinterpret_cast<char*>( &noise_feedback ), sizeof( noise_feedback ) );
-	stream.read( reinterpret_cast<char*>( &looped_feedback ), sizeof( looped_feedback ) );
-	stream.read( reinterpret_cast<char*>( &ggstereo_save ), sizeof( ggstereo_save ) );
+	size_t osc_size = sizeof( noise.output_select ) + sizeof( noise.delay ) + sizeof( noise.last_amp ) +
+			sizeof( noise.volume ) + sizeof( noise.volume_reg ) + sizeof( noise.debug_last_amp );
+
+	size_t size = sizeof( last_time ) + sizeof( latch ) + sizeof( noise_feedback ) +
+			sizeof( looped_feedback ) + sizeof( ggstereo_save );
+	size += 3 * ( osc_size + sizeof( squares [0].period ) + sizeof( squares [0].phase ) );
+	size += osc_size + sizeof( int ) + sizeof( noise.shifter ) + sizeof( noise.feedback );
+	return size;
+}
+
+void Sms_Apu::LoadState( StateReader& stream )
+{
+	stream.Read( last_time );
+	stream.Read( latch );
+	stream.Read( noise_feedback );
+	stream.Read( looped_feedback );
+	stream.Read( ggstereo_save );
 
 	for ( int i = 0; i < 3; i++ )
 	{
 		load_osc_state( stream, squares [i] );
-		stream.read( reinterpret_cast<char*>( &squares [i].period ), sizeof( squares [i].period ) );
-		stream.read( reinterpret_cast<char*>( &squares [i].phase ), sizeof( squares [i].phase ) );
+		stream.Read( squares [i].period );
+		stream.Read( squares [i].phase );
 	}
 
 	load_osc_state( stream, noise );
 	int period_index = 0;
-	stream.read( reinterpret_cast<char*>( &period_index ), sizeof( period_index ) );
-	stream.read( reinterpret_cast<char*>( &noise.shifter ), sizeof( noise.shifter ) );
-	stream.read( reinterpret_cast<char*>( &noise.feedback ), sizeof( noise.feedback ) );
+	stream.Read( period_index );
+	stream.Read( noise.shifter );
+	stream.Read( noise.feedback );
 
 	if ( period_index == 3 )
 		noise.period = &squares [2].period;
@@ -4,9 +4,12 @@
 #ifndef SMS_APU_H
 #define SMS_APU_H
 
-#include <iosfwd>
+#include <stddef.h>
 #include "Sms_Oscs.h"
 
+class StateWriter;
+class StateReader;
+
 struct Sms_Apu_State
 {
     struct Channel
@@ -64,8 +67,9 @@ public:
 	// start a new frame at time 0.
 	void end_frame( blip_time_t );
 
-	void SaveState( std::ostream& stream );
-	void LoadState( std::istream& stream );
+	void SaveState( StateWriter& stream );
+	size_t GetStateSize() const;
+	void LoadState( StateReader& stream );
 
 	// Get debug state
 	Sms_Apu_State GetState();
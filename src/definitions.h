@@ -140,7 +140,7 @@ typedef void (*RamChangedCallback) (void);
 #define GC_AUDIO_QUEUE_SIZE 1792
 
 #define GC_SAVESTATE_MAGIC 0x09200902
-#define GC_SAVESTATE_VERSION 105
+#define GC_SAVESTATE_VERSION 108
 #define GC_SAVESTATE_MIN_VERSION 100
 #define GC_SAVESTATE_VERSION_V1 1
 
@@ -189,6 +189,12 @@ enum GC_Color_Format
     GC_PIXEL_BGRA8888
 };
 
+enum GC_Observation_Format
+{
+    GC_OBSERVATION_INDEX,
+    GC_OBSERVATION_GREYSCALE
+};
+
 enum GC_Keys
 {
     Keypad_8 = 0x01,
@@ -29,6 +29,7 @@
 #include "Cartridge.h"
 #include "Audio.h"
 #include "Video.h"
+#include "Profiler.h"
 #if !defined(GEARCOLECO_DISABLE_DISASSEMBLER)
 #include "TraceLogger.h"
 #endif
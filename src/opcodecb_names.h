@@ -20,7 +20,7 @@
 #ifndef OPCODECB_NAMES_H
 #define	OPCODECB_NAMES_H
 
-static stOPCodeInfo kOPCodeCBNames[256] = {
+static const stOPCodeInfo kOPCodeCBNames[256] = {
     GC_OPCODE("{n}RLC {o}B", 2, GC_OPCode_Type_Implied),
     GC_OPCODE("{n}RLC {o}C", 2, GC_OPCode_Type_Implied),
     GC_OPCODE("{n}RLC {o}D", 2, GC_OPCode_Type_Implied),
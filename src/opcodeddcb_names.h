@@ -20,7 +20,7 @@
 #ifndef OPCODEDDCB_NAMES_H
 #define	OPCODEDDCB_NAMES_H
 
-static stOPCodeInfo kOPCodeDDCBNames[256] = {
+static const stOPCodeInfo kOPCodeDDCBNames[256] = {
     GC_OPCODE_SYNTAX("{n}RLC {o}(IX%+d),B {e}[UNDOC]", "{n}RLC {o}(IX%+d),B", "{n}RLC {o}(IX%+d),B", "{n}RLC {o}(IX%+d),B", 4, GC_OPCode_Type_Data),
     GC_OPCODE_SYNTAX("{n}RLC {o}(IX%+d),C {e}[UNDOC]", "{n}RLC {o}(IX%+d),C", "{n}RLC {o}(IX%+d),C", "{n}RLC {o}(IX%+d),C", 4, GC_OPCode_Type_Data),
     GC_OPCODE_SYNTAX("{n}RLC {o}(IX%+d),D {e}[UNDOC]", "{n}RLC {o}(IX%+d),D", "{n}RLC {o}(IX%+d),D", "{n}RLC {o}(IX%+d),D", 4, GC_OPCode_Type_Data),
@@ -20,7 +20,7 @@
 #ifndef OPCODEED_NAMES_H
 #define	OPCODEED_NAMES_H
 
-static stOPCodeInfo kOPCodeEDNames[256] = {
+static const stOPCodeInfo kOPCodeEDNames[256] = {
     GC_OPCODE("{n}INVALID", 2, GC_OPCode_Type_Data),
     GC_OPCODE("{n}INVALID", 2, GC_OPCode_Type_Data),
     GC_OPCODE("{n}INVALID", 2, GC_OPCode_Type_Data),
@@ -20,7 +20,7 @@
 #ifndef OPCODEFD_NAMES_H
 #define	OPCODEFD_NAMES_H
 
-static stOPCodeInfo kOPCodeFDNames[256] = {
+static const stOPCodeInfo kOPCodeFDNames[256] = {
     GC_OPCODE("{n}NOP", 2, GC_OPCode_Type_Data),
     GC_OPCODE("{n}LD {o}BC,$%04X", 4, GC_OPCode_Type_Data),
     GC_OPCODE("{n}LD {o}(BC),A", 2, GC_OPCode_Type_Data),
@@ -20,7 +20,7 @@
 #ifndef OPCODEFDCB_NAMES_H
 #define	OPCODEFDCB_NAMES_H
 
-static stOPCodeInfo kOPCodeFDCBNames[256] = {
+static const stOPCodeInfo kOPCodeFDCBNames[256] = {
     GC_OPCODE_SYNTAX("{n}RLC {o}(IY%+d),B {e}[UNDOC]", "{n}RLC {o}(IY%+d),B", "{n}RLC {o}(IY%+d),B", "{n}RLC {o}(IY%+d),B", 4, GC_OPCode_Type_Data),
     GC_OPCODE_SYNTAX("{n}RLC {o}(IY%+d),C {e}[UNDOC]", "{n}RLC {o}(IY%+d),C", "{n}RLC {o}(IY%+d),C", "{n}RLC {o}(IY%+d),C", 4, GC_OPCode_Type_Data),
     GC_OPCODE_SYNTAX("{n}RLC {o}(IY%+d),D {e}[UNDOC]", "{n}RLC {o}(IY%+d),D", "{n}RLC {o}(IY%+d),D", "{n}RLC {o}(IY%+d),D", 4, GC_OPCode_Type_Data),
@@ -1671,4 +1671,272 @@ void Processor::OPCode0xFF()
 {
     // RST 38H
     OPCodes_RST(0x0038);
-}
\ No newline at end of file
+}
+
+#if defined(PERFORMANCE)
+
+// Switch dispatch lets the compiler inline the handlers defined above
+void Processor::DispatchOPCode(u8 opcode)
+{
+    switch (opcode)
+    {
+        case 0x00: OPCode0x00(); break;
+        case 0x01: OPCode0x01(); break;
+        case 0x02: OPCode0x02(); break;
+        case 0x03: OPCode0x03(); break;
+        case 0x04: OPCode0x04(); break;
+        case 0x05: OPCode0x05(); break;
+        case 0x06: OPCode0x06(); break;
+        case 0x07: OPCode0x07(); break;
+        case 0x08: OPCode0x08(); break;
+        case 0x09: OPCode0x09(); break;
+        case 0x0A: OPCode0x0A(); break;
+        case 0x0B: OPCode0x0B(); break;
+        case 0x0C: OPCode0x0C(); break;
+        case 0x0D: OPCode0x0D(); break;
+        case 0x0E: OPCode0x0E(); break;
+        case 0x0F: OPCode0x0F(); break;
+        case 0x10: OPCode0x10(); break;
+        case 0x11: OPCode0x11(); break;
+        case 0x12: OPCode0x12(); break;
+        case 0x13: OPCode0x13(); break;
+        case 0x14: OPCode0x14(); break;
+        case 0x15: OPCode0x15(); break;
+        case 0x16: OPCode0x16(); break;
+        case 0x17: OPCode0x17(); break;
+        case 0x18: OPCode0x18(); break;
+        case 0x19: OPCode0x19(); break;
+        case 0x1A: OPCode0x1A(); break;
+        case 0x1B: OPCode0x1B(); break;
+        case 0x1C: OPCode0x1C(); break;
+        case 0x1D: OPCode0x1D(); break;
+        case 0x1E: OPCode0x1E(); break;
+        case 0x1F: OPCode0x1F(); break;
+        case 0x20: OPCode0x20(); break;
+        case 0x21: OPCode0x21(); break;
+        case 0x22: OPCode0x22(); break;
+        case 0x23: OPCode0x23(); break;
+        case 0x24: OPCode0x24(); break;
+        case 0x25: OPCode0x25(); break;
+        case 0x26: OPCode0x26(); break;
+        case 0x27: OPCode0x27(); break;
+        case 0x28: OPCode0x28(); break;
+        case 0x29: OPCode0x29(); break;
+        case 0x2A: OPCode0x2A(); break;
+        case 0x2B: OPCode0x2B(); break;
+        case 0x2C: OPCode0x2C(); break;
+        case 0x2D: OPCode0x2D(); break;
+        case 0x2E: OPCode0x2E(); break;
+        case 0x2F: OPCode0x2F(); break;
+        case 0x30: OPCode0x30(); break;
+        case 0x31: OPCode0x31(); break;
+        case 0x32: OPCode0x32(); break;
+        case 0x33: OPCode0x33(); break;
+        case 0x34: OPCode0x34(); break;
+        case 0x35: OPCode0x35(); break;
+        case 0x36: OPCode0x36(); break;
+        case 0x37: OPCode0x37(); break;
+        case 0x38: OPCode0x38(); break;
+        case 0x39: OPCode0x39(); break;
+        case 0x3A: OPCode0x3A(); break;
+        case 0x3B: OPCode0x3B(); break;
+        case 0x3C: OPCode0x3C(); break;
+        case 0x3D: OPCode0x3D(); break;
+        case 0x3E: OPCode0x3E(); break;
+        case 0x3F: OPCode0x3F(); break;
+        case 0x40: OPCode0x40(); break;
+        case 0x41: OPCode0x41(); break;
+        case 0x42: OPCode0x42(); break;
+        case 0x43: OPCode0x43(); break;
+        case 0x44: OPCode0x44(); break;
+        case 0x45: OPCode0x45(); break;
+        case 0x46: OPCode0x46(); break;
+        case 0x47: OPCode0x47(); break;
+        case 0x48: OPCode0x48(); break;
+        case 0x49: OPCode0x49(); break;
+        case 0x4A: OPCode0x4A(); break;
+        case 0x4B: OPCode0x4B(); break;
+        case 0x4C: OPCode0x4C(); break;
+        case 0x4D: OPCode0x4D(); break;
+        case 0x4E: OPCode0x4E(); break;
+        case 0x4F: OPCode0x4F(); break;
+        case 0x50: OPCode0x50(); break;
+        case 0x51: OPCode0x51(); break;
+        case 0x52: OPCode0x52(); break;
+        case 0x53: OPCode0x53(); break;
+        case 0x54: OPCode0x54(); break;
+        case 0x55: OPCode0x55(); break;
+        case 0x56: OPCode0x56(); break;
+        case 0x57: OPCode0x57(); break;
+        case 0x58: OPCode0x58(); break;
+        case 0x59: OPCode0x59(); break;
+        case 0x5A: OPCode0x5A(); break;
+        case 0x5B: OPCode0x5B(); break;
+        case 0x5C: OPCode0x5C(); break;
+        case 0x5D: OPCode0x5D(); break;
+        case 0x5E: OPCode0x5E(); break;
+        case 0x5F: OPCode0x5F(); break;
+        case 0x60: OPCode0x60(); break;
+        case 0x61: OPCode0x61(); break;
+        case 0x62: OPCode0x62(); break;
+        case 0x63: OPCode0x63(); break;
+        case 0x64: OPCode0x64(); break;
+        case 0x65: OPCode0x65(); break;
+        case 0x66: OPCode0x66(); break;
+        case 0x67: OPCode0x67(); break;
+        case 0x68: OPCode0x68(); break;
+        case 0x69: OPCode0x69(); break;
+        case 0x6A: OPCode0x6A(); break;
+        case 0x6B: OPCode0x6B(); break;
+        case 0x6C: OPCode0x6C(); break;
+        case 0x6D: OPCode0x6D(); break;
+        case 0x6E: OPCode0x6E(); break;
+        case 0x6F: OPCode0x6F(); break;
+        case 0x70: OPCode0x70(); break;
+        case 0x71: OPCode0x71(); break;
+        case 0x72: OPCode0x72(); break;
+        case 0x73: OPCode0x73(); break;
+        case 0x74: OPCode0x74(); break;
+        case 0x75: OPCode0x75(); break;
+        case 0x76: OPCode0x76(); break;
+        case 0x77: OPCode0x77(); break;
+        case 0x78: OPCode0x78(); break;
+        case 0x79: OPCode0x79(); break;
+        case 0x7A: OPCode0x7A(); break;
+        case 0x7B: OPCode0x7B(); break;
+        case 0x7C: OPCode0x7C(); break;
+        case 0x7D: OPCode0x7D(); break;
+        case 0x7E: OPCode0x7E(); break;
+        case 0x7F: OPCode0x7F(); break;
+        case 0x80: OPCode0x80(); break;
+        case 0x81: OPCode0x81(); break;
+        case 0x82: OPCode0x82(); break;
+        case 0x83: OPCode0x83(); break;
+        case 0x84: OPCode0x84(); break;
+        case 0x85: OPCode0x85(); break;
+        case 0x86: OPCode0x86(); break;
+        case 0x87: OPCode0x87(); break;
+        case 0x88: OPCode0x88(); break;
+        case 0x89: OPCode0x89(); break;
+        case 0x8A: OPCode0x8A(); break;
+        case 0x8B: OPCode0x8B(); break;
+        case 0x8C: OPCode0x8C(); break;
+        case 0x8D: OPCode0x8D(); break;
+        case 0x8E: OPCode0x8E(); break;
+        case 0x8F: OPCode0x8F(); break;
+        case 0x90: OPCode0x90(); break;
+        case 0x91: OPCode0x91(); break;
+        case 0x92: OPCode0x92(); break;
+        case 0x93: OPCode0x93(); break;
+        case 0x94: OPCode0x94(); break;
+        case 0x95: OPCode0x95(); break;
+        case 0x96: OPCode0x96(); break;
+        case 0x97: OPCode0x97(); break;
+        case 0x98: OPCode0x98(); break;
+        case 0x99: OPCode0x99(); break;
+        case 0x9A: OPCode0x9A(); break;
+        case 0x9B: OPCode0x9B(); break;
+        case 0x9C: OPCode0x9C(); break;
+        case 0x9D: OPCode0x9D(); break;
+        case 0x9E: OPCode0x9E(); break;
+        case 0x9F: OPCode0x9F(); break;
+        case 0xA0: OPCode0xA0(); break;
+        case 0xA1: OPCode0xA1(); break;
+        case 0xA2: OPCode0xA2(); break;
+        case 0xA3: OPCode0xA3(); break;
+        case 0xA4: OPCode0xA4(); break;
+        case 0xA5: OPCode0xA5(); break;
+        case 0xA6: OPCode0xA6(); break;
+        case 0xA7: OPCode0xA7(); break;
+        case 0xA8: OPCode0xA8(); break;
+        case 0xA9: OPCode0xA9(); break;
+        case 0xAA: OPCode0xAA(); break;
+        case 0xAB: OPCode0xAB(); break;
+        case 0xAC: OPCode0xAC(); break;
+        case 0xAD: OPCode0xAD(); break;
+        case 0xAE: OPCode0xAE(); break;
+        case 0xAF: OPCode0xAF(); break;
+        case 0xB0: OPCode0xB0(); break;
+        case 0xB1: OPCode0xB1(); break;
+        case 0xB2: OPCode0xB2(); break;
+        case 0xB3: OPCode0xB3(); break;
+        case 0xB4: OPCode0xB4(); break;
+        case 0xB5: OPCode0xB5(); break;
+        case 0xB6: OPCode0xB6(); break;
+        case 0xB7: OPCode0xB7(); break;
+        case 0xB8: OPCode0xB8(); break;
+        case 0xB9: OPCode0xB9(); break;
+        case 0xBA: OPCode0xBA(); break;
+        case 0xBB: OPCode0xBB(); break;
+        case 0xBC: OPCode0xBC(); break;
+        case 0xBD: OPCode0xBD(); break;
+        case 0xBE: OPCode0xBE(); break;
+        case 0xBF: OPCode0xBF(); break;
+        case 0xC0: OPCode0xC0(); break;
+        case 0xC1: OPCode0xC1(); break;
+        case 0xC2: OPCode0xC2(); break;
+        case 0xC3: OPCode0xC3(); break;
+        case 0xC4: OPCode0xC4(); break;
+        case 0xC5: OPCode0xC5(); break;
+        case 0xC6: OPCode0xC6(); break;
+        case 0xC7: OPCode0xC7(); break;
+        case 0xC8: OPCode0xC8(); break;
+        case 0xC9: OPCode0xC9(); break;
+        case 0xCA: OPCode0xCA(); break;
+        case 0xCB: OPCode0xCB(); break;
+        case 0xCC: OPCode0xCC(); break;
+        case 0xCD: OPCode0xCD(); break;
+        case 0xCE: OPCode0xCE(); break;
+        case 0xCF: OPCode0xCF(); break;
+        case 0xD0: OPCode0xD0(); break;
+        case 0xD1: OPCode0xD1(); break;
+        case 0xD2: OPCode0xD2(); break;
+        case 0xD3: OPCode0xD3(); break;
+        case 0xD4: OPCode0xD4(); break;
+        case 0xD5: OPCode0xD5(); break;
+        case 0xD6: OPCode0xD6(); break;
+        case 0xD7: OPCode0xD7(); break;
+        case 0xD8: OPCode0xD8(); break;
+        case 0xD9: OPCode0xD9(); break;
+        case 0xDA: OPCode0xDA(); break;
+        case 0xDB: OPCode0xDB(); break;
+        case 0xDC: OPCode0xDC(); break;
+        case 0xDD: OPCode0xDD(); break;
+        case 0xDE: OPCode0xDE(); break;
+        case 0xDF: OPCode0xDF(); break;
+        case 0xE0: OPCode0xE0(); break;
+        case 0xE1: OPCode0xE1(); break;
+        case 0xE2: OPCode0xE2(); break;
+        case 0xE3: OPCode0xE3(); break;
+        case 0xE4: OPCode0xE4(); break;
+        case 0xE5: OPCode0xE5(); break;
+        case 0xE6: OPCode0xE6(); break;
+        case 0xE7: OPCode0xE7(); break;
+        case 0xE8: OPCode0xE8(); break;
+        case 0xE9: OPCode0xE9(); break;
+        case 0xEA: OPCode0xEA(); break;
+        case 0xEB: OPCode0xEB(); break;
+        case 0xEC: OPCode0xEC(); break;
+        case 0xED: OPCode0xED(); break;
+        case 0xEE: OPCode0xEE(); break;
+        case 0xEF: OPCode0xEF(); break;
+        case 0xF0: OPCode0xF0(); break;
+        case 0xF1: OPCode0xF1(); break;
+        case 0xF2: OPCode0xF2(); break;
+        case 0xF3: OPCode0xF3(); break;
+        case 0xF4: OPCode0xF4(); break;
+        case 0xF5: OPCode0xF5(); break;
+        case 0xF6: OPCode0xF6(); break;
+        case 0xF7: OPCode0xF7(); break;
+        case 0xF8: OPCode0xF8(); break;
+        case 0xF9: OPCode0xF9(); break;
+        case 0xFA: OPCode0xFA(); break;
+        case 0xFB: OPCode0xFB(); break;
+        case 0xFC: OPCode0xFC(); break;
+        case 0xFD: OPCode0xFD(); break;
+        case 0xFE: OPCode0xFE(); break;
+        case 0xFF: OPCode0xFF(); break;
+    }
+}
+
+#endif
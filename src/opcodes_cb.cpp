@@ -1554,3 +1554,271 @@ void Processor::OPCodeCB0xFF()
     // SET 7 A
     OPCodes_SET(AF.GetHighRegister(), 7);
 }
+
+#if defined(PERFORMANCE)
+
+// Switch dispatch lets the compiler inline the handlers defined above
+void Processor::DispatchOPCodeCB(u8 opcode)
+{
+    switch (opcode)
+    {
+        case 0x00: OPCodeCB0x00(); break;
+        case 0x01: OPCodeCB0x01(); break;
+        case 0x02: OPCodeCB0x02(); break;
+        case 0x03: OPCodeCB0x03(); break;
+        case 0x04: OPCodeCB0x04(); break;
+        case 0x05: OPCodeCB0x05(); break;
+        case 0x06: OPCodeCB0x06(); break;
+        case 0x07: OPCodeCB0x07(); break;
+        case 0x08: OPCodeCB0x08(); break;
+        case 0x09: OPCodeCB0x09(); break;
+        case 0x0A: OPCodeCB0x0A(); break;
+        case 0x0B: OPCodeCB0x0B(); break;
+        case 0x0C: OPCodeCB0x0C(); break;
+        case 0x0D: OPCodeCB0x0D(); break;
+        case 0x0E: OPCodeCB0x0E(); break;
+        case 0x0F: OPCodeCB0x0F(); break;
+        case 0x10: OPCodeCB0x10(); break;
+        case 0x11: OPCodeCB0x11(); break;
+        case 0x12: OPCodeCB0x12(); break;
+        case 0x13: OPCodeCB0x13(); break;
+        case 0x14: OPCodeCB0x14(); break;
+        case 0x15: OPCodeCB0x15(); break;
+        case 0x16: OPCodeCB0x16(); break;
+        case 0x17: OPCodeCB0x17(); break;
+        case 0x18: OPCodeCB0x18(); break;
+        case 0x19: OPCodeCB0x19(); break;
+        case 0x1A: OPCodeCB0x1A(); break;
+        case 0x1B: OPCodeCB0x1B(); break;
+        case 0x1C: OPCodeCB0x1C(); break;
+        case 0x1D: OPCodeCB0x1D(); break;
+        case 0x1E: OPCodeCB0x1E(); break;
+        case 0x1F: OPCodeCB0x1F(); break;
+        case 0x20: OPCodeCB0x20(); break;
+        case 0x21: OPCodeCB0x21(); break;
+        case 0x22: OPCodeCB0x22(); break;
+        case 0x23: OPCodeCB0x23(); break;
+        case 0x24: OPCodeCB0x24(); break;
+        case 0x25: OPCodeCB0x25(); break;
+        case 0x26: OPCodeCB0x26(); break;
+        case 0x27: OPCodeCB0x27(); break;
+        case 0x28: OPCodeCB0x28(); break;
+        case 0x29: OPCodeCB0x29(); break;
+        case 0x2A: OPCodeCB0x2A(); break;
+        case 0x2B: OPCodeCB0x2B(); break;
+        case 0x2C: OPCodeCB0x2C(); break;
+        case 0x2D: OPCodeCB0x2D(); break;
+        case 0x2E: OPCodeCB0x2E(); break;
+        case 0x2F: OPCodeCB0x2F(); break;
+        case 0x30: OPCodeCB0x30(); break;
+        case 0x31: OPCodeCB0x31(); break;
+        case 0x32: OPCodeCB0x32(); break;
+        case 0x33: OPCodeCB0x33(); break;
+        case 0x34: OPCodeCB0x34(); break;
+        case 0x35: OPCodeCB0x35(); break;
+        case 0x36: OPCodeCB0x36(); break;
+        case 0x37: OPCodeCB0x37(); break;
+        case 0x38: OPCodeCB0x38(); break;
+        case 0x39: OPCodeCB0x39(); break;
+        case 0x3A: OPCodeCB0x3A(); break;
+        case 0x3B: OPCodeCB0x3B(); break;
+        case 0x3C: OPCodeCB0x3C(); break;
+        case 0x3D: OPCodeCB0x3D(); break;
+        case 0x3E: OPCodeCB0x3E(); break;
+        case 0x3F: OPCodeCB0x3F(); break;
+        case 0x40: OPCodeCB0x40(); break;
+        case 0x41: OPCodeCB0x41(); break;
+        case 0x42: OPCodeCB0x42(); break;
+        case 0x43: OPCodeCB0x43(); break;
+        case 0x44: OPCodeCB0x44(); break;
+        case 0x45: OPCodeCB0x45(); break;
+        case 0x46: OPCodeCB0x46(); break;
+        case 0x47: OPCodeCB0x47(); break;
+        case 0x48: OPCodeCB0x48(); break;
+        case 0x49: OPCodeCB0x49(); break;
+        case 0x4A: OPCodeCB0x4A(); break;
+        case 0x4B: OPCodeCB0x4B(); break;
+        case 0x4C: OPCodeCB0x4C(); break;
+        case 0x4D: OPCodeCB0x4D(); break;
+        case 0x4E: OPCodeCB0x4E(); break;
+        case 0x4F: OPCodeCB0x4F(); break;
+        case 0x50: OPCodeCB0x50(); break;
+        case 0x51: OPCodeCB0x51(); break;
+        case 0x52: OPCodeCB0x52(); break;
+        case 0x53: OPCodeCB0x53(); break;
+        case 0x54: OPCodeCB0x54(); break;
+        case 0x55: OPCodeCB0x55(); break;
+        case 0x56: OPCodeCB0x56(); break;
+        case 0x57: OPCodeCB0x57(); break;
+        case 0x58: OPCodeCB0x58(); break;
+        case 0x59: OPCodeCB0x59(); break;
+        case 0x5A: OPCodeCB0x5A(); break;
+        case 0x5B: OPCodeCB0x5B(); break;
+        case 0x5C: OPCodeCB0x5C(); break;
+        case 0x5D: OPCodeCB0x5D(); break;
+        case 0x5E: OPCodeCB0x5E(); break;
+        case 0x5F: OPCodeCB0x5F(); break;
+        case 0x60: OPCodeCB0x60(); break;
+        case 0x61: OPCodeCB0x61(); break;
+        case 0x62: OPCodeCB0x62(); break;
+        case 0x63: OPCodeCB0x63(); break;
+        case 0x64: OPCodeCB0x64(); break;
+        case 0x65: OPCodeCB0x65(); break;
+        case 0x66: OPCodeCB0x66(); break;
+        case 0x67: OPCodeCB0x67(); break;
+        case 0x68: OPCodeCB0x68(); break;
+        case 0x69: OPCodeCB0x69(); break;
+        case 0x6A: OPCodeCB0x6A(); break;
+        case 0x6B: OPCodeCB0x6B(); break;
+        case 0x6C: OPCodeCB0x6C(); break;
+        case 0x6D: OPCodeCB0x6D(); break;
+        case 0x6E: OPCodeCB0x6E(); break;
+        case 0x6F: OPCodeCB0x6F(); break;
+        case 0x70: OPCodeCB0x70(); break;
+        case 0x71: OPCodeCB0x71(); break;
+        case 0x72: OPCodeCB0x72(); break;
+        case 0x73: OPCodeCB0x73(); break;
+        case 0x74: OPCodeCB0x74(); break;
+        case 0x75: OPCodeCB0x75(); break;
+        case 0x76: OPCodeCB0x76(); break;
+        case 0x77: OPCodeCB0x77(); break;
+        case 0x78: OPCodeCB0x78(); break;
+        case 0x79: OPCodeCB0x79(); break;
+        case 0x7A: OPCodeCB0x7A(); break;
+        case 0x7B: OPCodeCB0x7B(); break;
+        case 0x7C: OPCodeCB0x7C(); break;
+        case 0x7D: OPCodeCB0x7D(); break;
+        case 0x7E: OPCodeCB0x7E(); break;
+        case 0x7F: OPCodeCB0x7F(); break;
+        case 0x80: OPCodeCB0x80(); break;
+        case 0x81: OPCodeCB0x81(); break;
+        case 0x82: OPCodeCB0x82(); break;
+        case 0x83: OPCodeCB0x83(); break;
+        case 0x84: OPCodeCB0x84(); break;
+        case 0x85: OPCodeCB0x85(); break;
+        case 0x86: OPCodeCB0x86(); break;
+        case 0x87: OPCodeCB0x87(); break;
+        case 0x88: OPCodeCB0x88(); break;
+        case 0x89: OPCodeCB0x89(); break;
+        case 0x8A: OPCodeCB0x8A(); break;
+        case 0x8B: OPCodeCB0x8B(); break;
+        case 0x8C: OPCodeCB0x8C(); break;
+        case 0x8D: OPCodeCB0x8D(); break;
+        case 0x8E: OPCodeCB0x8E(); break;
+        case 0x8F: OPCodeCB0x8F(); break;
+        case 0x90: OPCodeCB0x90(); break;
+        case 0x91: OPCodeCB0x91(); break;
+        case 0x92: OPCodeCB0x92(); break;
+        case 0x93: OPCodeCB0x93(); break;
+        case 0x94: OPCodeCB0x94(); break;
+        case 0x95: OPCodeCB0x95(); break;
+        case 0x96: OPCodeCB0x96(); break;
+        case 0x97: OPCodeCB0x97(); break;
+        case 0x98: OPCodeCB0x98(); break;
+        case 0x99: OPCodeCB0x99(); break;
+        case 0x9A: OPCodeCB0x9A(); break;
+        case 0x9B: OPCodeCB0x9B(); break;
+        case 0x9C: OPCodeCB0x9C(); break;
+        case 0x9D: OPCodeCB0x9D(); break;
+        case 0x9E: OPCodeCB0x9E(); break;
+        case 0x9F: OPCodeCB0x9F(); break;
+        case 0xA0: OPCodeCB0xA0(); break;
+        case 0xA1: OPCodeCB0xA1(); break;
+        case 0xA2: OPCodeCB0xA2(); break;
+        case 0xA3: OPCodeCB0xA3(); break;
+        case 0xA4: OPCodeCB0xA4(); break;
+        case 0xA5: OPCodeCB0xA5(); break;
+        case 0xA6: OPCodeCB0xA6(); break;
+        case 0xA7: OPCodeCB0xA7(); break;
+        case 0xA8: OPCodeCB0xA8(); break;
+        case 0xA9: OPCodeCB0xA9(); break;
+        case 0xAA: OPCodeCB0xAA(); break;
+        case 0xAB: OPCodeCB0xAB(); break;
+        case 0xAC: OPCodeCB0xAC(); break;
+        case 0xAD: OPCodeCB0xAD(); break;
+        case 0xAE: OPCodeCB0xAE(); break;
+        case 0xAF: OPCodeCB0xAF(); break;
+        case 0xB0: OPCodeCB0xB0(); break;
+        case 0xB1: OPCodeCB0xB1(); break;
+        case 0xB2: OPCodeCB0xB2(); break;
+        case 0xB3: OPCodeCB0xB3(); break;
+        case 0xB4: OPCodeCB0xB4(); break;
+        case 0xB5: OPCodeCB0xB5(); break;
+        case 0xB6: OPCodeCB0xB6(); break;
+        case 0xB7: OPCodeCB0xB7(); break;
+        case 0xB8: OPCodeCB0xB8(); break;
+        case 0xB9: OPCodeCB0xB9(); break;
+        case 0xBA: OPCodeCB0xBA(); break;
+        case 0xBB: OPCodeCB0xBB(); break;
+        case 0xBC: OPCodeCB0xBC(); break;
+        case 0xBD: OPCodeCB0xBD(); break;
+        case 0xBE: OPCodeCB0xBE(); break;
+        case 0xBF: OPCodeCB0xBF(); break;
+        case 0xC0: OPCodeCB0xC0(); break;
+        case 0xC1: OPCodeCB0xC1(); break;
+        case 0xC2: OPCodeCB0xC2(); break;
+        case 0xC3: OPCodeCB0xC3(); break;
+        case 0xC4: OPCodeCB0xC4(); break;
+        case 0xC5: OPCodeCB0xC5(); break;
+        case 0xC6: OPCodeCB0xC6(); break;
+        case 0xC7: OPCodeCB0xC7(); break;
+        case 0xC8: OPCodeCB0xC8(); break;
+        case 0xC9: OPCodeCB0xC9(); break;
+        case 0xCA: OPCodeCB0xCA(); break;
+        case 0xCB: OPCodeCB0xCB(); break;
+        case 0xCC: OPCodeCB0xCC(); break;
+        case 0xCD: OPCodeCB0xCD(); break;
+        case 0xCE: OPCodeCB0xCE(); break;
+        case 0xCF: OPCodeCB0xCF(); break;
+        case 0xD0: OPCodeCB0xD0(); break;
+        case 0xD1: OPCodeCB0xD1(); break;
+        case 0xD2: OPCodeCB0xD2(); break;
+        case 0xD3: OPCodeCB0xD3(); break;
+        case 0xD4: OPCodeCB0xD4(); break;
+        case 0xD5: OPCodeCB0xD5(); break;
+        case 0xD6: OPCodeCB0xD6(); break;
+        case 0xD7: OPCodeCB0xD7(); break;
+        case 0xD8: OPCodeCB0xD8(); break;
+        case 0xD9: OPCodeCB0xD9(); break;
+        case 0xDA: OPCodeCB0xDA(); break;
+        case 0xDB: OPCodeCB0xDB(); break;
+        case 0xDC: OPCodeCB0xDC(); break;
+        case 0xDD: OPCodeCB0xDD(); break;
+        case 0xDE: OPCodeCB0xDE(); break;
+        case 0xDF: OPCodeCB0xDF(); break;
+        case 0xE0: OPCodeCB0xE0(); break;
+        case 0xE1: OPCodeCB0xE1(); break;
+        case 0xE2: OPCodeCB0xE2(); break;
+        case 0xE3: OPCodeCB0xE3(); break;
+        case 0xE4: OPCodeCB0xE4(); break;
+        case 0xE5: OPCodeCB0xE5(); break;
+        case 0xE6: OPCodeCB0xE6(); break;
+        case 0xE7: OPCodeCB0xE7(); break;
+        case 0xE8: OPCodeCB0xE8(); break;
+        case 0xE9: OPCodeCB0xE9(); break;
+        case 0xEA: OPCodeCB0xEA(); break;
+        case 0xEB: OPCodeCB0xEB(); break;
+        case 0xEC: OPCodeCB0xEC(); break;
+        case 0xED: OPCodeCB0xED(); break;
+        case 0xEE: OPCodeCB0xEE(); break;
+        case 0xEF: OPCodeCB0xEF(); break;
+        case 0xF0: OPCodeCB0xF0(); break;
+        case 0xF1: OPCodeCB0xF1(); break;
+        case 0xF2: OPCodeCB0xF2(); break;
+        case 0xF3: OPCodeCB0xF3(); break;
+        case 0xF4: OPCodeCB0xF4(); break;
+        case 0xF5: OPCodeCB0xF5(); break;
+        case 0xF6: OPCodeCB0xF6(); break;
+        case 0xF7: OPCodeCB0xF7(); break;
+        case 0xF8: OPCodeCB0xF8(); break;
+        case 0xF9: OPCodeCB0xF9(); break;
+        case 0xFA: OPCodeCB0xFA(); break;
+        case 0xFB: OPCodeCB0xFB(); break;
+        case 0xFC: OPCodeCB0xFC(); break;
+        case 0xFD: OPCodeCB0xFD(); break;
+        case 0xFE: OPCodeCB0xFE(); break;
+        case 0xFF: OPCodeCB0xFF(); break;
+    }
+}
+
+#endif
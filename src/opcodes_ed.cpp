@@ -591,3 +591,94 @@ void Processor::OPCodeED0xBB()
     if (BC.GetHigh() != 0)
         OPCodes_BlockIORepeat(parity_result);
 }
+
+#if defined(PERFORMANCE)
+
+// Switch dispatch lets the compiler inline the handlers defined above
+void Processor::DispatchOPCodeED(u8 opcode)
+{
+    switch (opcode)
+    {
+        case 0x40: OPCodeED0x40(); break;
+        case 0x41: OPCodeED0x41(); break;
+        case 0x42: OPCodeED0x42(); break;
+        case 0x43: OPCodeED0x43(); break;
+        case 0x44: OPCodeED0x44(); break;
+        case 0x45: OPCodeED0x45(); break;
+        case 0x46: OPCodeED0x46(); break;
+        case 0x47: OPCodeED0x47(); break;
+        case 0x48: OPCodeED0x48(); break;
+        case 0x49: OPCodeED0x49(); break;
+        case 0x4A: OPCodeED0x4A(); break;
+        case 0x4B: OPCodeED0x4B(); break;
+        case 0x4C: OPCodeED0x4C(); break;
+        case 0x4D: OPCodeED0x4D(); break;
+        case 0x4E: OPCodeED0x4E(); break;
+        case 0x4F: OPCodeED0x4F(); break;
+        case 0x50: OPCodeED0x50(); break;
+        case 0x51: OPCodeED0x51(); break;
+        case 0x52: OPCodeED0x52(); break;
+        case 0x53: OPCodeED0x53(); break;
+        case 0x54: OPCodeED0x54(); break;
+        case 0x55: OPCodeED0x55(); break;
+        case 0x56: OPCodeED0x56(); break;
+        case 0x57: OPCodeED0x57(); break;
+        case 0x58: OPCodeED0x58(); break;
+        case 0x59: OPCodeED0x59(); break;
+        case 0x5A: OPCodeED0x5A(); break;
+        case 0x5B: OPCodeED0x5B(); break;
+        case 0x5C: OPCodeED0x5C(); break;
+        case 0x5D: OPCodeED0x5D(); break;
+        case 0x5E: OPCodeED0x5E(); break;
+        case 0x5F: OPCodeED0x5F(); break;
+        case 0x60: OPCodeED0x60(); break;
+        case 0x61: OPCodeED0x61(); break;
+        case 0x62: OPCodeED0x62(); break;
+        case 0x63: OPCodeED0x63(); break;
+        case 0x64: OPCodeED0x64(); break;
+        case 0x65: OPCodeED0x65(); break;
+        case 0x66: OPCodeED0x66(); break;
+        case 0x67: OPCodeED0x67(); break;
+        case 0x68: OPCodeED0x68(); break;
+        case 0x69: OPCodeED0x69(); break;
+        case 0x6A: OPCodeED0x6A(); break;
+        case 0x6B: OPCodeED0x6B(); break;
+        case 0x6C: OPCodeED0x6C(); break;
+        case 0x6D: OPCodeED0x6D(); break;
+        case 0x6E: OPCodeED0x6E(); break;
+        case 0x6F: OPCodeED0x6F(); break;
+        case 0x70: OPCodeED0x70(); break;
+        case 0x71: OPCodeED0x71(); break;
+        case 0x72: OPCodeED0x72(); break;
+        case 0x73: OPCodeED0x73(); break;
+        case 0x74: OPCodeED0x74(); break;
+        case 0x75: OPCodeED0x75(); break;
+        case 0x76: OPCodeED0x76(); break;
+        case 0x78: OPCodeED0x78(); break;
+        case 0x79: OPCodeED0x79(); break;
+        case 0x7A: OPCodeED0x7A(); break;
+        case 0x7B: OPCodeED0x7B(); break;
+        case 0x7C: OPCodeED0x7C(); break;
+        case 0x7D: OPCodeED0x7D(); break;
+        case 0x7E: OPCodeED0x7E(); break;
+        case 0xA0: OPCodeED0xA0(); break;
+        case 0xA1: OPCodeED0xA1(); break;
+        case 0xA2: OPCodeED0xA2(); break;
+        case 0xA3: OPCodeED0xA3(); break;
+        case 0xA8: OPCodeED0xA8(); break;
+        case 0xA9: OPCodeED0xA9(); break;
+        case 0xAA: OPCodeED0xAA(); break;
+        case 0xAB: OPCodeED0xAB(); break;
+        case 0xB0: OPCodeED0xB0(); break;
+        case 0xB1: OPCodeED0xB1(); break;
+        case 0xB2: OPCodeED0xB2(); break;
+        case 0xB3: OPCodeED0xB3(); break;
+        case 0xB8: OPCodeED0xB8(); break;
+        case 0xB9: OPCodeED0xB9(); break;
+        case 0xBA: OPCodeED0xBA(); break;
+        case 0xBB: OPCodeED0xBB(); break;
+        default: InvalidOPCode(); break;
+    }
+}
+
+#endif
@@ -20,7 +20,7 @@
 #ifndef OPCODEXX_NAMES_H
 #define	OPCODEXX_NAMES_H
 
-static stOPCodeInfo kOPCodeNames[256] = {
+static const stOPCodeInfo kOPCodeNames[256] = {
     GC_OPCODE("{n}NOP", 1, GC_OPCode_Type_Implied),
     GC_OPCODE("{n}LD {o}BC,$%04X", 3, GC_OPCode_Type_2b),
     GC_OPCODE("{n}LD {o}(BC),A", 1, GC_OPCode_Type_Implied),
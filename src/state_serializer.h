@@ -0,0 +1,140 @@
+/*
+ * Gearcoleco - ColecoVision Emulator
+ * Copyright (C) 2021  Ignacio Sanchez
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ */
+
+#ifndef STATE_SERIALIZER_H
+#define STATE_SERIALIZER_H
+
+#include "definitions.h"
+
+// Writes savestate data straight into a caller provided buffer.
+// Writing past the end drops the data and leaves the writer failed.
+class StateWriter
+{
+public:
+    StateWriter(u8* buffer, size_t size)
+    {
+        m_pBuffer = buffer;
+        m_iSize = size;
+        m_iPosition = 0;
+        m_bFailed = false;
+    }
+
+    void WriteBytes(const void* data, size_t size)
+    {
+        if (size > (m_iSize - m_iPosition))
+        {
+            m_bFailed = true;
+            return;
+        }
+
+        memcpy(m_pBuffer + m_iPosition, data, size);
+        m_iPosition += size;
+    }
+
+    template <typename T>
+    void Write(const T& value)
+    {
+        WriteBytes(&value, sizeof(T));
+    }
+
+    size_t Size() const
+    {
+        return m_iPosition;
+    }
+
+    bool Good() const
+    {
+        return !m_bFailed;
+    }
+
+private:
+    u8* m_pBuffer;
+    size_t m_iSize;
+    size_t m_iPosition;
+    bool m_bFailed;
+};
+
+// Reads savestate data from a caller provided buffer.
+// Reading past the end zero fills the destination and leaves the reader failed.
+class StateReader
+{
+public:
+    StateReader(const u8* buffer, size_t size)
+    {
+        m_pBuffer = buffer;
+        m_iSize = size;
+        m_iPosition = 0;
+        m_bFailed = false;
+    }
+
+    void ReadBytes(void* data, size_t size)
+    {
+        if (size > (m_iSize - m_iPosition))
+        {
+            memset(data, 0, size);
+            m_iPosition = m_iSize;
+            m_bFailed = true;
+            return;
+        }
+
+        memcpy(data, m_pBuffer + m_iPosition, size);
+        m_iPosition += size;
+    }
+
+    template <typename T>
+    void Read(T& value)
+    {
+        ReadBytes(&value, sizeof(T));
+    }
+
+    void Skip(size_t size)
+    {
+        if (size > (m_iSize - m_iPosition))
+        {
+            m_iPosition = m_iSize;
+            m_bFailed = true;
+            return;
+        }
+
+        m_iPosition += size;
+    }
+
+    void Seek(size_t position)
+    {
+        m_iPosition = MIN(position, m_iSize);
+    }
+
+    size_t Size() const
+    {
+        return m_iSize;
+    }
+
+    bool Good() const
+    {
+        return !m_bFailed;
+    }
+
+private:
+    const u8* m_pBuffer;
+    size_t m_iSize;
+    size_t m_iPosition;
+    bool m_bFailed;
+};
+
+#endif /* STATE_SERIALIZER_H */